@@ -0,0 +1,479 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tbb/tbb.h"
+
+#include "../rtbuild/rtbuild.h"
+#include "../rtbuild/capture.h"
+#include "../rtbuild/sys/sysinfo.h"
+#include "../rtbuild/sys/alloc.h"
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+
+/*
+
+  Replays a build captured through the ZE_RAYTRACING_BUILD_CAPTURE
+  environment variable or the build capture extension. The captured
+  geometry gets loaded with its original formats and strides and is
+  built repeatedly through the builder API, reporting the build
+  times of all repetitions.
+
+ */
+
+using namespace embree;
+
+/* buffer with the alignment the builder requires for acceleration structures */
+struct AlignedBuffer
+{
+  AlignedBuffer (size_t bytes = 0)
+    : ptr(bytes ? alignedMalloc(bytes,128) : nullptr), bytes(bytes) {}
+
+  ~AlignedBuffer() {
+    if (ptr) alignedFree(ptr);
+  }
+
+  AlignedBuffer(const AlignedBuffer&) = delete;
+  AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+public:
+  void* ptr;
+  size_t bytes;
+};
+
+/* all geometry of a captured build */
+struct Capture
+{
+  union GeometryInfo
+  {
+    ze_rtas_builder_geometry_info_exp_t geometry;
+    ze_rtas_builder_triangles_geometry_info_exp_t triangles;
+    ze_rtas_builder_quads_geometry_info_exp_t quads;
+    ze_rtas_builder_procedural_geometry_info_exp_t procedural;
+    ze_rtas_builder_instance_geometry_info_exp_t instance;
+  };
+
+  static void getBounds(ze_rtas_geometry_aabbs_exp_cb_params_t* params)
+  {
+    const ze_rtas_aabb_exp_t* bounds = (const ze_rtas_aabb_exp_t*) params->pGeomUserPtr;
+    for (uint32_t i=0; i<params->primIDCount; i++)
+      params->pBoundsOut[i] = bounds[params->primID+i];
+  }
+
+public:
+  CaptureHeader header;
+  size_t numPrimitives = 0;
+  std::vector<std::unique_ptr<AlignedBuffer>> accels;
+  std::vector<std::unique_ptr<AlignedBuffer>> buffers;
+  std::vector<GeometryInfo> infos;
+  std::vector<const ze_rtas_builder_geometry_info_exp_t*> geometries;
+};
+
+static void* readBuffer(std::ifstream& in, Capture& capture, size_t bytes)
+{
+  if (bytes == 0) return nullptr;
+  capture.buffers.emplace_back(new AlignedBuffer(bytes));
+  void* ptr = capture.buffers.back()->ptr;
+  if (!in.read((char*)ptr,bytes)) throw std::runtime_error("truncated capture file");
+  return ptr;
+}
+
+static std::unique_ptr<Capture> loadCapture(const std::string& fileName)
+{
+  std::ifstream in(fileName, std::ios::binary);
+  if (!in) throw std::runtime_error("cannot open " + fileName);
+
+  std::unique_ptr<Capture> capture(new Capture);
+  CaptureHeader& header = capture->header;
+  if (!in.read((char*)&header,sizeof(header))) throw std::runtime_error("truncated capture file");
+  if (memcmp(header.magic,CAPTURE_MAGIC,sizeof(header.magic)) != 0) throw std::runtime_error(fileName + " is no build capture");
+  if (header.version != CAPTURE_VERSION) throw std::runtime_error("unsupported capture version " + std::to_string(header.version));
+
+  for (uint32_t i=0; i<header.numAccels; i++)
+  {
+    uint64_t bytes = 0;
+    if (!in.read((char*)&bytes,sizeof(bytes))) throw std::runtime_error("truncated capture file");
+    capture->accels.emplace_back(new AlignedBuffer(bytes));
+    if (!in.read((char*)capture->accels.back()->ptr,bytes)) throw std::runtime_error("truncated capture file");
+  }
+
+  /* geometry infos are referenced by pointer, thus must not get reallocated */
+  capture->infos.resize(header.numGeometries);
+  for (uint32_t geomID=0; geomID<header.numGeometries; geomID++)
+  {
+    CaptureGeometry record;
+    if (!in.read((char*)&record,sizeof(record))) throw std::runtime_error("truncated capture file");
+
+    Capture::GeometryInfo& info = capture->infos[geomID];
+    memset(&info,0,sizeof(info));
+
+    switch (record.geometryType)
+    {
+    case CAPTURE_NULL_GEOMETRY:
+      capture->geometries.push_back(nullptr);
+      continue;
+
+    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES: {
+      ze_rtas_builder_triangles_geometry_info_exp_t& mesh = info.triangles;
+      mesh.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES;
+      mesh.geometryFlags = record.geometryFlags;
+      mesh.geometryMask = record.geometryMask;
+      mesh.triangleFormat = record.primFormat;
+      mesh.vertexFormat = record.vertexFormat;
+      mesh.triangleCount = record.primCount;
+      mesh.triangleStride = record.primStride;
+      mesh.vertexCount = record.vertexCount;
+      mesh.vertexStride = record.vertexStride;
+      mesh.pTriangleBuffer = readBuffer(in,*capture,capturedBufferBytes(record.primCount,record.primStride,sizeof(ze_rtas_triangle_indices_uint32_exp_t)));
+      mesh.pVertexBuffer = readBuffer(in,*capture,capturedBufferBytes(record.vertexCount,record.vertexStride,sizeof(ze_rtas_float3_exp_t)));
+      break;
+    }
+    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS: {
+      ze_rtas_builder_quads_geometry_info_exp_t& mesh = info.quads;
+      mesh.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS;
+      mesh.geometryFlags = record.geometryFlags;
+      mesh.geometryMask = record.geometryMask;
+      mesh.quadFormat = record.primFormat;
+      mesh.vertexFormat = record.vertexFormat;
+      mesh.quadCount = record.primCount;
+      mesh.quadStride = record.primStride;
+      mesh.vertexCount = record.vertexCount;
+      mesh.vertexStride = record.vertexStride;
+      mesh.pQuadBuffer = readBuffer(in,*capture,capturedBufferBytes(record.primCount,record.primStride,sizeof(ze_rtas_quad_indices_uint32_exp_t)));
+      mesh.pVertexBuffer = readBuffer(in,*capture,capturedBufferBytes(record.vertexCount,record.vertexStride,sizeof(ze_rtas_float3_exp_t)));
+      break;
+    }
+    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: {
+      ze_rtas_builder_procedural_geometry_info_exp_t& procedural = info.procedural;
+      procedural.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL;
+      procedural.geometryFlags = record.geometryFlags;
+      procedural.geometryMask = record.geometryMask;
+      procedural.primCount = record.primCount;
+      procedural.pfnGetBoundsCb = Capture::getBounds;
+      procedural.pGeomUserPtr = readBuffer(in,*capture,size_t(record.primCount)*sizeof(ze_rtas_aabb_exp_t));
+      break;
+    }
+    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: {
+      const size_t transformBytes = capturedTransformBytes(record.primFormat);
+      if (transformBytes == 0) throw std::runtime_error("invalid transform format");
+      if (record.accelIndex >= capture->accels.size()) throw std::runtime_error("invalid acceleration structure index");
+      ze_rtas_builder_instance_geometry_info_exp_t& instance = info.instance;
+      instance.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE;
+      instance.instanceFlags = record.geometryFlags;
+      instance.geometryMask = record.geometryMask;
+      instance.transformFormat = record.primFormat;
+      instance.instanceUserID = record.instanceUserID;
+      instance.pTransform = readBuffer(in,*capture,transformBytes);
+      instance.pBounds = (ze_rtas_aabb_exp_t*) readBuffer(in,*capture,sizeof(ze_rtas_aabb_exp_t));
+      instance.pAccelerationStructure = capture->accels[record.accelIndex]->ptr;
+      break;
+    }
+    default:
+      throw std::runtime_error("invalid geometry type " + std::to_string(record.geometryType));
+    }
+
+    capture->numPrimitives += record.primCount;
+    capture->geometries.push_back(&info.geometry);
+  }
+
+  return capture;
+}
+
+static const char* qualityName(uint32_t quality)
+{
+  switch (quality) {
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW   : return "low";
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM: return "medium";
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH  : return "high";
+  default: return "unknown";
+  }
+}
+
+/* environment variable that sizes the thread arena of the builder when the library gets loaded */
+static const char* BUILDER_THREADS_ENVIRONMENT_VARIABLE = "ZE_RAYTRACING_BUILDER_THREADS";
+
+/* number of threads of the builder arena, the library falls back to all hardware threads for invalid values */
+static uint32_t getBuilderThreads()
+{
+  const char* str = getenv(BUILDER_THREADS_ENVIRONMENT_VARIABLE);
+  const int threads = str ? atoi(str) : 0;
+  if (threads <= 0) return (uint32_t) tbb::this_task_arena::max_concurrency();
+  return (uint32_t) threads;
+}
+
+/* replays with a different number of builder threads in a child process and returns its exit code */
+static int runProcess(int argc, char* argv[], uint32_t numThreads)
+{
+  const std::string threads = std::to_string(numThreads);
+#if defined(_WIN32)
+  _putenv_s(BUILDER_THREADS_ENVIRONMENT_VARIABLE,threads.c_str());
+#else
+  setenv(BUILDER_THREADS_ENVIRONMENT_VARIABLE,threads.c_str(),1);
+#endif
+
+  std::string command = "\"" + getExecutableFileName() + "\"";
+  for (int i=1; i<argc; i++) command += std::string(" \"") + argv[i] + "\"";
+#if defined(_WIN32)
+  command = "\"" + command + "\"";
+#endif
+  std::cout.flush();
+  return std::system(command.c_str()) == 0 ? 0 : 1;
+}
+
+static void printUsage()
+{
+  std::cout << "usage: rtas_replay [options] <capture file>" << std::endl;
+  std::cout << "  --repeat <int>      number of builds (default 5)" << std::endl;
+  std::cout << "  --threads <int>     number of build threads (default ZE_RAYTRACING_BUILDER_THREADS or all hardware threads)" << std::endl;
+  std::cout << "  --quality <hint>    override the captured build quality: low,medium,high" << std::endl;
+  std::cout << "  --phases            print the phase times of the fastest build" << std::endl;
+  std::cout << "  --compare <file>    fail if the statistics of the build differ from the acceleration structure in the file" << std::endl;
+  std::cout << "  --scratch-budget <MB> limit the scratch buffer, larger scenes get built in chunks" << std::endl;
+  std::cout << "  --serialize <file>  write the acceleration structure to a file and measure loading it" << std::endl;
+}
+
+int main(int argc, char* argv[]) try
+{
+  std::string fileName;
+  uint32_t repeat = 5;
+  const uint32_t builderThreads = getBuilderThreads();
+  uint32_t numThreads = builderThreads;
+  int quality = -1;
+  bool phases = false;
+  std::string compareFile;
+  size_t scratchBudget = 0;
+  std::string serializeFile;
+
+  /* parse all command line options */
+  for (int i=1; i<argc; i++)
+  {
+    if (strcmp(argv[i], "--repeat") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --repeat <int>: syntax error");
+      repeat = std::max(1,atoi(argv[i]));
+    }
+    else if (strcmp(argv[i], "--threads") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --threads <int>: syntax error");
+      numThreads = std::max(1,atoi(argv[i]));
+    }
+    else if (strcmp(argv[i], "--quality") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --quality <hint>: syntax error");
+      for (int q : { ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH })
+        if (strcmp(argv[i], qualityName(q)) == 0) quality = q;
+      if (quality < 0) throw std::runtime_error(std::string("invalid quality ") + argv[i]);
+    }
+    else if (strcmp(argv[i], "--phases") == 0) {
+      phases = true;
+    }
+    else if (strcmp(argv[i], "--compare") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --compare <file>: syntax error");
+      compareFile = argv[i];
+    }
+    else if (strcmp(argv[i], "--scratch-budget") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --scratch-budget <MB>: syntax error");
+      scratchBudget = size_t(std::max(1,atoi(argv[i])))*1024*1024;
+    }
+    else if (strcmp(argv[i], "--serialize") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --serialize <file>: syntax error");
+      serializeFile = argv[i];
+    }
+    else if (strcmp(argv[i], "--help") == 0) {
+      printUsage();
+      return 0;
+    }
+    else if (argv[i][0] != '-' && fileName.empty()) {
+      fileName = argv[i];
+    }
+    else {
+      std::cout << "ERROR: invalid command line option " << argv[i] << std::endl;
+      printUsage();
+      return 1;
+    }
+  }
+
+  if (fileName.empty()) {
+    printUsage();
+    return 1;
+  }
+
+  /* the builder arena got sized when the library got loaded, thus other thread counts run in a child process */
+  if (numThreads != builderThreads)
+    return runProcess(argc,argv,numThreads);
+
+  std::unique_ptr<Capture> capture = loadCapture(fileName);
+
+  ze_rtas_builder_exp_desc_t builderDesc;
+  memset(&builderDesc,0,sizeof(builderDesc));
+  builderDesc.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_EXP_DESC;
+  builderDesc.builderVersion = ZE_RTAS_BUILDER_EXP_VERSION_CURRENT;
+
+  /* the internal builder does not use the driver handle */
+  ze_rtas_builder_exp_handle_t hBuilder = nullptr;
+  if (zeRTASBuilderCreateExpImpl((ze_driver_handle_t)1,&builderDesc,&hBuilder) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("ze_rtas_builder creation failed");
+
+  ze_rtas_builder_build_op_statistics_exp_desc_t statistics;
+  memset(&statistics,0,sizeof(statistics));
+  statistics.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STATISTICS_EXP_DESC;
+
+  ze_rtas_builder_build_op_streaming_exp_desc_t streaming;
+  memset(&streaming,0,sizeof(streaming));
+  streaming.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STREAMING_EXP_DESC;
+  streaming.pNext = phases ? &statistics : nullptr;
+  streaming.scratchBudgetBytes = scratchBudget;
+
+  ze_rtas_builder_build_op_exp_desc_t args;
+  memset(&args,0,sizeof(args));
+  args.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_EXP_DESC;
+  args.pNext = scratchBudget ? (const void*) &streaming : streaming.pNext;
+  args.rtasFormat = (ze_rtas_format_exp_t) capture->header.rtasFormat;
+  args.buildQuality = (ze_rtas_builder_build_quality_hint_exp_t) (quality >= 0 ? quality : int(capture->header.buildQuality));
+  args.buildFlags = capture->header.buildFlags;
+  args.ppGeometries = (const ze_rtas_builder_geometry_info_exp_t**) capture->geometries.data();
+  args.numGeometries = (uint32_t) capture->geometries.size();
+
+  std::cout << fileName << ": " << capture->geometries.size() << " geometries, " << capture->numPrimitives << " primitives, "
+            << capture->accels.size() << " instanced acceleration structures" << std::endl;
+  std::cout << "quality " << qualityName(args.buildQuality) << ", flags 0x" << std::hex << args.buildFlags << std::dec
+            << ", " << numThreads << " threads" << std::endl;
+
+  ze_rtas_builder_exp_properties_t props;
+  memset(&props,0,sizeof(props));
+  props.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_EXP_PROPERTIES;
+  if (zeRTASBuilderGetBuildPropertiesExpImpl(hBuilder,&args,&props) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("get build properties failed");
+
+  AlignedBuffer scratch(std::max(props.scratchBufferSizeBytes,size_t(64)));
+  AlignedBuffer accel(props.rtasBufferSizeBytesMaxRequired);
+
+  double best = std::numeric_limits<double>::infinity();
+  ze_rtas_builder_build_op_statistics_exp_desc_t bestStatistics = statistics;
+  size_t rtasBytes = 0;
+  std::cout << std::fixed << std::setprecision(3);
+  for (uint32_t r=0; r<repeat; r++)
+  {
+    ze_rtas_aabb_exp_t bounds;
+    const double t0 = getSeconds();
+    ze_result_t err = zeRTASBuilderBuildExpImpl(hBuilder,&args,scratch.ptr,scratch.bytes,accel.ptr,accel.bytes,
+                                                nullptr,nullptr,&bounds,&rtasBytes);
+    const double t1 = getSeconds();
+    if (err != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("build failed");
+
+    std::cout << "build " << r << ": " << 1000.0*(t1-t0) << " ms, "
+              << 1E-6*double(capture->numPrimitives)/(t1-t0) << " Mprims/s" << std::endl;
+    if (t1-t0 < best) {
+      best = t1-t0;
+      bestStatistics = statistics;
+    }
+  }
+
+  ze_rtas_statistics_exp_t stats;
+  memset(&stats,0,sizeof(stats));
+  stats.stype = ZE_STRUCTURE_TYPE_RTAS_STATISTICS_EXP;
+  if (zeRTASGetStatisticsExpImpl(accel.ptr,&stats) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("statistics query failed");
+
+  std::cout << "best: " << 1000.0*best << " ms, " << 1E-6*double(capture->numPrimitives)/best << " Mprims/s" << std::endl;
+  std::cout << "scratch " << props.scratchBufferSizeBytes << " bytes, rtas " << rtasBytes << " bytes, sah " << stats.sah << std::endl;
+
+  if (phases)
+  {
+    std::cout << "phases of the fastest build in ms:" << std::endl;
+    std::cout << "  setup     " << 1000.0*bestStatistics.setupSeconds << std::endl;
+    std::cout << "  quadify   " << 1000.0*bestStatistics.quadifySeconds << std::endl;
+    std::cout << "  primref   " << 1000.0*bestStatistics.primRefSeconds << std::endl;
+    std::cout << "  filter    " << 1000.0*bestStatistics.filterSeconds << std::endl;
+    std::cout << "  presplit  " << 1000.0*bestStatistics.presplitSeconds << std::endl;
+    std::cout << "  hierarchy " << 1000.0*bestStatistics.hierarchySeconds << std::endl;
+    std::cout << "  finalize  " << 1000.0*bestStatistics.finalizeSeconds << std::endl;
+  }
+
+  /* instances reference the acceleration structures by address, thus the replayed build gets compared
+   * through its statistics instead of byte by byte */
+  bool equal = true;
+  if (!compareFile.empty())
+  {
+    std::ifstream in(compareFile, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("cannot open " + compareFile);
+    AlignedBuffer reference((size_t)in.tellg());
+    in.seekg(0);
+    if (!in.read((char*)reference.ptr,reference.bytes)) throw std::runtime_error("cannot read " + compareFile);
+
+    ze_rtas_statistics_exp_t expected;
+    memset(&expected,0,sizeof(expected));
+    expected.stype = ZE_STRUCTURE_TYPE_RTAS_STATISTICS_EXP;
+    if (zeRTASGetStatisticsExpImpl(reference.ptr,&expected) != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("statistics query failed");
+
+    equal = reference.bytes == rtasBytes && expected.sah == stats.sah && expected.numBytes == stats.numBytes &&
+      memcmp(&expected.bounds,&stats.bounds,sizeof(stats.bounds)) == 0 &&
+      expected.internalNodes.numNodes == stats.internalNodes.numNodes &&
+      expected.quadLeaves.numPrimsUsed == stats.quadLeaves.numPrimsUsed &&
+      expected.proceduralLeaves.numPrimsUsed == stats.proceduralLeaves.numPrimsUsed &&
+      expected.instanceLeaves.numPrimsUsed == stats.instanceLeaves.numPrimsUsed;
+    std::cout << compareFile << ": " << reference.bytes << " bytes, sah " << expected.sah << (equal ? ", equal" : ", DIFFERENT") << std::endl;
+  }
+
+  if (!serializeFile.empty())
+  {
+    /* instances of the capture reference the captured acceleration structures */
+    std::vector<const void*> accels;
+    for (auto& a : capture->accels) accels.push_back(a->ptr);
+
+    ze_rtas_serialize_exp_desc_t serialize;
+    memset(&serialize,0,sizeof(serialize));
+    serialize.stype = ZE_STRUCTURE_TYPE_RTAS_SERIALIZE_EXP_DESC;
+    serialize.numAccels = (uint32_t) accels.size();
+    serialize.ppAccels = accels.data();
+
+    size_t serializedBytes = 0;
+    if (zeRTASSerializeExpImpl(accel.ptr,&serialize,nullptr,0,&serializedBytes) != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("serialization failed");
+    std::vector<char> serialized(serializedBytes);
+    if (zeRTASSerializeExpImpl(accel.ptr,&serialize,serialized.data(),serialized.size(),nullptr) != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("serialization failed");
+
+    std::ofstream out(serializeFile,std::ios::binary);
+    if (!out.write(serialized.data(),serialized.size()))
+      throw std::runtime_error("cannot write " + serializeFile);
+    out.close();
+
+    /* loading is a single read followed by the relocation of all instances */
+    const double t0 = getSeconds();
+    std::ifstream in(serializeFile,std::ios::binary);
+    std::vector<char> loaded(serializedBytes);
+    if (!in.read(loaded.data(),loaded.size()))
+      throw std::runtime_error("cannot read " + serializeFile);
+
+    ze_rtas_deserialize_exp_desc_t deserialize;
+    memset(&deserialize,0,sizeof(deserialize));
+    deserialize.stype = ZE_STRUCTURE_TYPE_RTAS_DESERIALIZE_EXP_DESC;
+    deserialize.rtasFormat = args.rtasFormat;
+    deserialize.numAccels = serialize.numAccels;
+    deserialize.ppAccels = serialize.ppAccels;
+
+    AlignedBuffer copy(rtasBytes);
+    const double t1 = getSeconds();
+    if (zeRTASDeserializeExpImpl((ze_driver_handle_t)1,loaded.data(),loaded.size(),&deserialize,copy.ptr,copy.bytes,nullptr) != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("loading serialized acceleration structure failed");
+    const double t2 = getSeconds();
+
+    std::cout << "serialized " << serializedBytes << " bytes, read " << 1000.0*(t1-t0) << " ms, load " << 1000.0*(t2-t1) << " ms" << std::endl;
+  }
+
+  if (zeRTASBuilderDestroyExpImpl(hBuilder) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("ze_rtas_builder destruction failed");
+
+  return equal ? 0 : 1;
+}
+catch (const std::exception& e)
+{
+  std::cerr << "ERROR: " << e.what() << std::endl;
+  return 1;
+}
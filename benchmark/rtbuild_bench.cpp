@@ -0,0 +1,700 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tbb/tbb.h"
+
+#include "../rtbuild/rtbuild.h"
+#include "../rtbuild/sys/sysinfo.h"
+#include "../rtbuild/sys/alloc.h"
+
+#include <vector>
+#include <string>
+#include <random>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+
+/*
+
+  Host only benchmark of the RTAS builder. Generates synthetic scenes
+  of increasing size, builds them through the builder API for all
+  requested quality hints and thread counts, and reports build
+  performance and BVH quality as JSON. No GPU or SYCL runtime is
+  required.
+
+ */
+
+using namespace embree;
+
+/* byte pattern used to detect how much of the scratch buffer got written */
+static const unsigned char SCRATCH_SENTINEL = 0xCD;
+
+/* size of the mesh instantiated by the instances scene */
+static const uint32_t INSTANCED_MESH_TRIANGLES = 1024;
+
+enum class SceneType
+{
+  TRIANGLE_GRID,   // regular grid of slightly displaced triangles
+  TRIANGLE_SOUP,   // random small triangles inside the unit cube
+  INSTANCES,       // forest of instances of a single triangle mesh
+  MIXED            // random triangles mixed with procedural boxes
+};
+
+static const char* sceneName(SceneType type)
+{
+  switch (type) {
+  case SceneType::TRIANGLE_GRID: return "grid";
+  case SceneType::TRIANGLE_SOUP: return "soup";
+  case SceneType::INSTANCES    : return "instances";
+  case SceneType::MIXED        : return "mixed";
+  }
+  return "unknown";
+}
+
+static const char* qualityName(ze_rtas_builder_build_quality_hint_exp_t quality)
+{
+  switch (quality) {
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW   : return "low";
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM: return "medium";
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH  : return "high";
+  default: return "unknown";
+  }
+}
+
+/* buffer with the alignment the builder requires for acceleration structures */
+struct AlignedBuffer
+{
+  AlignedBuffer (size_t bytes = 0)
+    : ptr(bytes ? alignedMalloc(bytes,128) : nullptr), bytes(bytes) {}
+
+  ~AlignedBuffer() {
+    if (ptr) alignedFree(ptr);
+  }
+
+  AlignedBuffer(const AlignedBuffer&) = delete;
+  AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+public:
+  void* ptr;
+  size_t bytes;
+};
+
+/* triangle mesh in the layout passed to the builder */
+struct TriangleMesh
+{
+  ze_rtas_builder_triangles_geometry_info_exp_t geometryInfo() const
+  {
+    ze_rtas_builder_triangles_geometry_info_exp_t info;
+    memset(&info,0,sizeof(info));
+    info.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES;
+    info.geometryFlags = 0;
+    info.geometryMask = 0xFF;
+    info.triangleFormat = ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_TRIANGLE_INDICES_UINT32;
+    info.vertexFormat = ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3;
+    info.triangleCount = (uint32_t) triangles.size();
+    info.triangleStride = sizeof(ze_rtas_triangle_indices_uint32_exp_t);
+    info.pTriangleBuffer = (void*) triangles.data();
+    info.vertexCount = (uint32_t) vertices.size();
+    info.vertexStride = sizeof(ze_rtas_float3_exp_t);
+    info.pVertexBuffer = (void*) vertices.data();
+    return info;
+  }
+
+public:
+  std::vector<ze_rtas_float3_exp_t> vertices;
+  std::vector<ze_rtas_triangle_indices_uint32_exp_t> triangles;
+};
+
+/* procedural boxes, the bounds get returned through the bounds callback */
+struct ProceduralBoxes
+{
+  static void getBounds(ze_rtas_geometry_aabbs_exp_cb_params_t* params)
+  {
+    const ProceduralBoxes* boxes = (const ProceduralBoxes*) params->pGeomUserPtr;
+    for (uint32_t i=0; i<params->primIDCount; i++)
+      params->pBoundsOut[i] = boxes->bounds[params->primID+i];
+  }
+
+  ze_rtas_builder_procedural_geometry_info_exp_t geometryInfo() const
+  {
+    ze_rtas_builder_procedural_geometry_info_exp_t info;
+    memset(&info,0,sizeof(info));
+    info.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL;
+    info.geometryFlags = 0;
+    info.geometryMask = 0xFF;
+    info.primCount = (uint32_t) bounds.size();
+    info.pfnGetBoundsCb = getBounds;
+    info.pGeomUserPtr = (void*) this;
+    return info;
+  }
+
+public:
+  std::vector<ze_rtas_aabb_exp_t> bounds;
+};
+
+/* all geometry of a benchmark scene */
+struct Scene
+{
+  Scene (SceneType type, size_t numPrimitives)
+    : type(type), numPrimitives(numPrimitives) {}
+
+public:
+  SceneType type;
+  size_t numPrimitives;
+  std::vector<TriangleMesh> meshes;
+  std::vector<ProceduralBoxes> procedurals;
+  std::vector<ze_rtas_transform_float3x4_column_major_exp_t> transforms;
+  ze_rtas_aabb_exp_t instancedBounds;
+  std::shared_ptr<AlignedBuffer> instancedAccel;
+
+  std::vector<ze_rtas_builder_triangles_geometry_info_exp_t> triangleInfos;
+  std::vector<ze_rtas_builder_procedural_geometry_info_exp_t> proceduralInfos;
+  std::vector<ze_rtas_builder_instance_geometry_info_exp_t> instanceInfos;
+  std::vector<const ze_rtas_builder_geometry_info_exp_t*> geometries;
+};
+
+static void addGrid(TriangleMesh& mesh, size_t numTriangles, std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> displace(0.0f,0.1f);
+  const size_t numQuads = (numTriangles+1)/2;
+  const size_t width = std::max(size_t(1),(size_t) std::ceil(std::sqrt(double(numQuads))));
+  const size_t height = (numQuads+width-1)/width;
+
+  const uint32_t base = (uint32_t) mesh.vertices.size();
+  for (size_t y=0; y<=height; y++)
+    for (size_t x=0; x<=width; x++)
+      mesh.vertices.push_back({ float(x), float(y), displace(rng) });
+
+  for (size_t i=0; i<numTriangles; i++)
+  {
+    const size_t x = (i/2) % width;
+    const size_t y = (i/2) / width;
+    const uint32_t v00 = base + uint32_t(y*(width+1)+x);
+    const uint32_t v01 = v00+1;
+    const uint32_t v10 = v00+uint32_t(width+1);
+    const uint32_t v11 = v10+1;
+    if (i%2 == 0) mesh.triangles.push_back({ v00, v01, v10 });
+    else          mesh.triangles.push_back({ v11, v10, v01 });
+  }
+}
+
+static void addSoup(TriangleMesh& mesh, size_t numTriangles, std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> uniform(0.0f,1.0f);
+  const float size = 2.0f / std::cbrt(float(std::max(size_t(1),numTriangles)));
+
+  for (size_t i=0; i<numTriangles; i++)
+  {
+    const float px = uniform(rng), py = uniform(rng), pz = uniform(rng);
+    const uint32_t base = (uint32_t) mesh.vertices.size();
+    for (size_t j=0; j<3; j++)
+      mesh.vertices.push_back({ px + size*uniform(rng), py + size*uniform(rng), pz + size*uniform(rng) });
+    mesh.triangles.push_back({ base, base+1, base+2 });
+  }
+}
+
+static void addBoxes(ProceduralBoxes& boxes, size_t numBoxes, std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> uniform(0.0f,1.0f);
+  const float size = 2.0f / std::cbrt(float(std::max(size_t(1),numBoxes)));
+
+  for (size_t i=0; i<numBoxes; i++)
+  {
+    const float px = uniform(rng), py = uniform(rng), pz = uniform(rng);
+    boxes.bounds.push_back({ { px, py, pz }, { px + size*uniform(rng), py + size*uniform(rng), pz + size*uniform(rng) } });
+  }
+}
+
+struct BuildResult
+{
+  BuildResult ()
+    : propertiesSeconds(0.0), buildSeconds(0.0), scratchBytes(0), scratchBytesPeak(0),
+      rtasBytesExpected(0), rtasBytesMax(0), rtasBytes(0), sah(0.0)
+  {
+    memset(&statistics,0,sizeof(statistics));
+  }
+
+public:
+  double propertiesSeconds;   // time to query the buffer sizes
+  double buildSeconds;        // time to build the acceleration structure
+  size_t scratchBytes;        // scratch buffer size requested by the builder
+  size_t scratchBytesPeak;    // high water mark of the scratch buffer
+  size_t rtasBytesExpected;   // expected acceleration structure size
+  size_t rtasBytesMax;        // worst case acceleration structure size
+  size_t rtasBytes;           // acceleration structure size actually used
+  double sah;                 // SAH cost of the acceleration structure
+  ze_rtas_builder_build_op_statistics_exp_desc_t statistics; // phase times and counters reported by the builder
+};
+
+/* builds the geometries into the returned buffer and measures the build, the
+ * build time includes the node counting done for the builder statistics */
+static std::shared_ptr<AlignedBuffer> build(ze_rtas_builder_exp_handle_t hBuilder,
+                                            const std::vector<const ze_rtas_builder_geometry_info_exp_t*>& geometries,
+                                            ze_rtas_builder_build_quality_hint_exp_t quality,
+                                            ze_rtas_aabb_exp_t* boundsOut, BuildResult& result)
+{
+  ze_rtas_builder_build_op_statistics_exp_desc_t statistics;
+  memset(&statistics,0,sizeof(statistics));
+  statistics.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STATISTICS_EXP_DESC;
+  statistics.pNext = nullptr;
+
+  ze_rtas_builder_build_op_exp_desc_t args;
+  memset(&args,0,sizeof(args));
+  args.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_EXP_DESC;
+  args.pNext = &statistics;
+  args.rtasFormat = (ze_rtas_format_exp_t) ZE_RTAS_DEVICE_FORMAT_EXP_VERSION_1;
+  args.buildQuality = quality;
+  args.buildFlags = 0;
+  args.ppGeometries = (const ze_rtas_builder_geometry_info_exp_t**) geometries.data();
+  args.numGeometries = (uint32_t) geometries.size();
+
+  ze_rtas_builder_exp_properties_t props;
+  memset(&props,0,sizeof(props));
+  props.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_EXP_PROPERTIES;
+
+  const double t0 = getSeconds();
+  ze_result_t err = zeRTASBuilderGetBuildPropertiesExpImpl(hBuilder,&args,&props);
+  const double t1 = getSeconds();
+  if (err != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("get build properties failed");
+
+  /* the worst case size never requires a rebuild, thus only the build itself gets measured */
+  AlignedBuffer scratch(std::max(props.scratchBufferSizeBytes,size_t(64)));
+  memset(scratch.ptr,SCRATCH_SENTINEL,scratch.bytes);
+  std::shared_ptr<AlignedBuffer> accel = std::make_shared<AlignedBuffer>(props.rtasBufferSizeBytesMaxRequired);
+
+  ze_rtas_aabb_exp_t bounds;
+  size_t rtasBytes = 0;
+  const double t2 = getSeconds();
+  err = zeRTASBuilderBuildExpImpl(hBuilder,&args,scratch.ptr,scratch.bytes,accel->ptr,accel->bytes,
+                                  nullptr,nullptr,&bounds,&rtasBytes);
+  const double t3 = getSeconds();
+  if (err != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("build failed");
+
+  size_t scratchBytesPeak = scratch.bytes;
+  const unsigned char* scratchBytesPtr = (const unsigned char*) scratch.ptr;
+  while (scratchBytesPeak > 0 && scratchBytesPtr[scratchBytesPeak-1] == SCRATCH_SENTINEL)
+    scratchBytesPeak--;
+
+  result.propertiesSeconds = t1-t0;
+  result.buildSeconds = t3-t2;
+  result.scratchBytes = props.scratchBufferSizeBytes;
+  result.scratchBytesPeak = scratchBytesPeak;
+  result.rtasBytesExpected = props.rtasBufferSizeBytesExpected;
+  result.rtasBytesMax = props.rtasBufferSizeBytesMaxRequired;
+  result.rtasBytes = rtasBytes;
+  result.statistics = statistics;
+  if (boundsOut) *boundsOut = bounds;
+
+  return accel;
+}
+
+static double computeSAH(const void* accel)
+{
+  ze_rtas_statistics_exp_t stats;
+  memset(&stats,0,sizeof(stats));
+  stats.stype = ZE_STRUCTURE_TYPE_RTAS_STATISTICS_EXP;
+  if (zeRTASGetStatisticsExpImpl(accel,&stats) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("statistics query failed");
+  return stats.sah;
+}
+
+static std::unique_ptr<Scene> createScene(ze_rtas_builder_exp_handle_t hBuilder, SceneType type, size_t numPrimitives)
+{
+  std::unique_ptr<Scene> scene(new Scene(type,numPrimitives));
+  std::mt19937 rng(0x56FE238A);
+
+  switch (type)
+  {
+  case SceneType::TRIANGLE_GRID:
+    scene->meshes.resize(1);
+    addGrid(scene->meshes[0],numPrimitives,rng);
+    break;
+
+  case SceneType::TRIANGLE_SOUP:
+    scene->meshes.resize(1);
+    addSoup(scene->meshes[0],numPrimitives,rng);
+    break;
+
+  case SceneType::MIXED:
+    scene->meshes.resize(1);
+    scene->procedurals.resize(1);
+    addSoup(scene->meshes[0],numPrimitives-numPrimitives/2,rng);
+    addBoxes(scene->procedurals[0],numPrimitives/2,rng);
+    break;
+
+  case SceneType::INSTANCES:
+  {
+    /* the instanced mesh gets built once and is not part of the measurement */
+    TriangleMesh mesh;
+    addSoup(mesh,INSTANCED_MESH_TRIANGLES,rng);
+    ze_rtas_builder_triangles_geometry_info_exp_t info = mesh.geometryInfo();
+    std::vector<const ze_rtas_builder_geometry_info_exp_t*> geometries(1,(const ze_rtas_builder_geometry_info_exp_t*)&info);
+    BuildResult result;
+    scene->instancedAccel = build(hBuilder,geometries,ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH,&scene->instancedBounds,result);
+
+    /* instances are placed on a jittered grid with random rotation around the y axis */
+    std::uniform_real_distribution<float> uniform(0.0f,1.0f);
+    const size_t width = std::max(size_t(1),(size_t) std::ceil(std::sqrt(double(numPrimitives))));
+    for (size_t i=0; i<numPrimitives; i++)
+    {
+      const float angle = 2.0f*float(M_PI)*uniform(rng);
+      const float c = std::cos(angle), s = std::sin(angle);
+      const float px = float(i%width) + 0.5f*uniform(rng);
+      const float pz = float(i/width) + 0.5f*uniform(rng);
+      ze_rtas_transform_float3x4_column_major_exp_t xfm = {
+        c, 0.0f, -s,
+        0.0f, 1.0f, 0.0f,
+        s, 0.0f, c,
+        px, 0.0f, pz
+      };
+      scene->transforms.push_back(xfm);
+    }
+    break;
+  }
+  }
+
+  for (auto& mesh : scene->meshes)
+    scene->triangleInfos.push_back(mesh.geometryInfo());
+
+  for (auto& boxes : scene->procedurals)
+    scene->proceduralInfos.push_back(boxes.geometryInfo());
+
+  for (auto& xfm : scene->transforms)
+  {
+    ze_rtas_builder_instance_geometry_info_exp_t info;
+    memset(&info,0,sizeof(info));
+    info.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE;
+    info.instanceFlags = 0;
+    info.geometryMask = 0xFF;
+    info.transformFormat = ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_COLUMN_MAJOR;
+    info.instanceUserID = (uint32_t) scene->instanceInfos.size();
+    info.pTransform = (float*) &xfm;
+    info.pBounds = &scene->instancedBounds;
+    info.pAccelerationStructure = scene->instancedAccel->ptr;
+    scene->instanceInfos.push_back(info);
+  }
+
+  for (auto& info : scene->triangleInfos)
+    scene->geometries.push_back((const ze_rtas_builder_geometry_info_exp_t*) &info);
+  for (auto& info : scene->proceduralInfos)
+    scene->geometries.push_back((const ze_rtas_builder_geometry_info_exp_t*) &info);
+  for (auto& info : scene->instanceInfos)
+    scene->geometries.push_back((const ze_rtas_builder_geometry_info_exp_t*) &info);
+
+  return scene;
+}
+
+template<typename T>
+static std::vector<T> parseList(const char* str, T (*parse)(const std::string&))
+{
+  std::vector<T> values;
+  std::stringstream stream(str);
+  std::string item;
+  while (std::getline(stream,item,','))
+    if (!item.empty()) values.push_back(parse(item));
+  return values;
+}
+
+static size_t parseSize(const std::string& str)
+{
+  char* end = nullptr;
+  double value = strtod(str.c_str(),&end);
+  if      (*end == 'K' || *end == 'k') value *= 1E3;
+  else if (*end == 'M' || *end == 'm') value *= 1E6;
+  else if (*end != 0) throw std::runtime_error("invalid size " + str);
+  if (value < 1.0) throw std::runtime_error("invalid size " + str);
+  return (size_t) value;
+}
+
+static uint32_t parseThreads(const std::string& str)
+{
+  const int threads = atoi(str.c_str());
+  if (threads <= 0) throw std::runtime_error("invalid thread count " + str);
+  return (uint32_t) threads;
+}
+
+static SceneType parseScene(const std::string& str)
+{
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED })
+    if (str == sceneName(type)) return type;
+  throw std::runtime_error("invalid scene " + str);
+}
+
+static ze_rtas_builder_build_quality_hint_exp_t parseQuality(const std::string& str)
+{
+  for (auto quality : { ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH })
+    if (str == qualityName(quality)) return quality;
+  throw std::runtime_error("invalid quality " + str);
+}
+
+/* JSON has no representation for infinity, too short phases get reported as null */
+static std::string throughput(double mprims, double seconds)
+{
+  if (!(seconds > 0.0)) return "null";
+  std::stringstream str;
+  str << mprims/seconds;
+  return str.str();
+}
+
+/* builds all configurations with the number of threads the builder arena got created with */
+static void runBenchmark(const std::vector<SceneType>& scenes, const std::vector<size_t>& sizes,
+                         const std::vector<ze_rtas_builder_build_quality_hint_exp_t>& qualities,
+                         uint32_t numThreads, uint32_t repeat, std::ostream& out)
+{
+  ze_rtas_builder_exp_desc_t builderDesc;
+  memset(&builderDesc,0,sizeof(builderDesc));
+  builderDesc.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_EXP_DESC;
+  builderDesc.builderVersion = ZE_RTAS_BUILDER_EXP_VERSION_CURRENT;
+
+  /* the internal builder does not use the driver handle */
+  ze_rtas_builder_exp_handle_t hBuilder = nullptr;
+  if (zeRTASBuilderCreateExpImpl((ze_driver_handle_t)1,&builderDesc,&hBuilder) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("ze_rtas_builder creation failed");
+
+  bool first = true;
+  for (SceneType type : scenes)
+  {
+    for (size_t numPrimitives : sizes)
+    {
+      std::unique_ptr<Scene> scene = createScene(hBuilder,type,numPrimitives);
+
+      for (auto quality : qualities)
+      {
+        /* the fastest build of all repetitions gets reported */
+        BuildResult best;
+        std::shared_ptr<AlignedBuffer> accel;
+        double propertiesSeconds = std::numeric_limits<double>::infinity();
+        for (uint32_t r=0; r<repeat; r++)
+        {
+          BuildResult result;
+          accel = build(hBuilder,scene->geometries,quality,nullptr,result);
+          propertiesSeconds = std::min(propertiesSeconds,result.propertiesSeconds);
+          if (r == 0 || result.buildSeconds < best.buildSeconds)
+            best = result;
+        }
+        best.propertiesSeconds = propertiesSeconds;
+        best.sah = computeSAH(accel->ptr);
+
+        const double mprims = double(numPrimitives)*1E-6;
+        if (!first) out << "," << std::endl;
+        first = false;
+        out << "    {" << std::endl;
+        out << "      \"scene\": \"" << sceneName(type) << "\"," << std::endl;
+        out << "      \"primitives\": " << numPrimitives << "," << std::endl;
+        out << "      \"quality\": \"" << qualityName(quality) << "\"," << std::endl;
+        out << "      \"threads\": " << numThreads << "," << std::endl;
+        out << "      \"phases\": {" << std::endl;
+        out << "        \"properties\": { \"seconds\": " << best.propertiesSeconds << ", \"mprims_per_s\": " << throughput(mprims,best.propertiesSeconds) << " }," << std::endl;
+        out << "        \"build\": { \"seconds\": " << best.buildSeconds << ", \"mprims_per_s\": " << throughput(mprims,best.buildSeconds) << " }," << std::endl;
+        const std::pair<const char*,double> phases[] = {
+          { "setup"    , best.statistics.setupSeconds },
+          { "quadify"  , best.statistics.quadifySeconds },
+          { "primref"  , best.statistics.primRefSeconds },
+          { "filter"   , best.statistics.filterSeconds },
+          { "presplit" , best.statistics.presplitSeconds },
+          { "hierarchy", best.statistics.hierarchySeconds },
+          { "finalize" , best.statistics.finalizeSeconds }
+        };
+        for (size_t i=0; i<std::size(phases); i++) {
+          out << "        \"" << phases[i].first << "\": { \"seconds\": " << phases[i].second << ", \"mprims_per_s\": " << throughput(mprims,phases[i].second) << " }";
+          out << (i+1 < std::size(phases) ? "," : "") << std::endl;
+        }
+        out << "      }," << std::endl;
+        out << "      \"build_primitives\": " << best.statistics.numBuildPrimitives << "," << std::endl;
+        out << "      \"quad_pairing_rate\": " << best.statistics.quadPairingRate << "," << std::endl;
+        out << "      \"internal_nodes\": " << best.statistics.numInternalNodes << "," << std::endl;
+        out << "      \"leaves\": " << best.statistics.numQuadLeaves + best.statistics.numProceduralLeaves + best.statistics.numInstanceLeaves << "," << std::endl;
+        out << "      \"scratch_bytes\": " << best.scratchBytes << "," << std::endl;
+        out << "      \"scratch_bytes_peak\": " << best.scratchBytesPeak << "," << std::endl;
+        out << "      \"rtas_bytes_expected\": " << best.rtasBytesExpected << "," << std::endl;
+        out << "      \"rtas_bytes_max\": " << best.rtasBytesMax << "," << std::endl;
+        out << "      \"rtas_bytes\": " << best.rtasBytes << "," << std::endl;
+        out << "      \"sah\": " << best.sah << std::endl;
+        out << "    }";
+        out.flush();
+      }
+    }
+  }
+
+  if (zeRTASBuilderDestroyExpImpl(hBuilder) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("ze_rtas_builder destruction failed");
+}
+
+/* environment variable that sizes the thread arena of the builder when the library gets loaded */
+static const char* BUILDER_THREADS_ENVIRONMENT_VARIABLE = "ZE_RAYTRACING_BUILDER_THREADS";
+
+/* runs the benchmark for one thread count in its own process and returns its JSON result entries */
+static std::string runProcess(const std::vector<std::string>& args, uint32_t numThreads)
+{
+  const std::string threads = std::to_string(numThreads);
+#if defined(_WIN32)
+  _putenv_s(BUILDER_THREADS_ENVIRONMENT_VARIABLE,threads.c_str());
+#else
+  setenv(BUILDER_THREADS_ENVIRONMENT_VARIABLE,threads.c_str(),1);
+#endif
+
+  std::string command = "\"" + getExecutableFileName() + "\"";
+  for (const std::string& arg : args) command += " \"" + arg + "\"";
+  command += " --results-only";
+
+#if defined(_WIN32)
+  FILE* pipe = _popen(("\"" + command + "\"").c_str(),"r");
+#else
+  FILE* pipe = popen(command.c_str(),"r");
+#endif
+  if (pipe == nullptr) throw std::runtime_error("cannot run " + command);
+
+  std::string results;
+  char buffer[4096];
+  for (size_t bytes; (bytes = fread(buffer,1,sizeof(buffer),pipe)) > 0; )
+    results.append(buffer,bytes);
+
+#if defined(_WIN32)
+  const int status = _pclose(pipe);
+#else
+  const int status = pclose(pipe);
+#endif
+  if (status != 0) throw std::runtime_error("benchmark with " + threads + " threads failed");
+  return results;
+}
+
+static void printUsage()
+{
+  std::cout << "usage: rtbuild_bench [options]" << std::endl;
+  std::cout << "  --scenes <list>     scenes to build: grid,soup,instances,mixed (default all)" << std::endl;
+  std::cout << "  --sizes <list>      number of primitives, K and M suffixes allowed (default 1K,10K,100K,1M)" << std::endl;
+  std::cout << "  --quality <list>    build quality hints: low,medium,high (default all)" << std::endl;
+  std::cout << "  --threads <list>    thread counts (default powers of two up to the number of hardware threads)" << std::endl;
+  std::cout << "  --repeat <int>      builds per configuration, the fastest one gets reported (default 3)" << std::endl;
+  std::cout << "  -o <file>           write JSON report to file instead of stdout" << std::endl;
+  std::cout << "  --results-only      write only the result entries, used for the thread counts run in child processes" << std::endl;
+  std::cout << "every thread count runs in its own process with " << BUILDER_THREADS_ENVIRONMENT_VARIABLE << " set," << std::endl;
+  std::cout << "if that variable is set only its thread count gets measured" << std::endl;
+}
+
+int main(int argc, char* argv[]) try
+{
+  std::vector<SceneType> scenes = { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED };
+  std::vector<size_t> sizes = { 1000, 10000, 100000, 1000000 };
+  std::vector<ze_rtas_builder_build_quality_hint_exp_t> qualities = {
+    ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH
+  };
+  std::vector<uint32_t> threads;
+  bool threadsGiven = false;
+  uint32_t repeat = 3;
+  std::string output;
+  bool resultsOnly = false;
+
+  /* the options passed on to the child processes */
+  std::vector<std::string> args;
+
+  const uint32_t maxThreads = (uint32_t) tbb::this_task_arena::max_concurrency();
+  for (uint32_t i=1; i<maxThreads; i*=2) threads.push_back(i);
+  threads.push_back(maxThreads);
+
+  /* parse all command line options */
+  for (int i=1; i<argc; i++)
+  {
+    if (strcmp(argv[i], "--scenes") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --scenes <list>: syntax error");
+      args.insert(args.end(), { argv[i-1], argv[i] });
+      scenes = parseList(argv[i],parseScene);
+    }
+    else if (strcmp(argv[i], "--sizes") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --sizes <list>: syntax error");
+      args.insert(args.end(), { argv[i-1], argv[i] });
+      sizes = parseList(argv[i],parseSize);
+    }
+    else if (strcmp(argv[i], "--quality") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --quality <list>: syntax error");
+      args.insert(args.end(), { argv[i-1], argv[i] });
+      qualities = parseList(argv[i],parseQuality);
+    }
+    else if (strcmp(argv[i], "--threads") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --threads <list>: syntax error");
+      threads = parseList(argv[i],parseThreads);
+      threadsGiven = true;
+    }
+    else if (strcmp(argv[i], "--repeat") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: --repeat <int>: syntax error");
+      args.insert(args.end(), { argv[i-1], argv[i] });
+      repeat = std::max(1,atoi(argv[i]));
+    }
+    else if (strcmp(argv[i], "-o") == 0) {
+      if (++i >= argc) throw std::runtime_error("Error: -o <file>: syntax error");
+      output = argv[i];
+    }
+    else if (strcmp(argv[i], "--results-only") == 0) {
+      resultsOnly = true;
+    }
+    else if (strcmp(argv[i], "--help") == 0) {
+      printUsage();
+      return 0;
+    }
+    else {
+      std::cout << "ERROR: invalid command line option " << argv[i] << std::endl;
+      printUsage();
+      return 1;
+    }
+  }
+
+  /* the builder arena got sized when the library got loaded, thus other thread counts run in child processes */
+  const char* builderThreads = getenv(BUILDER_THREADS_ENVIRONMENT_VARIABLE);
+  if (builderThreads != nullptr)
+  {
+    const uint32_t numThreads = parseThreads(builderThreads);
+    if (threadsGiven && threads != std::vector<uint32_t>(1,numThreads))
+      throw std::runtime_error(std::string("--threads has to match ") + BUILDER_THREADS_ENVIRONMENT_VARIABLE);
+    threads = { numThreads };
+  }
+
+  std::ofstream file;
+  if (!output.empty()) {
+    file.open(output);
+    if (!file) throw std::runtime_error("cannot open " + output);
+  }
+  std::ostream& out = output.empty() ? std::cout : file;
+
+  if (resultsOnly) {
+    if (builderThreads == nullptr) throw std::runtime_error(std::string("--results-only requires ") + BUILDER_THREADS_ENVIRONMENT_VARIABLE);
+    runBenchmark(scenes,sizes,qualities,threads[0],repeat,out);
+    return 0;
+  }
+
+  out << "{" << std::endl;
+  out << "  \"hardware_threads\": " << maxThreads << "," << std::endl;
+  out << "  \"results\": [" << std::endl;
+
+  if (builderThreads != nullptr)
+    runBenchmark(scenes,sizes,qualities,threads[0],repeat,out);
+  else
+  {
+    bool first = true;
+    for (uint32_t numThreads : threads)
+    {
+      const std::string results = runProcess(args,numThreads);
+      if (results.empty()) continue;
+      if (!first) out << "," << std::endl;
+      first = false;
+      out << results;
+      out.flush();
+    }
+  }
+
+  out << std::endl << "  ]" << std::endl;
+  out << "}" << std::endl;
+
+  return 0;
+}
+catch (const std::exception& e)
+{
+  std::cerr << "ERROR: " << e.what() << std::endl;
+  return 1;
+}
@@ -27,3 +27,8 @@ IF (NOT WIN32)
   SET(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -z relro -z now")          # re-arranges data sections to increase security
   SET(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -pie")                       # enables position independent execution for executable
 ENDIF()
+
+SET(FLAGS_SSE42  "-msse4.2")                                                     # flags of the ISA specific builder targets
+SET(FLAGS_AVX2   "-mf16c -mavx2 -mfma -mlzcnt -mbmi -mbmi2")
+SET(FLAGS_AVX512 "${FLAGS_AVX2} -mavx512f -mavx512dq -mavx512cd -mavx512bw -mavx512vl")
+SET(FLAGS_ISA_OBJECTS "-fvisibility=hidden -fvisibility-inlines-hidden")              # symbols of the ISA specific builder objects stay inside of the library
@@ -12,3 +12,7 @@ ENDIF()
 
 SET(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${SECURE_LINKER_FLAGS}")
 SET(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} ${SECURE_LINKER_FLAGS}")
+
+SET(FLAGS_SSE42  "/D__SSE3__ /D__SSSE3__ /D__SSE4_1__ /D__SSE4_2__")  # flags of the ISA specific builder targets
+SET(FLAGS_AVX2   "/arch:AVX2")
+SET(FLAGS_AVX512 "/arch:AVX512")
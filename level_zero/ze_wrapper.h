@@ -23,6 +23,275 @@ typedef struct _ze_rtas_builder_build_op_debug_exp_desc_t
   
 } ze_rtas_builder_build_op_debug_exp_desc_t;
 
+//////////////////////
+// Build op flags extension
+
+#define ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS ((ze_rtas_builder_build_op_exp_flag_t)ZE_BIT(16))  ///< store parent pointer and number of children of each internal node
+#define ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_QUANTIZED_SAH ((ze_rtas_builder_build_op_exp_flag_t)ZE_BIT(17))  ///< evaluate SAH using the quantized child bounds of the hardware
+#define ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_PACK_PROCEDURALS ((ze_rtas_builder_build_op_exp_flag_t)ZE_BIT(18))  ///< share procedural leaves between neighboring fat leaves
+#define ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_FIRST_TOUCH_SCRATCH ((ze_rtas_builder_build_op_exp_flag_t)ZE_BIT(19))  ///< touch the scratch buffer with the primref generation tasks first, to spread it over the NUMA nodes of their threads (not for streaming builds)
+#define ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SHARE_DUPLICATE_INDICES ((ze_rtas_builder_build_op_exp_flag_t)ZE_BIT(20))  ///< detect triangle geometries with identical index buffers and pair their triangles only once
+#define ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SCRATCH_IN_RTAS_BUFFER ((ze_rtas_builder_build_op_exp_flag_t)ZE_BIT(21))  ///< place the primrefs at the end of the acceleration structure buffer, the optional scratch buffer holds chunks of primrefs that do not fit behind the acceleration structure data
+
+// Builds with SCRATCH_IN_RTAS_BUFFER may pass a null scratch buffer of size 0. An acceleration
+// structure buffer of rtasBufferSizeBytesMaxRequired then always suffices. A smaller buffer, for
+// instance of rtasBufferSizeBytesExpected, may fail with ZE_RESULT_EXP_RTAS_BUILD_RETRY when the
+// acceleration structure data reaches the primrefs, pRtasBufferSizeBytes then returns a larger
+// size to retry with.
+
+//////////////////////
+// Size estimation extension
+
+#define ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_ESTIMATE_EXP_DESC ((ze_structure_type_t)0x00020021)  ///< ::ze_rtas_builder_build_op_estimate_exp_desc_t
+
+typedef uint32_t ze_rtas_builder_build_op_estimate_exp_flags_t;
+typedef enum _ze_rtas_builder_build_op_estimate_exp_flag_t
+{
+  ZE_RTAS_BUILDER_BUILD_OP_ESTIMATE_EXP_FLAG_QUADIFY = ZE_BIT(0),         ///< pair triangles to quads to compute tight buffer sizes (reads index buffers)
+  ZE_RTAS_BUILDER_BUILD_OP_ESTIMATE_EXP_FLAG_FORCE_UINT32 = 0x7fffffff
+
+} ze_rtas_builder_build_op_estimate_exp_flag_t;
+
+typedef struct _ze_rtas_builder_build_op_estimate_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  ze_rtas_builder_build_op_estimate_exp_flags_t flags;                    ///< [in] 0 or some combination of ::ze_rtas_builder_build_op_estimate_exp_flag_t
+
+} ze_rtas_builder_build_op_estimate_exp_desc_t;
+
+//////////////////////
+// Ray distribution extension
+
+#define ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_RAY_DISTRIBUTION_EXP_DESC ((ze_structure_type_t)0x00020022)  ///< ::ze_rtas_builder_build_op_ray_distribution_exp_desc_t
+
+typedef enum _ze_rtas_builder_child_order_exp_t
+{
+  ZE_RTAS_BUILDER_CHILD_ORDER_EXP_HIT_PROBABILITY = 0,                    ///< store children with largest area projected along the ray directions first
+  ZE_RTAS_BUILDER_CHILD_ORDER_EXP_DISTANCE = 1,                           ///< store children that get entered first along the ray directions first
+  ZE_RTAS_BUILDER_CHILD_ORDER_EXP_FORCE_UINT32 = 0x7fffffff
+
+} ze_rtas_builder_child_order_exp_t;
+
+typedef struct _ze_rtas_builder_build_op_ray_distribution_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  ze_rtas_builder_child_order_exp_t childOrder;                           ///< [in] how to order the children of internal nodes
+  uint32_t numDirections;                                                 ///< [in] number of ray directions
+  const ze_rtas_float3_exp_t* pDirections;                                ///< [in] directions of representative rays or of direction histogram bins
+  const float* pWeights;                                                  ///< [in][optional] weight of each direction, e.g. histogram bin counts
+
+} ze_rtas_builder_build_op_ray_distribution_exp_desc_t;
+
+//////////////////////
+// Build statistics extension
+
+#define ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STATISTICS_EXP_DESC ((ze_structure_type_t)0x00020023)  ///< ::ze_rtas_builder_build_op_statistics_exp_desc_t
+
+typedef struct _ze_rtas_builder_build_op_statistics_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  double setupSeconds;                                                    ///< [out] time to count primitives and estimate the worst case size
+  double quadifySeconds;                                                  ///< [out] time to pair triangles to quads
+  double primRefSeconds;                                                  ///< [out] time to create the primitive references
+  double filterSeconds;                                                   ///< [out] time of the second primitive reference pass, which only runs when
+                                                                          ///< invalid primitives got filtered out
+  double presplitSeconds;                                                 ///< [out] time to pre-split large triangles (high quality builds only)
+  double hierarchySeconds;                                                ///< [out] time to build the hierarchy and leaves
+  double finalizeSeconds;                                                 ///< [out] time to write the header and back pointers and count the nodes
+  double totalSeconds;                                                    ///< [out] time of the entire build, excluding input validation
+  uint64_t numInputPrimitives;                                            ///< [out] number of primitives of all geometries
+  uint64_t numInputTriangles;                                             ///< [out] number of triangles of all geometries
+  uint64_t numTrianglePairs;                                              ///< [out] number of quads created by pairing two triangles
+  float quadPairingRate;                                                  ///< [out] fraction of triangles that got paired into quads
+  uint64_t numPrimitives;                                                 ///< [out] number of primitives after triangle pairing
+  uint64_t numValidPrimitives;                                            ///< [out] number of primitives after filtering out invalid ones
+  uint64_t numBuildPrimitives;                                            ///< [out] number of primitives after pre-splitting
+  uint64_t numInternalNodes;                                              ///< [out] number of internal nodes
+  uint64_t numQuadLeaves;                                                 ///< [out] number of quad leaves
+  uint64_t numProceduralLeaves;                                           ///< [out] number of procedural leaves
+  uint64_t numInstanceLeaves;                                             ///< [out] number of instance leaves
+  uint64_t rtasBytesUsed;                                                 ///< [out] bytes requested from the acceleration structure buffer, exceeds
+                                                                          ///< rtasBytesProvided when the build ran out of memory
+  uint64_t rtasBytesProvided;                                             ///< [out] size of the acceleration structure buffer
+  ze_bool_t retry;                                                        ///< [out] true when the build returned ::ZE_RESULT_EXP_RTAS_BUILD_RETRY,
+                                                                          ///< node and leaf counts are zero then
+
+} ze_rtas_builder_build_op_statistics_exp_desc_t;
+
+//////////////////////
+// Build trace extension, setting the ZE_RAYTRACING_BUILD_TRACE environment variable
+// to a file name appends the traces of all builds to that file instead
+
+#define ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_TRACE_EXP_DESC ((ze_structure_type_t)0x00020024)  ///< ::ze_rtas_builder_build_op_trace_exp_desc_t
+
+typedef struct _ze_rtas_builder_build_op_trace_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  const char* pTraceFile;                                                 ///< [in] file to write a Chrome trace of the build phases and large build tasks to
+
+} ze_rtas_builder_build_op_trace_exp_desc_t;
+
+//////////////////////
+// Build capture extension, setting the ZE_RAYTRACING_BUILD_CAPTURE environment variable
+// to a file prefix captures every build to <prefix><N>.rtcap instead
+
+#define ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_CAPTURE_EXP_DESC ((ze_structure_type_t)0x00020026)  ///< ::ze_rtas_builder_build_op_capture_exp_desc_t
+
+typedef struct _ze_rtas_builder_build_op_capture_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  const char* pCaptureFile;                                               ///< [in] file to write the build descriptor and all referenced geometry data to,
+                                                                          ///< which the rtas_replay tool can build again
+
+} ze_rtas_builder_build_op_capture_exp_desc_t;
+
+//////////////////////
+// Streaming build extension, the builder builds the scene in spatially compact chunks
+// whenever the scratch buffer cannot hold the primitive references of the entire scene
+
+#define ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STREAMING_EXP_DESC ((ze_structure_type_t)0x00020027)  ///< ::ze_rtas_builder_build_op_streaming_exp_desc_t
+
+typedef struct _ze_rtas_builder_build_op_streaming_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  size_t scratchBudgetBytes;                                              ///< [in] upper bound for the scratch buffer size returned by
+                                                                          ///< ::zeRTASBuilderGetBuildPropertiesExp
+
+} ze_rtas_builder_build_op_streaming_exp_desc_t;
+
+//////////////////////
+// Build input hash extension, builds with equal hashes produce equal acceleration structures,
+// such that applications can reuse a previously built acceleration structure instead
+
+#define ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_HASH_EXP_DESC ((ze_structure_type_t)0x00020028)  ///< ::ze_rtas_builder_build_op_hash_exp_desc_t
+
+typedef struct _ze_rtas_builder_build_op_hash_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  uint64_t hash;                                                          ///< [out] content hash of the geometry data, descriptors, format, quality and flags,
+                                                                          ///< instances and procedurals are identified by their acceleration structure
+                                                                          ///< address, or bounds callback and geometry user pointer
+
+} ze_rtas_builder_build_op_hash_exp_desc_t;
+
+//////////////////////
+// Acceleration structure statistics query
+
+#define ZE_STRUCTURE_TYPE_RTAS_STATISTICS_EXP ((ze_structure_type_t)0x00020025)  ///< ::ze_rtas_statistics_exp_t
+
+typedef struct _ze_rtas_internal_node_statistics_exp_t
+{
+  double sah;                                                             ///< [out] SAH cost of the internal nodes relative to the root bounds
+  uint64_t numNodes;                                                      ///< [out] number of internal nodes
+  uint64_t numChildrenUsed;                                               ///< [out] number of valid children
+  uint64_t numChildrenTotal;                                              ///< [out] number of child slots
+  uint64_t numBytes;                                                      ///< [out] size of all internal nodes in bytes
+  double fillRate;                                                        ///< [out] numChildrenUsed / numChildrenTotal
+
+} ze_rtas_internal_node_statistics_exp_t;
+
+typedef struct _ze_rtas_leaf_statistics_exp_t
+{
+  double sah;                                                             ///< [out] SAH cost of the leaves relative to the root bounds
+  uint64_t numLeaves;                                                     ///< [out] number of leaves
+  uint64_t numBlocks;                                                     ///< [out] number of 64 byte blocks referenced (procedural leaves only)
+  uint64_t numPrimsUsed;                                                  ///< [out] number of valid primitive slots
+  uint64_t numPrimsTotal;                                                 ///< [out] number of primitive slots
+  uint64_t numBytesUsed;                                                  ///< [out] bytes used by valid primitives
+  uint64_t numBytesTotal;                                                 ///< [out] size of all leaves in bytes
+  double fillRate;                                                        ///< [out] numPrimsUsed / numPrimsTotal
+
+} ze_rtas_leaf_statistics_exp_t;
+
+typedef struct _ze_rtas_statistics_exp_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  void* pNext;                                                            ///< [in,out][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  double sah;                                                             ///< [out] total SAH cost of nodes and leaves
+  uint64_t numBytes;                                                      ///< [out] total size of nodes and leaves in bytes
+  ze_rtas_aabb_exp_t bounds;                                              ///< [out] bounds of the acceleration structure
+  ze_rtas_internal_node_statistics_exp_t internalNodes;                   ///< [out] statistics of the internal nodes
+  ze_rtas_leaf_statistics_exp_t quadLeaves;                               ///< [out] statistics of the triangle and quad leaves
+  ze_rtas_leaf_statistics_exp_t proceduralLeaves;                         ///< [out] statistics of the procedural leaves
+  ze_rtas_leaf_statistics_exp_t instanceLeaves;                           ///< [out] statistics of the instance leaves, instanced
+                                                                          ///< acceleration structures are not included
+
+} ze_rtas_statistics_exp_t;
+
+//////////////////////
+// Acceleration structure copy, relocates a built acceleration structure into another buffer
+
+#define ZE_STRUCTURE_TYPE_RTAS_COPY_EXP_DESC ((ze_structure_type_t)0x00020029)  ///< ::ze_rtas_copy_exp_desc_t
+
+typedef struct _ze_rtas_remap_entry_exp_t
+{
+  const void* pSrcRtasBuffer;                                             ///< [in] previous address of an instanced acceleration structure
+  size_t rtasBufferSizeBytes;                                             ///< [in] size of the instanced acceleration structure in bytes
+  const void* pDstRtasBuffer;                                             ///< [in] new address of the instanced acceleration structure
+
+} ze_rtas_remap_entry_exp_t;
+
+typedef struct _ze_rtas_copy_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  void* dispatchGlobalsPtr;                                               ///< [in][optional] dispatch globals pointer to store in the copy,
+                                                                          ///< null keeps the pointer of the source
+  uint32_t numRemapEntries;                                               ///< [in] number of entries in pRemapEntries
+  const ze_rtas_remap_entry_exp_t* pRemapEntries;                         ///< [in][optional] instances referencing an acceleration structure
+                                                                          ///< of some entry get redirected to its new address
+
+} ze_rtas_copy_exp_desc_t;
+
+//////////////////////
+// Acceleration structure serialization, stores a built acceleration structure in a host buffer
+// that can get written to disk and loaded again in a later run
+
+#define ZE_STRUCTURE_TYPE_RTAS_SERIALIZE_EXP_DESC ((ze_structure_type_t)0x0002002A)  ///< ::ze_rtas_serialize_exp_desc_t
+#define ZE_STRUCTURE_TYPE_RTAS_DESERIALIZE_EXP_DESC ((ze_structure_type_t)0x0002002B)  ///< ::ze_rtas_deserialize_exp_desc_t
+
+typedef struct _ze_rtas_serialize_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  uint32_t numAccels;                                                     ///< [in] number of entries in ppAccels
+  const void** ppAccels;                                                  ///< [in][optional] acceleration structures referenced by instances, the
+                                                                          ///< serialized instances refer to them by their index in this array
+
+} ze_rtas_serialize_exp_desc_t;
+
+typedef struct _ze_rtas_deserialize_exp_desc_t
+{
+  ze_structure_type_t stype;                                              ///< [in] type of this structure
+  const void* pNext;                                                      ///< [in][optional] must be null or a pointer to an extension-specific
+                                                                          ///< structure (i.e. contains stype and pNext).
+  ze_rtas_format_exp_t rtasFormat;                                        ///< [in] acceleration structure format of the device, loading fails with
+                                                                          ///< ::ZE_RESULT_EXP_ERROR_OPERANDS_INCOMPATIBLE if the serialized format
+                                                                          ///< is not compatible
+  uint32_t numAccels;                                                     ///< [in] number of entries in ppAccels
+  const void** ppAccels;                                                  ///< [in][optional] loaded acceleration structures in the order passed
+                                                                          ///< when serializing
+  void* dispatchGlobalsPtr;                                               ///< [in][optional] dispatch globals pointer to store in the header
+
+} ze_rtas_deserialize_exp_desc_t;
+
 ////////////////////
 
 struct ZeWrapper
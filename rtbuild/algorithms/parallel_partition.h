@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "../simd/simd.h"
 #include "parallel_for.h"
 #include "../math/range.h"
 
@@ -20,6 +21,47 @@ namespace embree
   {
     T* l = array + begin;
     T* r = array + end - 1;
+
+#if defined(__AVX2__)
+    /* classifies blocks of eight elements from both ends without branching
+     * on the predicate, compacts the offsets of misplaced elements and swaps
+     * them pairwise, the remainder is handled by the scalar loop below */
+    __aligned(32) int offsetsL[8], offsetsR[8];
+    size_t numL = 0, numR = 0, startL = 0, startR = 0;
+    
+    while (r - l + 1 >= 16)
+    {
+      if (numL == 0)
+      {
+        int mask = 0;
+        for (int i=0; i<8; i++) mask |= int(!is_left(l[i])) << i;
+        vint8::store(offsetsL,vint8::compact(vboolf8(mask),vint8(step)));
+        numL = popcnt((size_t)mask); startL = 0;
+      }
+      if (numR == 0)
+      {
+        int mask = 0;
+        for (int i=0; i<8; i++) mask |= int(is_left(*(r-i))) << i;
+        vint8::store(offsetsR,vint8::compact(vboolf8(mask),vint8(step)));
+        numR = popcnt((size_t)mask); startR = 0;
+      }
+
+      const size_t num = min(numL,numR);
+      for (size_t i=0; i<num; i++)
+        xchg(l[offsetsL[startL+i]],*(r-offsetsR[startR+i]));
+      numL -= num; startL += num;
+      numR -= num; startR += num;
+
+      if (numL == 0) {
+        for (int i=0; i<8; i++) reduction_t(leftReduction,l[i]);
+        l += 8;
+      }
+      if (numR == 0) {
+        for (int i=0; i<8; i++) reduction_t(rightReduction,*(r-i));
+        r -= 8;
+      }
+    }
+#endif
     
     while(1)
     {
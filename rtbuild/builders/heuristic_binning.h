@@ -65,6 +65,15 @@ namespace embree
           return Vec3ia(clamp(i,vint4(0),vint4(num-1)));
         }
 
+#if defined(__AVX2__)
+        /*! slower but safe binning of eight points along one dimension */
+        __forceinline vint8 bin(const vfloat8& p, const size_t dim) const
+        {
+          const vint8 i = floori((p-vfloat8(ofs[dim]))*vfloat8(scale[dim]));
+          return clamp(i,vint8(zero),vint8(int(num-1)));
+        }
+#endif
+
         /*! faster but unsafe binning */
         __forceinline Vec3ia bin_unsafe(const Vec3fa& p) const {
           return Vec3ia(floori((vfloat4(p)-ofs)*scale));
@@ -204,9 +213,50 @@ namespace embree
 	}
       }
       
+#if defined(__AVX2__)
+      /*! bins blocks of eight primitive references, returns the number of binned primitives */
+      __forceinline size_t bin8(const embree::PrimRef* prims, size_t N, const BinMapping<BINS>& mapping)
+      {
+        size_t i;
+        for (i=0; i+8<=N; i+=8)
+        {
+          /*! map eight primitives to bins */
+          vfloat8 cx,cy,cz;
+          transpose(vfloat4(prims[i+0].center2()),vfloat4(prims[i+1].center2()),vfloat4(prims[i+2].center2()),vfloat4(prims[i+3].center2()),
+                    vfloat4(prims[i+4].center2()),vfloat4(prims[i+5].center2()),vfloat4(prims[i+6].center2()),vfloat4(prims[i+7].center2()),
+                    cx,cy,cz);
+
+          __aligned(32) int b[3][8];
+          vint8::store(b[0],mapping.bin(cx,0));
+          vint8::store(b[1],mapping.bin(cy,1));
+          vint8::store(b[2],mapping.bin(cz,2));
+
+          /*! increase bounds of bins */
+          for (size_t j=0; j<8; j++)
+          {
+            const BBox3fa prim = prims[i+j].bounds();
+            const unsigned int s = prims[i+j].size();
+            counts(b[0][j],0)+=s; bounds(b[0][j],0).extend(prim);
+            counts(b[1][j],1)+=s; bounds(b[1][j],1).extend(prim);
+            counts(b[2][j],2)+=s; bounds(b[2][j],2).extend(prim);
+          }
+        }
+        return i;
+      }
+
+      template<typename OtherPrimRef>
+      __forceinline size_t bin8(const OtherPrimRef* prims, size_t N, const BinMapping<BINS>& mapping) {
+        return 0;
+      }
+#endif
+
       /*! bins an array of primitives */
       __forceinline void bin (const PrimRef* prims, size_t N, const BinMapping<BINS>& mapping)
       {
+#if defined(__AVX2__)
+        const size_t N8 = bin8(prims,N,mapping);
+        prims += N8; N -= N8;
+#endif
 	if (unlikely(N == 0)) return;
 	size_t i; 
 	for (i=0; i<N-1; i+=2)
@@ -391,7 +441,13 @@ namespace embree
       }
 
       /*! finds the best split by scanning binning information */
-      __forceinline Split best_block_size(const BinMapping<BINS>& mapping, const size_t blockSize) const
+      __forceinline Split best_block_size(const BinMapping<BINS>& mapping, const size_t blockSize) const {
+        return best_block_size(mapping,blockSize,[] (const BBox& box) { return expectedApproxHalfArea(box); });
+      }
+
+      /*! finds the best split by scanning binning information, using the provided function to calculate areas */
+      template<typename HalfAreaFunc>
+      __forceinline Split best_block_size(const BinMapping<BINS>& mapping, const size_t blockSize, const HalfAreaFunc& halfAreaFunc) const
       {
 	/* sweep from right to left and compute parallel prefix of merged bounds */
 	vfloat4 rAreas[BINS];
@@ -401,9 +457,9 @@ namespace embree
         {
           count += counts(i);
           rCounts[i] = count;
-          bx.extend(bounds(i,0)); rAreas[i][0] = expectedApproxHalfArea(bx);
-          by.extend(bounds(i,1)); rAreas[i][1] = expectedApproxHalfArea(by);
-          bz.extend(bounds(i,2)); rAreas[i][2] = expectedApproxHalfArea(bz);
+          bx.extend(bounds(i,0)); rAreas[i][0] = halfAreaFunc(bx);
+          by.extend(bounds(i,1)); rAreas[i][1] = halfAreaFunc(by);
+          bz.extend(bounds(i,2)); rAreas[i][2] = halfAreaFunc(bz);
           rAreas[i][3] = 0.0f;
         }
 	/* sweep from left to right and compute SAH */
@@ -414,9 +470,9 @@ namespace embree
 	for (size_t i=1; i<mapping.size(); i++, ii+=1)
         {
           count += counts(i-1);
-          bx.extend(bounds(i-1,0)); float Ax = expectedApproxHalfArea(bx);
-          by.extend(bounds(i-1,1)); float Ay = expectedApproxHalfArea(by);
-          bz.extend(bounds(i-1,2)); float Az = expectedApproxHalfArea(bz);
+          bx.extend(bounds(i-1,0)); float Ax = halfAreaFunc(bx);
+          by.extend(bounds(i-1,1)); float Ay = halfAreaFunc(by);
+          bz.extend(bounds(i-1,2)); float Az = halfAreaFunc(bz);
           const vfloat4 lArea = vfloat4(Ax,Ay,Az,Az);
           const vfloat4 rArea = rAreas[i];
           const vfloat4 lCount = floor(vfloat4(count     +blocks_add)*blocks_factor);
@@ -128,6 +128,25 @@ namespace embree
           return binner.best_block_size(mapping,blockSize);
         }
 
+        /*! finds the best split, using the provided function to calculate areas */
+        template<typename HalfAreaFunc>
+        __noinline const Split find_block_size(const PrimInfoRange& pinfo, const size_t blockSize, const HalfAreaFunc& halfAreaFunc)
+        {
+          if (likely(pinfo.size() < PARALLEL_THRESHOLD))
+            return find_block_size_template<false>(pinfo,blockSize,halfAreaFunc);
+          else
+            return find_block_size_template<true>(pinfo,blockSize,halfAreaFunc);
+        }
+
+        template<bool parallel, typename HalfAreaFunc>
+        __forceinline const Split find_block_size_template(const PrimInfoRange& pinfo, const size_t blockSize, const HalfAreaFunc& halfAreaFunc)
+        {
+          Binner binner(empty);
+          const BinMapping<BINS> mapping(pinfo);
+          bin_serial_or_parallel<parallel>(binner,prims,pinfo.begin(),pinfo.end(),PARALLEL_FIND_BLOCK_SIZE,mapping);
+          return binner.best_block_size(mapping,blockSize,halfAreaFunc);
+        }
+
         /*! array partitioning */
         __forceinline void split(const Split& split, const PrimInfoRange& pinfo, PrimInfoRange& linfo, PrimInfoRange& rinfo)
         {
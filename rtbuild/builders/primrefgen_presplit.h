@@ -239,9 +239,9 @@ namespace embree
       const size_t numPrimitivesExt = prims.size(); 
       const size_t numSplitPrimitivesBudget = numPrimitivesExt - numPrimitives;
 
-      /* allocate double buffer presplit items */
-      avector<PresplitItem> preSplitItem0(numPrimitivesExt);
-      avector<PresplitItem> preSplitItem1(numPrimitivesExt);
+      /* allocate double buffer presplit items, directly from the OS to use huge pages where possible */
+      ovector<PresplitItem> preSplitItem0(numPrimitivesExt);
+      ovector<PresplitItem> preSplitItem1(numPrimitivesExt);
 
       /* compute grid */
       SplittingGrid grid(pinfo.geomBounds);
@@ -351,7 +351,7 @@ namespace embree
       }
       
       /* parallel prefix sum to compute offsets for storing sub-primitives */
-      const unsigned int offset = parallel_prefix_sum(primOffset0,primOffset1,numPrimitivesToSplit,(unsigned int)0,std::plus<unsigned int>());
+      const unsigned int offset = parallel_prefix_sum(primOffset0,primOffset1,numPrimitivesToSplit,(unsigned int)0,[](unsigned int a, unsigned int b) { return a+b; });
       assert(numPrimitives+offset <= numPrimitivesExt);
       
       /* iterate over range, and split primitives into sub primitives and append them to prims array */		    
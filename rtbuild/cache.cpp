@@ -0,0 +1,229 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "cache.h"
+#include "hash.h"
+#include "serialize.h"
+#include "qbvh6.h"
+#include "sys/sysinfo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(ZE_RAYTRACING_VERSION)
+#define ZE_RAYTRACING_VERSION "unknown"
+#endif
+
+namespace embree
+{
+  namespace fs = std::filesystem;
+
+  const char* BuildCache::ENVIRONMENT_VARIABLE = "ZE_RAYTRACING_BUILD_CACHE";
+  const char* BuildCache::SIZE_ENVIRONMENT_VARIABLE = "ZE_RAYTRACING_BUILD_CACHE_SIZE";
+
+  static const char* CACHE_FILE_EXTENSION = ".rtser";
+  static const char* TEMPORARY_FILE_EXTENSION = ".tmp";
+
+  /* temporary files of processes that exited while writing get removed after this time */
+  static const std::chrono::hours TEMPORARY_FILE_LIFETIME(1);
+
+  BuildCache* BuildCache::get()
+  {
+    static BuildCache* cache = [] () -> BuildCache*
+    {
+      const char* directory = getenv(ENVIRONMENT_VARIABLE);
+      if (!directory || !*directory) return nullptr;
+
+      const char* size = getenv(SIZE_ENVIRONMENT_VARIABLE);
+      const size_t maxMB = (size && *size) ? strtoull(size,nullptr,10) : 1024;
+
+      std::error_code error;
+      fs::create_directories(directory,error);
+      if (!fs::is_directory(directory,error)) return nullptr;
+
+      /* never destroyed, such that no static destructor waits for the writer thread */
+      return new BuildCache(directory,maxMB*1024*1024);
+    }();
+    return cache;
+  }
+
+  uint64_t BuildCache::key(const ze_rtas_builder_build_op_exp_desc_t* args, uint64_t inputHash)
+  {
+    for (uint32_t geomID=0; geomID<args->numGeometries; geomID++)
+    {
+      const ze_rtas_builder_geometry_info_exp_t* geom = args->ppGeometries[geomID];
+      if (geom == nullptr) continue;
+      if (geom->geometryType != ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES &&
+          geom->geometryType != ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS)
+        return 0;
+    }
+
+    const uint64_t values[3] = {
+      inputHash,
+      hash64(ZE_RAYTRACING_VERSION,strlen(ZE_RAYTRACING_VERSION)),
+      SERIALIZED_VERSION
+    };
+    const uint64_t key = hash64(values,sizeof(values));
+    return key ? key : 1;
+  }
+
+  BuildCache::BuildCache (const std::string& directory, size_t maxBytes)
+    : directory(directory), maxBytes(maxBytes)
+  {
+    std::random_device device;
+    nonce = (uint64_t(device()) << 32) | uint64_t(device());
+  }
+
+  std::string BuildCache::fileName(uint64_t key) const
+  {
+    char name[32];
+    snprintf(name,sizeof(name),"%016llx",(unsigned long long)key);
+    return (fs::path(directory) / (std::string(name) + CACHE_FILE_EXTENSION)).string();
+  }
+
+  bool BuildCache::load(uint64_t key, void* dispatchGlobalsPtr, void* pRtasBuffer, size_t rtasBufferSizeBytes,
+                        ze_rtas_aabb_exp_t* pBounds, size_t* pRtasBufferSizeBytes)
+  {
+    const std::string file = fileName(key);
+    std::ifstream in(file,std::ios::binary | std::ios::ate);
+    if (!in) return false;
+
+    const size_t bytes = (size_t) in.tellg();
+    in.seekg(0);
+    std::vector<char> data(bytes);
+    if (!in.read(data.data(),bytes)) return false;
+
+    SerializedHeader header;
+    if (readSerializedHeader(data.data(),bytes,header) != ZE_RESULT_SUCCESS) return false;
+    if (header.numRelocations != 0 || header.rtasBytes > rtasBufferSizeBytes) return false;
+    if (deserializeRTAS(data.data(),header,0,nullptr,dispatchGlobalsPtr,pRtasBuffer) != ZE_RESULT_SUCCESS) return false;
+
+    const QBVH6* qbvh = (const QBVH6*) pRtasBuffer;
+    if (pBounds) *pBounds = { { qbvh->bounds.lower.x, qbvh->bounds.lower.y, qbvh->bounds.lower.z },
+                              { qbvh->bounds.upper.x, qbvh->bounds.upper.y, qbvh->bounds.upper.z } };
+    if (pRtasBufferSizeBytes) *pRtasBufferSizeBytes = header.rtasBytes;
+
+    /* the modification time orders the files for eviction */
+    std::error_code error;
+    fs::last_write_time(file,fs::file_time_type::clock::now(),error);
+    return true;
+  }
+
+  void BuildCache::store(uint64_t key, const void* pRtasBuffer)
+  {
+    /* the application owns the acceleration structure, thus it gets serialized before returning */
+    size_t bytes = 0;
+    if (serializeRTAS(pRtasBuffer,0,nullptr,nullptr,0,&bytes) != ZE_RESULT_SUCCESS || bytes > maxBytes)
+      return;
+
+    PendingFile file;
+    file.key = key;
+    file.data.resize(bytes);
+    if (serializeRTAS(pRtasBuffer,0,nullptr,file.data.data(),bytes,nullptr) != ZE_RESULT_SUCCESS)
+      return;
+
+    /* builds faster than the disk drop their files instead of piling up memory */
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pendingBytes + bytes > maxBytes) return;
+    pendingBytes += bytes;
+    pending.push_back(std::move(file));
+
+    /* a finished writer thread has released the mutex already, thus joining it here cannot block on us */
+    if (!writing) {
+      if (thread.joinable()) thread.join();
+      writing = true;
+      thread = std::thread([this] () { run(); });
+    }
+  }
+
+  void BuildCache::flush()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] () { return !writing; });
+    if (thread.joinable()) thread.join();
+  }
+
+  void BuildCache::run()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!pending.empty())
+    {
+      PendingFile file = std::move(pending.front());
+      pending.pop_front();
+      lock.unlock();
+
+      if (write(fileName(file.key),file.data))
+        evict();
+
+      lock.lock();
+      pendingBytes -= file.data.size();
+    }
+    writing = false;
+    condition.notify_all();
+  }
+
+  bool BuildCache::write(const std::string& name, const std::vector<char>& data)
+  {
+    /* files get written under a name unique across processes and renamed, such that concurrent processes never read partial files */
+    char suffix[64];
+    snprintf(suffix,sizeof(suffix),".%u.%016llx.%llu",getProcessID(),(unsigned long long)nonce,(unsigned long long)numWritten++);
+    const std::string tmpName = name + suffix + TEMPORARY_FILE_EXTENSION;
+
+    std::ofstream out(tmpName,std::ios::binary | std::ios::trunc);
+    out.write(data.data(),data.size());
+    out.close();
+
+    std::error_code error;
+    if (out.good()) {
+      fs::rename(tmpName,name,error);
+      if (!error) return true;
+    }
+    fs::remove(tmpName,error);
+    return false;
+  }
+
+  void BuildCache::evict()
+  {
+    struct Entry
+    {
+      fs::path path;
+      fs::file_time_type time;
+      size_t bytes;
+    };
+
+    std::vector<Entry> entries;
+    size_t totalBytes = 0;
+    std::error_code error;
+    const fs::file_time_type now = fs::file_time_type::clock::now();
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory,error))
+    {
+      const bool temporary = entry.path().extension() == TEMPORARY_FILE_EXTENSION;
+      if (entry.path().extension() != CACHE_FILE_EXTENSION && !temporary) continue;
+      const size_t bytes = (size_t) entry.file_size(error);
+      if (error) continue;
+      const fs::file_time_type time = entry.last_write_time(error);
+      if (error) continue;
+
+      if (temporary) {
+        if (now - time > TEMPORARY_FILE_LIFETIME) fs::remove(entry.path(),error);
+        continue;
+      }
+      entries.push_back({ entry.path(), time, bytes });
+      totalBytes += bytes;
+    }
+    if (totalBytes <= maxBytes) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (const Entry& entry : entries)
+    {
+      if (totalBytes <= maxBytes) break;
+      if (fs::remove(entry.path,error)) totalBytes -= entry.bytes;
+    }
+  }
+}
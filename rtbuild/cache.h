@@ -0,0 +1,94 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "rtbuild.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace embree
+{
+  /*
+
+    Persistent cache of built acceleration structures, enabled by
+    setting ZE_RAYTRACING_BUILD_CACHE to a local directory. Each
+    acceleration structure is stored in the serialized format of
+    serialize.h in a file named after a hash of the build inputs and
+    the library version. A build whose file exists gets loaded instead
+    of built, otherwise the built acceleration structure is written by
+    a background thread. When the files exceed the size budget set
+    through ZE_RAYTRACING_BUILD_CACHE_SIZE (in MB, default 1024), the
+    least recently used files get removed.
+
+    The writer thread only runs while files are pending. Destroying a
+    builder writes the pending files and joins the writer thread. The
+    cache itself is never destroyed, such that no static destructor
+    waits for the writer at process exit. Files still pending at exit
+    are lost, and a later eviction removes their temporary files.
+
+    Only builds of triangle and quad geometries get cached. Instances
+    and procedurals are identified by their addresses, which do not
+    persist across runs.
+
+   */
+
+  class BuildCache
+  {
+  public:
+
+    /* environment variables that enable the cache and set its size budget in MB */
+    static const char* ENVIRONMENT_VARIABLE;
+    static const char* SIZE_ENVIRONMENT_VARIABLE;
+
+    /* returns the cache configured through the environment, or nullptr */
+    static BuildCache* get();
+
+    /* returns the cache key of the build for the hash of its inputs, or 0 if the build cannot get cached */
+    static uint64_t key(const ze_rtas_builder_build_op_exp_desc_t* args, uint64_t inputHash);
+
+    /* loads the acceleration structure stored for the key, returns false if not present or too large for the buffer */
+    bool load(uint64_t key, void* dispatchGlobalsPtr, void* pRtasBuffer, size_t rtasBufferSizeBytes,
+              ze_rtas_aabb_exp_t* pBounds, size_t* pRtasBufferSizeBytes);
+
+    /* serializes the acceleration structure and writes it asynchronously */
+    void store(uint64_t key, const void* pRtasBuffer);
+
+    /* waits until all pending files are written and joins the writer thread */
+    void flush();
+
+  private:
+    BuildCache (const std::string& directory, size_t maxBytes);
+
+    std::string fileName(uint64_t key) const;
+
+    /* writes pending files and removes least recently used files, runs in the writer thread */
+    void run();
+    bool write(const std::string& name, const std::vector<char>& data);
+    void evict();
+
+  private:
+    struct PendingFile
+    {
+      uint64_t key;
+      std::vector<char> data;
+    };
+
+    std::string directory;
+    size_t maxBytes;
+    uint64_t nonce;           // random part of temporary file names, distinguishes processes with the same ID
+    uint64_t numWritten = 0;  // counter part of temporary file names
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<PendingFile> pending;
+    size_t pendingBytes = 0;
+    bool writing = false;
+    std::thread thread;
+  };
+}
@@ -0,0 +1,165 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "capture.h"
+#include "qbvh6.h"
+
+#include <atomic>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+namespace embree
+{
+  const char* BuildCapture::ENVIRONMENT_VARIABLE = "ZE_RAYTRACING_BUILD_CAPTURE";
+
+  static std::atomic<uint32_t> g_nextCaptureID(0);
+
+  std::string BuildCapture::nextEnvironmentFile()
+  {
+    static const char* prefix = getenv(ENVIRONMENT_VARIABLE);
+    if (!prefix || !*prefix) return std::string();
+    return std::string(prefix) + std::to_string(g_nextCaptureID++) + ".rtcap";
+  }
+
+  static void writeBuffer(std::ofstream& out, const void* ptr, size_t bytes)
+  {
+    if (bytes == 0) return;
+    if (ptr == nullptr) throw std::runtime_error("geometry buffer not specified");
+    out.write((const char*)ptr,bytes);
+  }
+
+  static void writeGeometries(std::ofstream& out, const ze_rtas_builder_build_op_exp_desc_t* args, void* pBuildUserPtr)
+  {
+    /* every acceleration structure referenced by some instance gets stored once */
+    std::map<const void*,uint32_t> accelIndices;
+    std::vector<const QBVH6*> accels;
+    for (uint32_t geomID=0; geomID<args->numGeometries; geomID++)
+    {
+      const ze_rtas_builder_geometry_info_exp_t* geom = args->ppGeometries[geomID];
+      if (geom == nullptr || geom->geometryType != ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE) continue;
+      const void* accel = ((const ze_rtas_builder_instance_geometry_info_exp_t*)geom)->pAccelerationStructure;
+      if (accelIndices.insert(std::make_pair(accel,(uint32_t)accels.size())).second)
+        accels.push_back((const QBVH6*)accel);
+    }
+
+    CaptureHeader header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,CAPTURE_MAGIC,sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.rtasFormat = args->rtasFormat;
+    header.buildQuality = args->buildQuality;
+    header.buildFlags = args->buildFlags;
+    header.numGeometries = args->numGeometries;
+    header.numAccels = (uint32_t) accels.size();
+    out.write((const char*)&header,sizeof(header));
+
+    for (const QBVH6* accel : accels)
+    {
+      const uint64_t bytes = accel->getTotalBytes();
+      out.write((const char*)&bytes,sizeof(bytes));
+      writeBuffer(out,accel,bytes);
+    }
+
+    for (uint32_t geomID=0; geomID<args->numGeometries; geomID++)
+    {
+      const ze_rtas_builder_geometry_info_exp_t* geom = args->ppGeometries[geomID];
+
+      CaptureGeometry record;
+      memset(&record,0,sizeof(record));
+      record.geometryType = geom ? (uint32_t) geom->geometryType : CAPTURE_NULL_GEOMETRY;
+
+      if (geom == nullptr) {
+        out.write((const char*)&record,sizeof(record));
+        continue;
+      }
+
+      switch (geom->geometryType)
+      {
+      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES: {
+        const ze_rtas_builder_triangles_geometry_info_exp_t* mesh = (const ze_rtas_builder_triangles_geometry_info_exp_t*) geom;
+        record.geometryFlags = mesh->geometryFlags;
+        record.geometryMask = mesh->geometryMask;
+        record.primFormat = mesh->triangleFormat;
+        record.vertexFormat = mesh->vertexFormat;
+        record.primCount = mesh->triangleCount;
+        record.primStride = mesh->triangleStride;
+        record.vertexCount = mesh->vertexCount;
+        record.vertexStride = mesh->vertexStride;
+        out.write((const char*)&record,sizeof(record));
+        writeBuffer(out,mesh->pTriangleBuffer,capturedBufferBytes(mesh->triangleCount,mesh->triangleStride,sizeof(ze_rtas_triangle_indices_uint32_exp_t)));
+        writeBuffer(out,mesh->pVertexBuffer,capturedBufferBytes(mesh->vertexCount,mesh->vertexStride,sizeof(ze_rtas_float3_exp_t)));
+        break;
+      }
+      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS: {
+        const ze_rtas_builder_quads_geometry_info_exp_t* mesh = (const ze_rtas_builder_quads_geometry_info_exp_t*) geom;
+        record.geometryFlags = mesh->geometryFlags;
+        record.geometryMask = mesh->geometryMask;
+        record.primFormat = mesh->quadFormat;
+        record.vertexFormat = mesh->vertexFormat;
+        record.primCount = mesh->quadCount;
+        record.primStride = mesh->quadStride;
+        record.vertexCount = mesh->vertexCount;
+        record.vertexStride = mesh->vertexStride;
+        out.write((const char*)&record,sizeof(record));
+        writeBuffer(out,mesh->pQuadBuffer,capturedBufferBytes(mesh->quadCount,mesh->quadStride,sizeof(ze_rtas_quad_indices_uint32_exp_t)));
+        writeBuffer(out,mesh->pVertexBuffer,capturedBufferBytes(mesh->vertexCount,mesh->vertexStride,sizeof(ze_rtas_float3_exp_t)));
+        break;
+      }
+      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: {
+        const ze_rtas_builder_procedural_geometry_info_exp_t* procedural = (const ze_rtas_builder_procedural_geometry_info_exp_t*) geom;
+        record.geometryFlags = procedural->geometryFlags;
+        record.geometryMask = procedural->geometryMask;
+        record.primCount = procedural->primCount;
+        record.primStride = sizeof(ze_rtas_aabb_exp_t);
+        out.write((const char*)&record,sizeof(record));
+
+        /* snapshot the bounds of all primitives with a single callback invocation */
+        std::vector<ze_rtas_aabb_exp_t> bounds(procedural->primCount);
+        if (procedural->primCount)
+        {
+          ze_rtas_geometry_aabbs_exp_cb_params_t params = { ZE_STRUCTURE_TYPE_RTAS_GEOMETRY_AABBS_EXP_CB_PARAMS };
+          params.primID = 0;
+          params.primIDCount = procedural->primCount;
+          params.pGeomUserPtr = procedural->pGeomUserPtr;
+          params.pBuildUserPtr = pBuildUserPtr;
+          params.pBoundsOut = bounds.data();
+          (procedural->pfnGetBoundsCb)(&params);
+        }
+        writeBuffer(out,bounds.data(),bounds.size()*sizeof(ze_rtas_aabb_exp_t));
+        break;
+      }
+      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: {
+        const ze_rtas_builder_instance_geometry_info_exp_t* instance = (const ze_rtas_builder_instance_geometry_info_exp_t*) geom;
+        record.geometryFlags = instance->instanceFlags;
+        record.geometryMask = instance->geometryMask;
+        record.primFormat = instance->transformFormat;
+        record.primCount = 1;
+        record.instanceUserID = instance->instanceUserID;
+        record.accelIndex = accelIndices[instance->pAccelerationStructure];
+        out.write((const char*)&record,sizeof(record));
+        writeBuffer(out,instance->pTransform,capturedTransformBytes(instance->transformFormat));
+        writeBuffer(out,instance->pBounds,sizeof(ze_rtas_aabb_exp_t));
+        break;
+      }
+      default:
+        throw std::runtime_error("invalid geometry type");
+      }
+    }
+  }
+
+  void BuildCapture::write(const char* fileName, const ze_rtas_builder_build_op_exp_desc_t* args, void* pBuildUserPtr)
+  {
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+    if (!out) return; // capturing never lets a build fail
+
+    writeGeometries(out,args,pBuildUserPtr);
+
+    /* do not leave truncated captures behind */
+    out.close();
+    if (!out) std::remove(fileName);
+  }
+}
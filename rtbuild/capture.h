@@ -0,0 +1,98 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "rtbuild.h"
+
+#include <string>
+
+namespace embree
+{
+  /*
+
+    Binary capture of a build, containing the build descriptor and all
+    geometry data it references, such that the build can get replayed
+    without the application. All values are stored in host byte order
+    in the following sequence:
+
+      CaptureHeader
+      numAccels     x { uint64_t bytes, acceleration structure data }
+      numGeometries x { CaptureGeometry, geometry data }
+
+    The geometry data of triangle and quad geometries is the index
+    buffer followed by the vertex buffer, both stored with their
+    original stride. Procedural geometries store the bounds returned
+    by their callback for all primitives, instances store their
+    transformation in the original format followed by their bounds.
+    Each acceleration structure referenced by some instance is stored
+    once, such that instances can get replayed without the bottom
+    level builds.
+
+   */
+
+  struct CaptureHeader
+  {
+    char magic[8];           // "RTASCAP"
+    uint32_t version;        // CAPTURE_VERSION
+    uint32_t rtasFormat;     // ze_rtas_format_exp_t of the build
+    uint32_t buildQuality;   // ze_rtas_builder_build_quality_hint_exp_t of the build
+    uint32_t buildFlags;     // ze_rtas_builder_build_op_exp_flags_t of the build
+    uint32_t numGeometries;  // number of geometry records
+    uint32_t numAccels;      // number of instanced acceleration structures
+  };
+
+  static_assert(sizeof(CaptureHeader) == 32, "CaptureHeader must be 32 bytes large");
+
+  struct CaptureGeometry
+  {
+    uint32_t geometryType;    // ze_rtas_builder_geometry_type_exp_t or CAPTURE_NULL_GEOMETRY
+    uint32_t geometryFlags;   // geometry flags, or instance flags of instances
+    uint32_t geometryMask;    // 8 bit geometry mask
+    uint32_t primFormat;      // index format, or transformation format of instances
+    uint32_t vertexFormat;    // vertex format of triangle and quad geometries
+    uint32_t primCount;       // number of triangles, quads, or procedural primitives
+    uint32_t primStride;      // stride of the index buffer
+    uint32_t vertexCount;     // number of vertices
+    uint32_t vertexStride;    // stride of the vertex buffer
+    uint32_t instanceUserID;  // user ID of instances
+    uint32_t accelIndex;      // captured acceleration structure referenced by instances
+    uint32_t reserved;
+  };
+
+  static_assert(sizeof(CaptureGeometry) == 48, "CaptureGeometry must be 48 bytes large");
+
+  static const char CAPTURE_MAGIC[8] = "RTASCAP";
+  static const uint32_t CAPTURE_VERSION = 1;
+  static const uint32_t CAPTURE_NULL_GEOMETRY = 0xFFFFFFFF;
+
+  /* bytes of a strided buffer of count elements, the stride after the last element is not stored */
+  inline size_t capturedBufferBytes(uint32_t count, uint32_t stride, size_t elementBytes) {
+    return count ? size_t(count-1)*stride + elementBytes : 0;
+  }
+
+  /* bytes of an instance transformation of the specified format, or 0 for invalid formats */
+  inline size_t capturedTransformBytes(uint32_t format)
+  {
+    switch (format) {
+    case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_COLUMN_MAJOR        : return sizeof(ze_rtas_transform_float3x4_column_major_exp_t);
+    case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_ALIGNED_COLUMN_MAJOR: return sizeof(ze_rtas_transform_float3x4_aligned_column_major_exp_t);
+    case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_ROW_MAJOR           : return sizeof(ze_rtas_transform_float3x4_row_major_exp_t);
+    default: return 0;
+    }
+  }
+
+  class BuildCapture
+  {
+  public:
+
+    /* environment variable that enables capturing all builds to files starting with the specified prefix */
+    static const char* ENVIRONMENT_VARIABLE;
+
+    /* returns the file for the next build captured through the environment, or an empty string */
+    static std::string nextEnvironmentFile();
+
+    /* writes the build to the specified file, procedural callbacks get invoked once for all primitives */
+    static void write(const char* fileName, const ze_rtas_builder_build_op_exp_desc_t* args, void* pBuildUserPtr);
+  };
+}
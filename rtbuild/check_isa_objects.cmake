@@ -0,0 +1,22 @@
+## Copyright 2009-2022 Intel Corporation
+## SPDX-License-Identifier: Apache-2.0
+
+# Checks that the ISA specific builder objects define no weak symbols. The
+# linker keeps a single copy of a weak symbol, thus code compiled for one ISA
+# could get called from the baseline builder. The DW.ref symbols only hold the
+# address of the exception personality routine and of exception type infos.
+
+FOREACH (object ${OBJECTS})
+  IF (object MATCHES "rtbuild_builder\\.[a-z0-9]+\\.cpp\\.o(bj)?$")
+    EXECUTE_PROCESS(COMMAND "${NM}" "${object}" OUTPUT_VARIABLE symbols RESULT_VARIABLE result)
+    IF (NOT result EQUAL 0)
+      MESSAGE(FATAL_ERROR "${NM} failed for ${object}")
+    ENDIF()
+    STRING(REGEX MATCHALL "[^\n]* [VWu] [^\n]*" weak "${symbols}")
+    LIST(FILTER weak EXCLUDE REGEX " DW\\.ref\\.")
+    IF (weak)
+      STRING(REPLACE ";" "\n" weak "${weak}")
+      MESSAGE(FATAL_ERROR "${object} defines weak symbols:\n${weak}")
+    ENDIF()
+  ENDIF()
+ENDFOREACH()
@@ -0,0 +1,296 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hash.h"
+#include "capture.h"
+#include "rtbuild_builder.h"
+#include "algorithms/parallel_for.h"
+
+#include <atomic>
+#include <unordered_map>
+#include <cstring>
+
+namespace embree
+{
+  static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+  static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+  static const uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+  static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+  static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+  /* number of buffer elements that get hashed together */
+  static const size_t HASH_BLOCK_SIZE = 1024;
+
+  static __forceinline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64-r));
+  }
+
+  static __forceinline uint64_t read64(const char* p) {
+    uint64_t v; memcpy(&v,p,sizeof(v)); return v;
+  }
+
+  static __forceinline uint32_t read32(const char* p) {
+    uint32_t v; memcpy(&v,p,sizeof(v)); return v;
+  }
+
+  static __forceinline uint64_t round64(uint64_t acc, uint64_t input) {
+    return rotl64(acc + input*PRIME64_2,31)*PRIME64_1;
+  }
+
+  static __forceinline uint64_t mergeRound64(uint64_t acc, uint64_t val) {
+    return (acc ^ round64(0,val))*PRIME64_1 + PRIME64_4;
+  }
+
+  uint64_t hash64(const void* ptr, size_t bytes, uint64_t seed)
+  {
+    const char* p = (const char*) ptr;
+    const char* end = p + bytes;
+    uint64_t h;
+
+    if (bytes >= 32)
+    {
+      uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+      uint64_t v2 = seed + PRIME64_2;
+      uint64_t v3 = seed;
+      uint64_t v4 = seed - PRIME64_1;
+      for (; p+32<=end; p+=32) {
+        v1 = round64(v1,read64(p+ 0));
+        v2 = round64(v2,read64(p+ 8));
+        v3 = round64(v3,read64(p+16));
+        v4 = round64(v4,read64(p+24));
+      }
+      h = rotl64(v1,1) + rotl64(v2,7) + rotl64(v3,12) + rotl64(v4,18);
+      h = mergeRound64(h,v1);
+      h = mergeRound64(h,v2);
+      h = mergeRound64(h,v3);
+      h = mergeRound64(h,v4);
+    }
+    else
+      h = seed + PRIME64_5;
+
+    h += (uint64_t) bytes;
+
+    for (; p+8<=end; p+=8)
+      h = rotl64(h ^ round64(0,read64(p)),27)*PRIME64_1 + PRIME64_4;
+
+    if (p+4<=end) {
+      h = rotl64(h ^ (uint64_t(read32(p))*PRIME64_1),23)*PRIME64_2 + PRIME64_3;
+      p += 4;
+    }
+
+    for (; p<end; p++)
+      h = rotl64(h ^ (uint64_t((unsigned char)*p)*PRIME64_5),11)*PRIME64_1;
+
+    h ^= h >> 33; h *= PRIME64_2;
+    h ^= h >> 29; h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  /* hashes the first elementBytes of each element of a strided buffer, blocks of elements in parallel */
+  static uint64_t hashBuffer(const void* ptr, uint32_t count, uint32_t stride, size_t elementBytes)
+  {
+    if (count == 0) return 0;
+    if (ptr == nullptr) throw std::runtime_error("geometry buffer not specified");
+
+    const char* data = (const char*) ptr;
+    const size_t numBlocks = (count+HASH_BLOCK_SIZE-1)/HASH_BLOCK_SIZE;
+    std::vector<uint64_t> blockHashes(numBlocks);
+
+    parallel_for(numBlocks, [&](size_t block)
+    {
+      const size_t begin = block*HASH_BLOCK_SIZE;
+      const size_t end = std::min(begin+HASH_BLOCK_SIZE,size_t(count));
+
+      /* tightly packed elements get hashed in place, otherwise the used bytes get gathered first */
+      if (stride == elementBytes) {
+        blockHashes[block] = hash64(data+begin*stride,(end-begin)*elementBytes,begin);
+        return;
+      }
+
+      char packed[HASH_BLOCK_SIZE*sizeof(ze_rtas_aabb_exp_t)];
+      assert(elementBytes <= sizeof(ze_rtas_aabb_exp_t));
+      for (size_t i=begin; i<end; i++)
+        memcpy(packed+(i-begin)*elementBytes,data+i*stride,elementBytes);
+      blockHashes[block] = hash64(packed,(end-begin)*elementBytes,begin);
+    });
+
+    return hash64(blockHashes.data(),numBlocks*sizeof(uint64_t),count);
+  }
+
+  /* hash of the descriptor and the referenced data of a geometry */
+  static uint64_t hashGeometry(const ze_rtas_builder_geometry_info_exp_t* geom)
+  {
+    if (geom == nullptr) return 0;
+
+    /* descriptor values followed by hashes of the referenced data */
+    uint64_t values[12] = { geom->geometryType };
+
+    switch (geom->geometryType)
+    {
+    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES: {
+      const ze_rtas_builder_triangles_geometry_info_exp_t* mesh = (const ze_rtas_builder_triangles_geometry_info_exp_t*) geom;
+      values[1] = mesh->geometryFlags;
+      values[2] = mesh->geometryMask;
+      values[3] = mesh->triangleFormat;
+      values[4] = mesh->vertexFormat;
+      values[5] = mesh->triangleCount;
+      values[6] = mesh->vertexCount;
+      values[7] = hashBuffer(mesh->pTriangleBuffer,mesh->triangleCount,mesh->triangleStride,sizeof(ze_rtas_triangle_indices_uint32_exp_t));
+      values[8] = hashBuffer(mesh->pVertexBuffer,mesh->vertexCount,mesh->vertexStride,sizeof(ze_rtas_float3_exp_t));
+      break;
+    }
+    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS: {
+      const ze_rtas_builder_quads_geometry_info_exp_t* mesh = (const ze_rtas_builder_quads_geometry_info_exp_t*) geom;
+      values[1] = mesh->geometryFlags;
+      values[2] = mesh->geometryMask;
+      values[3] = mesh->quadFormat;
+      values[4] = mesh->vertexFormat;
+      values[5] = mesh->quadCount;
+      values[6] = mesh->vertexCount;
+      values[7] = hashBuffer(mesh->pQuadBuffer,mesh->quadCount,mesh->quadStride,sizeof(ze_rtas_quad_indices_uint32_exp_t));
+      values[8] = hashBuffer(mesh->pVertexBuffer,mesh->vertexCount,mesh->vertexStride,sizeof(ze_rtas_float3_exp_t));
+      break;
+    }
+    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: {
+      const ze_rtas_builder_procedural_geometry_info_exp_t* procedural = (const ze_rtas_builder_procedural_geometry_info_exp_t*) geom;
+      values[1] = procedural->geometryFlags;
+      values[2] = procedural->geometryMask;
+      values[5] = procedural->primCount;
+      values[7] = (uint64_t) procedural->pfnGetBoundsCb;
+      values[8] = (uint64_t) procedural->pGeomUserPtr;
+      break;
+    }
+    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: {
+      const ze_rtas_builder_instance_geometry_info_exp_t* instance = (const ze_rtas_builder_instance_geometry_info_exp_t*) geom;
+      values[1] = instance->instanceFlags;
+      values[2] = instance->geometryMask;
+      values[3] = instance->transformFormat;
+      values[5] = instance->instanceUserID;
+      const uint32_t transformBytes = (uint32_t) capturedTransformBytes(instance->transformFormat);
+      values[7] = hashBuffer(instance->pTransform,1,transformBytes,transformBytes);
+      values[8] = hashBuffer(instance->pBounds,1,sizeof(ze_rtas_aabb_exp_t),sizeof(ze_rtas_aabb_exp_t));
+      values[9] = (uint64_t) instance->pAccelerationStructure;
+      break;
+    }
+    default:
+      throw std::runtime_error("invalid geometry type");
+    }
+
+    return hash64(values,sizeof(values));
+  }
+
+  /* hash of the extensions that change the built acceleration structure */
+  static uint64_t hashExtensions(const ze_rtas_builder_build_op_exp_desc_t* args)
+  {
+    uint64_t values[4] = { 0, 0, 0, 0 };
+
+    const ze_rtas_builder_build_op_ray_distribution_exp_desc_t* ray_ext = (const ze_rtas_builder_build_op_ray_distribution_exp_desc_t*)
+      findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_RAY_DISTRIBUTION_EXP_DESC);
+    if (ray_ext)
+    {
+      values[0] = ray_ext->childOrder + 1;
+      values[1] = hashBuffer(ray_ext->pDirections,ray_ext->numDirections,sizeof(ze_rtas_float3_exp_t),sizeof(ze_rtas_float3_exp_t));
+      if (ray_ext->pWeights)
+        values[2] = hashBuffer(ray_ext->pWeights,ray_ext->numDirections,sizeof(float),sizeof(float));
+    }
+
+    /* the dispatch globals pointer gets stored into the header */
+    const ze_rtas_builder_build_op_debug_exp_desc_t* debug_ext = (const ze_rtas_builder_build_op_debug_exp_desc_t*)
+      findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_DEBUG_EXP_DESC);
+    if (debug_ext)
+      values[3] = (uint64_t) debug_ext->dispatchGlobalsPtr;
+
+    return hash64(values,sizeof(values));
+  }
+
+  uint64_t hashBuildInputs(const ze_rtas_builder_build_op_exp_desc_t* args)
+  {
+    /* build settings followed by the hashes of all geometries */
+    std::vector<uint64_t> values(4+args->numGeometries);
+    values[0] = args->rtasFormat;
+    values[1] = args->buildQuality;
+    values[2] = args->buildFlags;
+    values[3] = hashExtensions(args);
+
+    parallel_for(args->numGeometries, [&](uint32_t geomID) {
+      values[4+geomID] = hashGeometry(args->ppGeometries[geomID]);
+    });
+
+    return hash64(values.data(),values.size()*sizeof(uint64_t));
+  }
+
+  /* compares the used bytes of all elements of two strided buffers */
+  static bool equalBuffers(const void* ptr0, uint32_t stride0, const void* ptr1, uint32_t stride1, uint32_t count, size_t elementBytes)
+  {
+    if (ptr0 == ptr1 && stride0 == stride1) return true;
+
+    const char* data0 = (const char*) ptr0;
+    const char* data1 = (const char*) ptr1;
+    const size_t numBlocks = (count+HASH_BLOCK_SIZE-1)/HASH_BLOCK_SIZE;
+    std::atomic<bool> equal(true);
+
+    parallel_for(numBlocks, [&](size_t block)
+    {
+      if (!equal) return;
+      const size_t begin = block*HASH_BLOCK_SIZE;
+      const size_t end = std::min(begin+HASH_BLOCK_SIZE,size_t(count));
+      for (size_t i=begin; i<end; i++) {
+        if (memcmp(data0+i*stride0,data1+i*stride1,elementBytes) != 0) {
+          equal = false;
+          return;
+        }
+      }
+    });
+
+    return equal;
+  }
+
+  std::vector<uint32_t> findDuplicateIndexBuffers(const ze_rtas_builder_build_op_exp_desc_t* args)
+  {
+    const uint32_t numGeometries = args->numGeometries;
+    auto getMesh = [&](uint32_t geomID) -> const ze_rtas_builder_triangles_geometry_info_exp_t* {
+      const ze_rtas_builder_geometry_info_exp_t* geom = args->ppGeometries[geomID];
+      if (geom == nullptr || geom->geometryType != ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES) return nullptr;
+      const ze_rtas_builder_triangles_geometry_info_exp_t* mesh = (const ze_rtas_builder_triangles_geometry_info_exp_t*) geom;
+      return mesh->triangleCount ? mesh : nullptr;
+    };
+
+    /* hash the index buffers of all triangle geometries */
+    std::vector<uint64_t> hashes(numGeometries,0);
+    parallel_for(numGeometries, [&](uint32_t geomID) {
+      if (const ze_rtas_builder_triangles_geometry_info_exp_t* mesh = getMesh(geomID))
+        hashes[geomID] = hashBuffer(mesh->pTriangleBuffer,mesh->triangleCount,mesh->triangleStride,sizeof(ze_rtas_triangle_indices_uint32_exp_t));
+    });
+
+    /* geometries with equal hashes are only duplicates if their index buffers are equal */
+    std::vector<uint32_t> duplicates(numGeometries);
+    std::unordered_multimap<uint64_t,uint32_t> originals;
+    bool found = false;
+
+    for (uint32_t geomID=0; geomID<numGeometries; geomID++)
+    {
+      duplicates[geomID] = geomID;
+      const ze_rtas_builder_triangles_geometry_info_exp_t* mesh = getMesh(geomID);
+      if (mesh == nullptr) continue;
+
+      auto candidates = originals.equal_range(hashes[geomID]);
+      for (auto it = candidates.first; it != candidates.second; it++)
+      {
+        const ze_rtas_builder_triangles_geometry_info_exp_t* original = getMesh(it->second);
+        if (original->triangleCount != mesh->triangleCount) continue;
+        if (!equalBuffers(original->pTriangleBuffer,original->triangleStride,mesh->pTriangleBuffer,mesh->triangleStride,
+                          mesh->triangleCount,sizeof(ze_rtas_triangle_indices_uint32_exp_t))) continue;
+        duplicates[geomID] = it->second;
+        found = true;
+        break;
+      }
+
+      if (duplicates[geomID] == geomID)
+        originals.insert(std::make_pair(hashes[geomID],geomID));
+    }
+
+    if (!found) duplicates.clear();
+    return duplicates;
+  }
+}
@@ -0,0 +1,39 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "rtbuild.h"
+
+#include <vector>
+
+namespace embree
+{
+  /*
+
+    Content hashes of build inputs. Blocks of each buffer get hashed
+    in parallel with a 64 bit hash following XXH64, and the block
+    hashes get combined in order, thus hashes do not depend on the
+    number of threads. Strided buffers hash only the used bytes of
+    each element, such that equal data stored with different strides
+    hashes equally.
+
+    Instances are identified by the address of the referenced
+    acceleration structure, as their leaves store that address.
+    Procedural geometries are identified by their bounds callback and
+    geometry user pointer, as their bounds may depend on the build
+    user pointer that is not known when querying build properties.
+
+   */
+
+  /* XXH64 of a contiguous block of memory */
+  uint64_t hash64(const void* ptr, size_t bytes, uint64_t seed = 0);
+
+  /* hash of all inputs of a build that affect the built acceleration structure, except for the
+   * acceleration structure and scratch buffer sizes */
+  uint64_t hashBuildInputs(const ze_rtas_builder_build_op_exp_desc_t* args);
+
+  /* returns for each geometry the first triangle geometry with an identical index buffer, whose
+   * triangle pairing it can use, or an empty vector when no triangle geometry has a duplicate */
+  std::vector<uint32_t> findDuplicateIndexBuffers(const ze_rtas_builder_build_op_exp_desc_t* args);
+}
@@ -117,6 +117,30 @@ namespace embree
     return dst;
   }
 
+  /* computes the same bounds as xfmBounds with 10 instead of 24 madds,
+   * as madd rounds monotonically only the extreme coordinate per axis
+   * can contribute. This requires all inputs to be smaller than
+   * FLT_LARGE in magnitude, such that no intermediate result overflows
+   * or becomes NaN. Works for Vec3fa as well as for N boxes and
+   * transformations stored in SoA layout in Vec3<vfloat<N>>. */
+  template<typename V>
+  __forceinline const BBox<V> xfmBoundsFinite(const AffineSpaceT<LinearSpace3<V>>& m, const BBox<V>& b)
+  {
+    const V z0 = madd(b.lower.z,m.l.vz,m.p);
+    const V z1 = madd(b.upper.z,m.l.vz,m.p);
+    const V zl = min(z0,z1), zu = max(z0,z1);
+    const V yl = min(madd(b.lower.y,m.l.vy,zl),madd(b.upper.y,m.l.vy,zl));
+    const V yu = max(madd(b.lower.y,m.l.vy,zu),madd(b.upper.y,m.l.vy,zu));
+    const V xl = min(madd(b.lower.x,m.l.vx,yl),madd(b.upper.x,m.l.vx,yl));
+    const V xu = max(madd(b.lower.x,m.l.vx,yu),madd(b.upper.x,m.l.vx,yu));
+    return BBox<V>(xl,xu);
+  }
+
+  /*! tests if all entries of the transformation are finite */
+  __forceinline bool isvalid(const AffineSpaceT<LinearSpace3<Vec3fa> >& m) {
+    return isvalid(m.l.vx) && isvalid(m.l.vy) && isvalid(m.l.vz) && isvalid(m.p);
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
   /// Comparison Operators
   ////////////////////////////////////////////////////////////////////////////////
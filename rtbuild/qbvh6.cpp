@@ -2,21 +2,39 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "qbvh6.h"
+#include "algorithms/parallel_for.h"
 
 namespace embree
 {
+  /* subtrees of internal nodes up to this depth get processed in parallel */
+  static const uint32_t PARALLEL_DEPTH = 4;
+
   template<typename InternalNode>
-  void computeInternalNodeStatistics(BVHStatistics& stats, QBVH6::Node node, const BBox1f time_range, const float node_bounds_area, const float root_bounds_area)
+  void computeInternalNodeStatistics(BVHStatistics& stats, QBVH6::Node node, const BBox1f time_range, const float node_bounds_area, const float root_bounds_area, uint32_t depth)
   {
     InternalNode* inner = node.innerNode<InternalNode>();
 
     size_t size = 0;
     for (uint32_t i = 0; i < InternalNode::NUM_CHILDREN; i++)
+      size += inner->valid(i);
+
+    if (depth < PARALLEL_DEPTH)
     {
-      if (inner->valid(i))
+      BVHStatistics childStats[InternalNode::NUM_CHILDREN];
+      parallel_for(uint32_t(InternalNode::NUM_CHILDREN), [&](uint32_t i) {
+        if (inner->valid(i))
+          computeStatistics(childStats[i], inner->child(i), time_range, area(inner->bounds(i)), root_bounds_area, InternalNode::NUM_CHILDREN, depth+1);
+      });
+      
+      for (uint32_t i = 0; i < InternalNode::NUM_CHILDREN; i++)
+        stats = stats + childStats[i];
+    }
+    else
+    {
+      for (uint32_t i = 0; i < InternalNode::NUM_CHILDREN; i++)
       {
-        size++;
-        computeStatistics(stats, inner->child(i), time_range, area(inner->bounds(i)), root_bounds_area, InternalNode::NUM_CHILDREN);
+        if (inner->valid(i))
+          computeStatistics(stats, inner->child(i), time_range, area(inner->bounds(i)), root_bounds_area, InternalNode::NUM_CHILDREN, depth+1);
       }
     }
 
@@ -28,7 +46,7 @@ namespace embree
     stats.internalNode.numBytes += sizeof(InternalNode);
   }
 
-  void computeStatistics(BVHStatistics& stats, QBVH6::Node node, const BBox1f time_range, const float node_bounds_area, const float root_bounds_area, uint32_t numChildren)
+  void computeStatistics(BVHStatistics& stats, QBVH6::Node node, const BBox1f time_range, const float node_bounds_area, const float root_bounds_area, uint32_t numChildren, uint32_t depth)
   {
     switch (node.type)
     {
@@ -108,7 +126,7 @@ namespace embree
     }
     case NODE_TYPE_INTERNAL:
     {
-      computeInternalNodeStatistics<QBVH6::InternalNode6>(stats, node, time_range, node_bounds_area, root_bounds_area);
+      computeInternalNodeStatistics<QBVH6::InternalNode6>(stats, node, time_range, node_bounds_area, root_bounds_area, depth);
       break;
     }
     default:
@@ -120,10 +138,52 @@ namespace embree
   {
     BVHStatistics stats;
     if (empty()) return stats;
-    embree::computeStatistics(stats,root(),BBox1f(0,1),area(bounds),area(bounds),6);
+    embree::computeStatistics(stats,root(),BBox1f(0,1),area(bounds),area(bounds),6,0);
     return stats;
   }
 
+  static void forEachInstanceLeaf(QBVH6::Node node, const std::function<void(InstanceLeaf*)>& func, uint32_t depth)
+  {
+    switch (node.type)
+    {
+    case NODE_TYPE_INSTANCE:
+    {
+      func(node.leafNodeInstance());
+      break;
+    }
+    case NODE_TYPE_INTERNAL:
+    {
+      QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+      if (depth < PARALLEL_DEPTH)
+      {
+        parallel_for(uint32_t(QBVH6::InternalNode6::NUM_CHILDREN), [&](uint32_t i) {
+          if (inner->valid(i)) forEachInstanceLeaf(inner->child(i),func,depth+1);
+        });
+      }
+      else
+      {
+        for (uint32_t i = 0; i < QBVH6::InternalNode6::NUM_CHILDREN; i++)
+          if (inner->valid(i)) forEachInstanceLeaf(inner->child(i),func,depth+1);
+      }
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  void QBVH6::forEachInstanceLeaf(const std::function<void(const InstanceLeaf*)>& func) const
+  {
+    if (empty()) return;
+    embree::forEachInstanceLeaf(root(),[&](InstanceLeaf* leaf) { func(leaf); },0);
+  }
+
+  void QBVH6::forEachInstanceLeaf(const std::function<void(InstanceLeaf*)>& func)
+  {
+    if (empty()) return;
+    embree::forEachInstanceLeaf(root(),func,0);
+  }
+
   template<typename QInternalNode>
   void QBVH6::printInternalNodeStatistics(std::ostream& cout, QBVH6::Node node, uint32_t depth, uint32_t numChildren)
   {
@@ -7,6 +7,8 @@
 #include "statistics.h"
 #include "rtbuild.h"
 
+#include <functional>
+
 namespace embree
 {
   /*
@@ -126,6 +128,12 @@ namespace embree
     /* calculates BVH statistics */
     BVHStatistics computeStatistics() const;
 
+    /* invokes the function for each instance leaf, subtrees get processed in parallel */
+    void forEachInstanceLeaf(const std::function<void(const InstanceLeaf*)>& func) const;
+
+    /* same as above, but the function may modify the instance leaves */
+    void forEachInstanceLeaf(const std::function<void(InstanceLeaf*)>& func);
+
     /*
        This section implements a simple allocator for BVH data. The
        BVH data is separated into two section, a section where nodes
@@ -182,6 +190,18 @@ namespace embree
       return 64 * (size_t)backPointerDataEnd;
     }
 
+    /* checks that the data sections are ordered and end with the back pointer section behind
+     * the root node, headers written before the builder set the back pointer section have all
+     * sections empty, thus their total number of bytes cannot get determined */
+    bool hasValidTotalBytes() const
+    {
+      return nodeDataStart == roundOffsetTo128(sizeof(QBVH6)) &&
+        nodeDataStart <= nodeDataCur && nodeDataCur <= leafDataStart &&
+        leafDataStart <= leafDataCur && leafDataCur <= proceduralDataStart &&
+        proceduralDataStart <= proceduralDataCur && proceduralDataCur <= backPointerDataStart &&
+        nodeDataStart < backPointerDataStart && backPointerDataStart <= backPointerDataEnd;
+    }
+
     /* returns number of bytes available for node allocations */
     size_t getFreeNodeBytes() const {
       return 64 * (size_t)(leafDataStart - nodeDataCur);
@@ -7,6 +7,7 @@
 #include "statistics.h"
 #include "quadifier.h"
 #include "rtbuild.h"
+#include "trace.h"
 #include <atomic>
 
 #if defined(ZE_RAYTRACING)
@@ -53,6 +54,10 @@ namespace embree
           return cur.load();
         }
 
+        void extend(size_t bytes_in) {
+          end = bytes_in;
+        }
+
         __forceinline void* malloc(size_t bytes, size_t align = 16)
         {
           assert(align <= 128); //ZE_RAYTRACING_ACCELERATION_STRUCTURE_ALIGNMENT_EXT
@@ -61,7 +66,7 @@ namespace embree
           const size_t bytes_align = bytes + extra;
           const size_t cur_old = cur.fetch_add(bytes_align);
           const size_t cur_new = cur_old + bytes_align;
-          if (unlikely(cur_new >= end)) return nullptr;
+          if (unlikely(cur_new > end)) return nullptr;
           return &ptr[cur_old + extra];
         }
 
@@ -71,6 +76,75 @@ namespace embree
         __aligned(64) std::atomic<size_t> cur; // current pointer to allocate next data block from
       };
 
+      /* Back pointers of the 64 byte blocks of BVH data. The array consists of zero initialized
+       * pages that get allocated when the first node of their range of blocks gets stored, thus
+       * its memory follows the BVH data actually allocated and not the size of the buffer. */
+      struct BackPointerArray
+      {
+        static const size_t PAGE_ENTRIES = 16384;
+
+        BackPointerArray() {}
+
+        ~BackPointerArray() {
+          clear();
+        }
+
+        /* prepares the page table for the specified maximal number of back pointers */
+        void init(size_t maxEntries)
+        {
+          clear();
+          numPages = (maxEntries+PAGE_ENTRIES-1)/PAGE_ENTRIES;
+          pages.reset(new std::atomic<uint32_t*>[numPages]);
+          for (size_t i=0; i<numPages; i++)
+            pages[i].store(nullptr);
+        }
+
+        void clear()
+        {
+          for (size_t i=0; i<numPages; i++)
+            delete[] pages[i].load();
+          pages.reset();
+          numPages = 0;
+        }
+
+        bool empty() const {
+          return numPages == 0;
+        }
+
+        __forceinline uint32_t& operator[](size_t id)
+        {
+          assert(id/PAGE_ENTRIES < numPages);
+          std::atomic<uint32_t*>& page = pages[id/PAGE_ENTRIES];
+          uint32_t* data = page.load();
+          if (unlikely(data == nullptr))
+          {
+            uint32_t* newData = new uint32_t[PAGE_ENTRIES]();
+            if (page.compare_exchange_strong(data,newData)) data = newData;
+            else delete[] newData;
+          }
+          return data[id%PAGE_ENTRIES];
+        }
+
+        /* copies the first numEntries back pointers and zero fills up to numEntriesAligned entries */
+        void copy(uint32_t* dst, size_t numEntries, size_t numEntriesAligned) const
+        {
+          parallel_for((numEntriesAligned+PAGE_ENTRIES-1)/PAGE_ENTRIES, [&](size_t i)
+          {
+            const size_t begin = i*PAGE_ENTRIES;
+            const size_t end = min(begin+PAGE_ENTRIES,numEntriesAligned);
+            const size_t num = begin < numEntries ? min(end,numEntries)-begin : 0;
+            const uint32_t* data = i < numPages ? pages[i].load() : nullptr;
+            if (data) memcpy(dst+begin,data,num*sizeof(uint32_t));
+            else      memset(dst+begin,0,num*sizeof(uint32_t));
+            memset(dst+begin+num,0,(end-begin-num)*sizeof(uint32_t));
+          });
+        }
+
+      private:
+        std::unique_ptr<std::atomic<uint32_t*>[]> pages;
+        size_t numPages = 0;
+      };
+
       /* triangle data for leaf creation */
       struct Triangle
       {
@@ -129,6 +203,176 @@ namespace embree
         uint32_t instanceUserID;
       };
 
+      /* transforms boxes by a common local to world transformation, VSIZEX boxes at a time in SoA layout */
+      struct XfmBoundsBatch
+      {
+        static const size_t MAX_SIZE = MAX_PRESPLITS_PER_PRIMITIVE; // enough for all sub-primitives of an opened instance
+        static const size_t N = VSIZEX;
+
+        XfmBoundsBatch (const AffineSpace3fa& xfm)
+          : xfm(xfm), num(0) {}
+
+        __forceinline size_t size() const { return num; }
+
+        __forceinline void add(const BBox3fa& box)
+        {
+          assert(num < MAX_SIZE);
+          boxes[num++] = box;
+        }
+
+        /* writes the world space bounds of all boxes to bounds_o */
+        void transform(BBox3fa* bounds_o)
+        {
+          if (unlikely(!isvalid(xfm))) {
+            for (size_t i=0; i<num; i++)
+              bounds_o[i] = xfmBounds(xfm,boxes[i]);
+            return;
+          }
+
+          /* clear unused lanes of the last block */
+          for (size_t i=num; i<(num+N-1)/N*N; i++)
+            boxes[i] = BBox3fa(Vec3fa(zero));
+
+          const AffineSpace3vf<N> xfmN(Vec3<vfloat<N>>(xfm.l.vx.x,xfm.l.vx.y,xfm.l.vx.z),
+                                       Vec3<vfloat<N>>(xfm.l.vy.x,xfm.l.vy.y,xfm.l.vy.z),
+                                       Vec3<vfloat<N>>(xfm.l.vz.x,xfm.l.vz.y,xfm.l.vz.z),
+                                       Vec3<vfloat<N>>(xfm.p.x,xfm.p.y,xfm.p.z));
+
+          for (size_t j=0; j<num; j+=N)
+          {
+            const BBox<Vec3<vfloat<N>>> box(transpose(&boxes[j].lower),transpose(&boxes[j].upper));
+            store(&bounds_o[j],min(num-j,N),xfmBoundsFinite(xfmN,box));
+
+            /* xfmBoundsFinite requires finite inputs */
+            const vbool<N> valid = validMask(box.lower) & validMask(box.upper);
+            if (likely(all(valid))) continue;
+            for (size_t k=0; k<N && j+k<num; k++) {
+              if (!valid[k])
+                bounds_o[j+k] = xfmBounds(xfm,boxes[j+k]);
+            }
+          }
+        }
+
+      private:
+
+        static __forceinline vbool<N> validMask(const Vec3<vfloat<N>>& v) {
+          return (abs(v.x) < vfloat<N>(FLT_LARGE)) & (abs(v.y) < vfloat<N>(FLT_LARGE)) & (abs(v.z) < vfloat<N>(FLT_LARGE));
+        }
+
+        /* transposes N vectors that are sizeof(BBox3fa) bytes apart into SoA layout */
+        static __forceinline Vec3<vfloat<N>> transpose(const Vec3fa* v)
+        {
+          const BBox3fa* ptr = (const BBox3fa*) v;
+          Vec3<vfloat<N>> r;
+#if defined(__AVX__)
+          embree::transpose(vfloat4::load((float*)&ptr[0]),vfloat4::load((float*)&ptr[1]),vfloat4::load((float*)&ptr[2]),vfloat4::load((float*)&ptr[3]),
+                            vfloat4::load((float*)&ptr[4]),vfloat4::load((float*)&ptr[5]),vfloat4::load((float*)&ptr[6]),vfloat4::load((float*)&ptr[7]),
+                            r.x,r.y,r.z);
+#else
+          embree::transpose(vfloat4::load((float*)&ptr[0]),vfloat4::load((float*)&ptr[1]),vfloat4::load((float*)&ptr[2]),vfloat4::load((float*)&ptr[3]),
+                            r.x,r.y,r.z);
+#endif
+          return r;
+        }
+
+        /* stores the first num boxes of SoA bounds */
+        static __forceinline void store(BBox3fa* bounds_o, size_t num, const BBox<Vec3<vfloat<N>>>& bounds)
+        {
+#if defined(__AVX__)
+          vfloat8 c[8];
+          embree::transpose(bounds.lower.x,bounds.lower.y,bounds.lower.z,vfloat8(zero),bounds.upper.x,bounds.upper.y,bounds.upper.z,vfloat8(zero),
+                            c[0],c[1],c[2],c[3],c[4],c[5],c[6],c[7]);
+          for (size_t k=0; k<num; k++)
+            vfloat8::storeu(&bounds_o[k],c[k]);
+#else
+          vfloat4 l[4], u[4];
+          embree::transpose(bounds.lower.x,bounds.lower.y,bounds.lower.z,vfloat4(zero),l[0],l[1],l[2],l[3]);
+          embree::transpose(bounds.upper.x,bounds.upper.y,bounds.upper.z,vfloat4(zero),u[0],u[1],u[2],u[3]);
+          for (size_t k=0; k<num; k++)
+            bounds_o[k] = BBox3fa(Vec3fa(l[k]),Vec3fa(u[k]));
+#endif
+        }
+
+        const AffineSpace3fa xfm;
+        BBox3fa boxes[MAX_SIZE];
+        size_t num;
+      };
+
+      /* uniform grid over the primitive centers, its cells are numbered along a Morton curve,
+       * such that consecutive cells form spatially compact chunks of a streaming build */
+      struct StreamingGrid
+      {
+        StreamingGrid () {}
+
+        /* the cells are cubes, such that thin dimensions do not split flat scenes into overlapping chunks */
+        StreamingGrid (const BBox3fa& centBounds, uint32_t bits)
+          : base(centBounds.lower), bits(bits)
+        {
+          const float diag = reduce_max(centBounds.size());
+          const float s = diag > 0.0f ? 0.99f*float(1u << bits)/diag : 0.0f;
+          scale = Vec3fa(std::isfinite(s) ? s : 0.0f);
+        }
+
+        /* returns the number of cells */
+        __forceinline size_t size() const {
+          return size_t(1) << (3*bits);
+        }
+
+        /* returns the cell of a primitive */
+        __forceinline uint32_t cell(const PrimRef& prim) const
+        {
+          const Vec3fa p = (prim.center2()-base)*scale;
+          const int maxCoord = (1 << bits)-1;
+          const uint32_t x = (uint32_t) clamp(int(p.x),0,maxCoord);
+          const uint32_t y = (uint32_t) clamp(int(p.y),0,maxCoord);
+          const uint32_t z = (uint32_t) clamp(int(p.z),0,maxCoord);
+          return bitInterleave(x,y,z);
+        }
+
+      private:
+        Vec3fa base;
+        Vec3fa scale;
+        uint32_t bits;
+      };
+
+      /* hierarchy of streaming grids that assigns primitives to chunks, cells holding more
+       * primitives than a chunk get refined by a grid over the centers of their primitives,
+       * the remaining cells get assigned to chunks in depth first Morton order */
+      struct StreamingChunks
+      {
+        static const uint32_t TOP_BITS = 6;          //!< bits per dimension of the top level grid
+        static const uint32_t SUB_BITS = 4;          //!< bits per dimension of the grids of refined cells
+        static const uint32_t MAX_LEVELS = 8;        //!< maximal number of refinements of a top level cell
+        static const uint32_t REFINED = 0x80000000;  //!< marks refined cells, the lower bits store their grid
+
+        /* returns the index of the cell of a primitive, descends until a leaf cell or a cell refined by grid stop or later */
+        __forceinline size_t cell(const PrimRef& prim, size_t stop) const
+        {
+          for (size_t g=0;;)
+          {
+            const size_t c = first[g] + grids[g].cell(prim);
+            if (!(cells[c] & REFINED)) return c;
+            g = cells[c] & ~REFINED;
+            if (g >= stop) return c;
+          }
+        }
+
+        /* returns the chunk of a primitive */
+        __forceinline uint32_t chunk(const PrimRef& prim) const {
+          return cells[cell(prim,grids.size())];
+        }
+
+        size_t size() const {
+          return chunkSizes.size();
+        }
+
+      public:
+        std::vector<StreamingGrid> grids;  //!< top level grid followed by the grids of refined cells
+        std::vector<size_t> first;         //!< index of the first cell of each grid
+        std::vector<uint32_t> cells;       //!< chunk of each cell, or REFINED and the grid of a refined cell
+        std::vector<size_t> chunkSizes;    //!< number of primitives of each chunk
+      };
+
       struct Stats
       {
         size_t numTriangles = 0;
@@ -143,12 +387,26 @@ namespace embree
           numTriangles = 0;
         }
         
+        /* use number of quads produced by an actual triangle pairing pass */
+        void set_quadification( size_t numTriangleQuads )
+        {
+          numQuads += numTriangleQuads;
+          numTriangles = 0;
+        }
+        
         void estimate_presplits( double factor )
         {
           numTriangles = max(numTriangles, size_t(numTriangles*factor));
           numQuads     = max(numQuads    , size_t(numQuads*factor));
           numInstances = max(numInstances, size_t(numInstances*factor));
         }
+
+        /* presplits can only fill up the primref array, assume largest leaf type for all split primitives */
+        void add_presplits( size_t numSplitPrimitives )
+        {
+          if (numInstances) numInstances += numSplitPrimitives;
+          else              numQuads     += numSplitPrimitives;
+        }
         
         size_t size() {
           return numTriangles+numQuads+numProcedurals+numInstances;
@@ -158,24 +416,114 @@ namespace embree
         {
           const size_t blocks = (size()+5)/6;
           const size_t expected_bytes   = 128 + 64*size_t(1+1.5*blocks) + numTriangles*64 + numQuads*64 + numProcedurals*8 + numInstances*128;
-          const size_t bytes = 2*4096 + size_t(1.1*expected_bytes); // FIXME: FastAllocator wastes memory and always allocates 4kB per thread
+          const size_t bytes = size_t(1.1*expected_bytes);
           return (bytes+127)&-128;
         }
-        
+
+        /* The BVH allocator is linear and only allocates multiples of 64 bytes. Each primitive
+         * requires at most one 64 byte quad or procedural leaf or one 128 byte instance leaf.
+         * The node term assumes one node per primitive plus one per block of 6 primitives,
+         * which holds for the SAH splits filling nodes to 6 children, but is no strict bound
+         * as nodes with few single primitive children can require up to 2N nodes. Thus we
+         * keep a safety margin on top. A build exceeding the estimate does not corrupt memory,
+         * the allocator fails and the build returns ZE_RESULT_EXP_RTAS_BUILD_RETRY. */
         size_t worst_case_bvh_bytes()
         {
           const size_t numPrimitives = size();
           const size_t blocks = (numPrimitives+5)/6;
           const size_t worst_case_bytes = 128 + 64*(1+blocks + numPrimitives) + numTriangles*64 + numQuads*64 + numProcedurals*64 + numInstances*128;
-          const size_t bytes = 2*4096 + size_t(1.1*worst_case_bytes); // FIXME: FastAllocator wastes memory and always allocates 4kB per thread
+          const size_t bytes = 2*4096 + size_t(1.1*worst_case_bytes);
           return (bytes+127)&-128;
         }
         
         size_t scratch_space_bytes() {
           return size()*sizeof(PrimRef)+64;  // 64 to align to 64 bytes
         }
+
+        /* one 4 byte back pointer for each 64 byte block of BVH data */
+        static size_t back_pointer_bytes( size_t bvh_bytes ) {
+          const size_t bytes = (bvh_bytes/64)*sizeof(uint32_t);
+          return (bytes+127)&-128;
+        }
       };
       
+      /* ray distribution used to order the children of internal nodes, the
+       * weighted direction sums get accumulated when directions are added, thus
+       * the priority of a child is independent of the number of directions */
+      struct RayDistribution
+      {
+        enum Order { HIT_PROBABILITY = 0, DISTANCE = 1 };
+        
+        RayDistribution (Order order)
+          : order(order) {}
+
+        void add(const Vec3fa& dir, float weight)
+        {
+          const float len = length(dir);
+          if (!(len > 0.0f) || !(weight > 0.0f)) return; // also skips NaNs
+          const Vec3fa d = dir/len;
+          numDirections++;
+
+          /* weighted sum of absolute directions for the projected area */
+          absSum += weight*abs(d);
+
+          /* weighted direction sums split by sign, as the sign selects the box plane that gets entered first */
+          posSum += weight*max(d,Vec3fa(0.0f));
+          negSum += weight*min(d,Vec3fa(0.0f));
+        }
+
+        bool empty() const {
+          return numDirections == 0;
+        }
+
+        /* children with higher priority get stored first */
+        float priority(const BBox3fa& bounds) const
+        {
+          /* weighted area of the box projected along the ray directions */
+          if (order == HIT_PROBABILITY) {
+            const Vec3fa size = bounds.size();
+            return absSum.x*size.y*size.z + absSum.y*size.x*size.z + absSum.z*size.x*size.y;
+          }
+
+          /* negated weighted distance to the box plane that gets entered first */
+          else
+            return -reduce_add(Vec3fa(posSum*bounds.lower + negSum*bounds.upper));
+        }
+
+      public:
+        Order order;
+        size_t numDirections = 0;
+        Vec3fa absSum = Vec3fa(0.0f);
+        Vec3fa posSum = Vec3fa(0.0f);
+        Vec3fa negSum = Vec3fa(0.0f);
+      };
+
+      /* timings and counters of a build, only gathered when requested */
+      struct BuildStatistics
+      {
+      public:
+        double setupSeconds = 0.0;         //!< counting of primitives and estimation of the worst case size
+        double quadifySeconds = 0.0;       //!< pairing of triangles to quads
+        double primRefSeconds = 0.0;       //!< creation of the primref array
+        double filterSeconds = 0.0;        //!< second primref pass, only required when invalid primitives got filtered out
+        double presplitSeconds = 0.0;      //!< pre-splitting of large primitives
+        double hierarchySeconds = 0.0;     //!< SAH build of the hierarchy including leaf creation
+        double finalizeSeconds = 0.0;      //!< back pointers, header and statistics
+        double totalSeconds = 0.0;         //!< entire build
+        size_t numInputPrimitives = 0;     //!< number of primitives of all geometries
+        size_t numInputTriangles = 0;      //!< number of triangles of all geometries
+        size_t numTrianglePairs = 0;       //!< number of quads created by pairing two triangles
+        size_t numPrimitives = 0;          //!< number of primitives after triangle pairing
+        size_t numValidPrimitives = 0;     //!< number of primitives after filtering invalid ones
+        size_t numBuildPrimitives = 0;     //!< number of primitives after pre-splitting
+        size_t numInternalNodes = 0;       //!< number of internal nodes
+        size_t numQuadLeaves = 0;          //!< number of quad leaves
+        size_t numProceduralLeaves = 0;    //!< number of procedural leaves
+        size_t numInstanceLeaves = 0;      //!< number of instance leaves
+        size_t accelBytesUsed = 0;         //!< bytes requested from the BVH allocator
+        size_t accelBytesProvided = 0;     //!< size of the acceleration structure buffer
+      };
+
       /*! settings for SAH builder */
       struct Settings
       {
@@ -297,6 +645,94 @@ namespace embree
         ProceduralLeaf*      currProcedural;
       };
       
+      /* Sets the bounds of the first numChildren children of a node and
+       * invalidates all others. All boxes get quantized together on the
+       * shared grid, producing the same result as calling setChildBounds
+       * for each child. Lives in the builder to use the SIMD width of its ISA. */
+      static __forceinline void setChildrenBounds(QBVH6::InternalNode6* qnode, const BBox3f* fbounds, uint32_t numChildren)
+      {
+#if defined(__AVX__)
+        typedef vfloat8 vfloatq; typedef vint8 vintq; typedef vboolf8 vboolq;
+#else
+        typedef vfloat4 vfloatq; typedef vint4 vintq; typedef vboolf4 vboolq;
+#endif
+        static constexpr uint32_t NUM_CHILDREN = QBVH6::InternalNode6::NUM_CHILDREN;
+        static constexpr uint32_t K = vfloatq::size;
+        static constexpr uint32_t N = (NUM_CHILDREN+K-1)/K*K;
+        assert(numChildren <= NUM_CHILDREN);
+
+        /* transpose boxes into the layout of the lower_x ... upper_z arrays */
+        __aligned(32) float soa[6][N];
+        for (uint32_t i=0; i<N; i++)
+        {
+          const BBox3f b = i < numChildren ? fbounds[i] : BBox3f(Vec3f(0.0f));
+          assert(b.lower.x <= b.upper.x);
+          assert(b.lower.y <= b.upper.y);
+          assert(b.lower.z <= b.upper.z);
+          soa[0][i] = b.lower.x; soa[1][i] = b.upper.x;
+          soa[2][i] = b.lower.y; soa[3][i] = b.upper.y;
+          soa[4][i] = b.lower.z; soa[5][i] = b.upper.z;
+        }
+
+        /* grid scale 2^(8-exp) split into two factors, as 2^(8-exp) can exceed the float range */
+        float scale0[3], scale1[3];
+        const int exp[3] = { qnode->exp_x, qnode->exp_y, qnode->exp_z };
+        for (uint32_t d=0; d<3; d++) {
+          const int e0 = min(8-exp[d],127);
+          scale0[d] = ldexpf(1.0f,e0);
+          scale1[d] = ldexpf(1.0f,8-exp[d]-e0);
+        }
+        const Vec3f base = qnode->lower;
+
+        vintq qbounds[6][N/K];
+        for (uint32_t i=0; i<N; i+=K)
+        {
+          vfloatq lower[3], upper[3];
+          for (uint32_t d=0; d<3; d++) {
+            lower[d] = vfloatq::load(&soa[2*d+0][i]);
+            upper[d] = vfloatq::load(&soa[2*d+1][i]);
+          }
+
+          /* same enlargement as conservativeBox */
+          const vfloatq maxabs = max(max(abs(lower[0]),abs(lower[1]),abs(lower[2])),
+                                     max(abs(upper[0]),abs(upper[1]),abs(upper[2])));
+          const vfloatq err = vfloatq(std::numeric_limits<float>::epsilon()) * maxabs;
+          const vboolq active = vintq(step) + vintq(i) < vintq(numChildren);
+
+          for (uint32_t d=0; d<3; d++)
+          {
+            const vfloatq qlower = ((lower[d]-err)-vfloatq(base[d])) * vfloatq(scale0[d]) * vfloatq(scale1[d]);
+            const vfloatq qupper = ((upper[d]+err)-vfloatq(base[d])) * vfloatq(scale0[d]) * vfloatq(scale1[d]);
+            assert(all(active, (qlower >= 0.0f) & (qlower <= 255.0f)));
+            assert(all(active, (qupper >= 0.0f) & (qupper <= 255.0f)));
+            const vfloatq ilower = min(max(floor(qlower),vfloatq(0.0f)),vfloatq(255.0f));
+            const vfloatq iupper = min(max(ceil (qupper),vfloatq(0.0f)),vfloatq(255.0f));
+            qbounds[2*d+0][i/K] = toInt(select(active, ilower, vfloatq(128.0f)));
+            qbounds[2*d+1][i/K] = toInt(select(active, iupper, vfloatq(0.0f)));
+          }
+        }
+
+        /* the byte stores of a block may overrun into the next array, thus they are done in address order */
+        uint8_t qbytes[6*NUM_CHILDREN+K];
+        for (uint32_t j=0; j<6; j++)
+          for (uint32_t i=0; i<N; i+=K)
+            vintq::store(&qbytes[j*NUM_CHILDREN+i], qbounds[j][i/K]);
+
+        assert(qnode->upper_z == qnode->lower_x + 5*NUM_CHILDREN);
+        memcpy(qnode->lower_x, qbytes, 6*NUM_CHILDREN);
+
+#if !defined(NDEBUG)
+        /* verify against the scalar quantization, which checks that the bounds are conservative */
+        for (uint32_t i=0; i<numChildren; i++) {
+          const BBox3f qbounds = qnode->quantize_bounds(qnode->conservativeBox(fbounds[i]), qnode->lower);
+          assert(qnode->lower_x[i] == (uint8_t)qbounds.lower.x && qnode->upper_x[i] == (uint8_t)qbounds.upper.x);
+          assert(qnode->lower_y[i] == (uint8_t)qbounds.lower.y && qnode->upper_y[i] == (uint8_t)qbounds.upper.y);
+          assert(qnode->lower_z[i] == (uint8_t)qbounds.lower.z && qnode->upper_z[i] == (uint8_t)qbounds.upper.z);
+          assert(qnode->valid(i));
+        }
+#endif
+      }
+
       template<typename getSizeFunc,
                typename getTypeFunc,
                typename createPrimRefArrayFunc,
@@ -309,6 +745,7 @@ namespace embree
       {
       public:
         static const size_t BINS = 32;
+        static const size_t SINGLE_THREAD_THRESHOLD = 1024; //!< subtrees up to this number of primitives get build by a single thread
         typedef HeuristicArrayBinningSAH<PrimRef,BINS> CentroidBinner;
         
         BuilderT (Device* device,
@@ -324,7 +761,11 @@ namespace embree
                   ze_rtas_format_exp_t rtas_format,
                   ze_rtas_builder_build_quality_hint_exp_t build_quality,
                   ze_rtas_builder_build_op_exp_flags_t build_flags,
-                  bool verbose)
+                  const RayDistribution* rayDistribution,
+                  const uint32_t* pairingGeomIDs,
+                  bool verbose,
+                  BuildStatistics* statistics,
+                  BuildTracer* tracer)
           : getSize(getSize),
             getType(getType),
             createPrimRefArray(createPrimRefArray),
@@ -337,7 +778,38 @@ namespace embree
             rtas_format((ze_raytracing_accel_format_internal_t)rtas_format),
             build_quality(build_quality),
             build_flags(build_flags),
-            verbose(verbose) {} 
+            rayDistribution(rayDistribution),
+            pairingGeomIDs(pairingGeomIDs),
+            verbose(verbose),
+            statistics(statistics),
+            tracer(tracer),
+            timing(verbose || statistics || tracer) {}
+        
+        /* writes one byte of each page of the primref array with the tasks of the primref generation,
+         * each task touches the pages starting inside the primrefs it will write, such that the OS
+         * places not yet touched pages on the NUMA node of a thread of the arena working on them */
+        void firstTouchPrims(const ParallelForForPrefixSumState<PrimInfo>& pstate)
+        {
+          char* ptr = (char*) prims.data();
+          parallel_for(pstate.taskCount, [&](const size_t taskIndex) {
+            const size_t begin = pstate.prefix_state.sums[taskIndex].size()*sizeof(PrimRef);
+            const size_t end = begin + pstate.prefix_state.counts[taskIndex].size()*sizeof(PrimRef);
+            for (size_t page = (begin+PAGE_SIZE_4K-1)/PAGE_SIZE_4K; page*PAGE_SIZE_4K < end; page++)
+              ptr[page*PAGE_SIZE_4K] = 0;
+          });
+        }
+
+        /* returns index of the back pointer of the node at the specified address */
+        uint32_t getBackPointerID(const char* addr) const {
+          return uint32_t((addr - accel)/64) - uint32_t(roundOffsetTo128(sizeof(QBVH6)));
+        }
+
+        /* stores number of children into the back pointer of a node */
+        void setBackPointerNumChildren(const char* curAddr, size_t numChildren)
+        {
+          if (backPointers.empty()) return;
+          backPointers[getBackPointerID(curAddr)] |= uint32_t(numChildren) << 3;
+        }
         
         ReductionTy setInternalNode(char* curAddr, size_t curBytes, NodeType nodeTy, char* childAddr,
                                     BuildRecord children[BVH_WIDTH], ReductionTy values[BVH_WIDTH], size_t numChildren)
@@ -353,12 +825,26 @@ namespace embree
           qnode->setChildOffset(childAddr);
           
           uint8_t nodeMask = 0;
+          BBox3f childBounds[BVH_WIDTH];
           for (uint32_t i = 0; i < numChildren; i++)
           {
-            qnode->setChild(i,children[i].bounds(),values[i].type,values[i].primRange.block_delta);
+            qnode->setChildType(i,values[i].type,values[i].primRange.block_delta,0);
+            childBounds[i] = children[i].bounds();
             nodeMask |= values[i].nodeMask;
           }
+          setChildrenBounds(qnode,childBounds,numChildren);
           qnode->nodeMask = nodeMask;
+
+          /* children are already finished, thus we can link them to this node */
+          if (!backPointers.empty())
+          {
+            setBackPointerNumChildren(curAddr,numChildren);
+            
+            const uint32_t curID = getBackPointerID(curAddr);
+            for (size_t i=0; i<numChildren; i++)
+              if (values[i].type == NODE_TYPE_INTERNAL)
+                backPointers[getBackPointerID(values[i].node)] |= curID << 6;
+          }
           
           return ReductionTy(curAddr, NODE_TYPE_INTERNAL, nodeMask, PrimRange(curBytes/64));
         }
@@ -445,30 +931,37 @@ namespace embree
           return setNode(curAddr,curBytes,NODE_TYPE_QUAD,childData,children,values,numChildren);
         }
 
-        const ReductionTy createProcedurals(const BuildRecord& curRecord, char* curAddr, size_t curBytes)
+        const ReductionTy createProcedurals(const BuildRecord& curRecord, char* curAddr, size_t curBytes, ProceduralLeafBuilder* packed_leaf_builder)
         {
           const uint32_t numPrims MAYBE_UNUSED = curRecord.size();
           assert(numPrims <= QBVH6::InternalNode6::NUM_CHILDREN);
           
           PrimRange ranges[QBVH6::InternalNode6::NUM_CHILDREN+1];
           QBVH6::InternalNode6* qnode = new (curAddr) QBVH6::InternalNode6(curRecord.bounds(),NODE_TYPE_PROCEDURAL);
-          
-          /* allocate data for all procedural leaves */
-          size_t numGeometries = 1;
-          auto prim0 = prims[curRecord.begin()];
-          auto desc0 = getProcedural(prim0.geomID(),prim0.primID()).desc(prim0.geomID());
-          for (size_t i=curRecord.begin()+1; i<curRecord.end(); i++) {
-            auto desc1 = getProcedural(prims[i].geomID(),prims[i].primID()).desc(prims[i].geomID());
-            numGeometries += desc0 != desc1;
-            desc0 = desc1;
-          }
 
-          char* childData = (char*) allocator.malloc(numGeometries*sizeof(ProceduralLeaf), 64);
+          ProceduralLeafBuilder local_leaf_builder(nullptr,0);
+          
+          /* allocate data for all procedural leaves, unless we continue filling the procedural leaves of the subtree */
+          if (!packed_leaf_builder)
+          {
+            size_t numGeometries = 1;
+            auto prim0 = prims[curRecord.begin()];
+            auto desc0 = getProcedural(prim0.geomID(),prim0.primID()).desc(prim0.geomID());
+            for (size_t i=curRecord.begin()+1; i<curRecord.end(); i++) {
+              auto desc1 = getProcedural(prims[i].geomID(),prims[i].primID()).desc(prims[i].geomID());
+              numGeometries += desc0 != desc1;
+              desc0 = desc1;
+            }
+            
+            char* childData = (char*) allocator.malloc(numGeometries*sizeof(ProceduralLeaf), 64);
+            
+            if (!childData)
+              return ReductionTy();
 
-          if (!childData)
-            return ReductionTy();
+            local_leaf_builder = ProceduralLeafBuilder(childData, numGeometries);
+          }
 
-          ProceduralLeafBuilder procedural_leaf_builder(childData, numGeometries);
+          ProceduralLeafBuilder& procedural_leaf_builder = packed_leaf_builder ? *packed_leaf_builder : local_leaf_builder;
           ProceduralLeaf* first_procedural = procedural_leaf_builder.getCurProcedural();
           
           uint8_t nodeMask = 0;
@@ -486,8 +979,14 @@ namespace embree
           qnode->nodeMask = nodeMask;
           ranges[0].block_delta = 0;
           
-          for (size_t i = curRecord.begin(), j=0; i < curRecord.end(); i++, j++)
-            qnode->setChild(j,prims[i].bounds(),NODE_TYPE_PROCEDURAL,ranges[j+1].block_delta,ranges[j].cur_prim);
+          BBox3f childBounds[BVH_WIDTH];
+          for (size_t i = curRecord.begin(), j=0; i < curRecord.end(); i++, j++) {
+            qnode->setChildType(j,NODE_TYPE_PROCEDURAL,ranges[j+1].block_delta,ranges[j].cur_prim);
+            childBounds[j] = prims[i].bounds();
+          }
+          setChildrenBounds(qnode,childBounds,numPrims);
+
+          setBackPointerNumChildren(curAddr,numPrims);
           
           return ReductionTy(curAddr, NODE_TYPE_INTERNAL, nodeMask, PrimRange(curBytes/64));
         }
@@ -508,6 +1007,7 @@ namespace embree
           qnode->setChildOffset(childData);
           
           uint8_t nodeMask = 0;
+          BBox3f childBounds[BVH_WIDTH];
           for (size_t i=curRecord.begin(), c=0; i<curRecord.end(); i++, c++)
           {
             const uint32_t geomID = prims[i].geomID();
@@ -518,17 +1018,69 @@ namespace embree
             root += 64*rootOfs; // goto sub-BVH
             new (&childData[c]) InstanceLeaf(instance.local2world,root,geomID,instance.instanceUserID,instance.imask);
             
-            qnode->setChild(c,prims[i].bounds(),NODE_TYPE_INSTANCE,sizeof(InstanceLeaf)/64,0);
+            qnode->setChildType(c,NODE_TYPE_INSTANCE,sizeof(InstanceLeaf)/64,0);
+            childBounds[c] = prims[i].bounds();
             nodeMask |= instance.imask;
           }
+          setChildrenBounds(qnode,childBounds,numPrimitives);
           qnode->nodeMask = nodeMask;
+          setBackPointerNumChildren(curAddr,numPrimitives);
           
           return ReductionTy(curAddr, NODE_TYPE_INTERNAL, nodeMask, PrimRange(curBytes/64));
         }
         
+        /* stable insertion sort for the at most BVH_WIDTH children of a node */
+        template<typename T, typename Compare>
+        static void insertionSort(T* items, size_t numItems, const Compare& less)
+        {
+          for (size_t i=1; i<numItems; i++)
+          {
+            const T item = items[i];
+            size_t j = i;
+            for (; j>0 && less(item,items[j-1]); j--)
+              items[j] = items[j-1];
+            items[j] = item;
+          }
+        }
+        
+        /* sorts children by the provided ray distribution or by the default order */
+        template<typename Compare>
+        void sortChildren(BuildRecord children[BVH_WIDTH], size_t numChildren, const Compare& defaultOrder) const
+        {
+          assert(numChildren <= BVH_WIDTH);
+          if (!rayDistribution || rayDistribution->empty()) {
+            insertionSort(children,numChildren,defaultOrder);
+            return;
+          }
+
+          std::pair<float,size_t> order[BVH_WIDTH];
+          for (size_t i=0; i<numChildren; i++)
+            order[i] = std::make_pair(rayDistribution->priority(children[i].bounds()),i);
+
+          insertionSort(order,numChildren,[](const std::pair<float,size_t>& a, const std::pair<float,size_t>& b) {
+                                            return a.first > b.first;
+                                          });
+
+          BuildRecord sorted[BVH_WIDTH];
+          for (size_t i=0; i<numChildren; i++)
+            sorted[i] = children[order[i].second];
+          for (size_t i=0; i<numChildren; i++)
+            children[i] = sorted[i];
+        }
+        
+        /* returns the half surface area of a box after quantization to the grid of a node with the provided bounds */
+        static float quantizedHalfArea(const QBVH6::InternalNode6& grid, const BBox3fa& box)
+        {
+          if (box.empty()) return 0.0f;
+          return halfArea(grid.quantized_bounds(box));
+        }
+        
         /* finds the index of the child with largest surface area */
-        int findChildWithLargestArea(BuildRecord children[BVH_WIDTH], size_t numChildren, size_t leafThreshold)
+        int findChildWithLargestArea(const BBox3fa& nodeBounds, BuildRecord children[BVH_WIDTH], size_t numChildren, size_t leafThreshold)
         {
+          const bool quantizedSAH = build_flags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_QUANTIZED_SAH;
+          const QBVH6::InternalNode6 grid(nodeBounds);
+          
           /*! find best child to split */
           float bestArea = neg_inf;
           int bestChild = -1;
@@ -538,7 +1090,8 @@ namespace embree
             if (children[i].prims.size() <= leafThreshold) continue;
             
             /* find child with largest surface area */
-            const float area = halfArea(children[i].prims.geomBounds);
+            const BBox3fa& bounds = children[i].prims.geomBounds;
+            const float area = quantizedSAH ? quantizedHalfArea(grid,bounds) : halfArea(bounds);
             if (area > bestArea)
             {
               bestArea = area;
@@ -579,14 +1132,25 @@ namespace embree
           return -1;
         }
         
-        void SAHSplit(size_t depth, size_t sahBlockSize, int bestChild, BuildRecord children[BVH_WIDTH], size_t& numChildren)
+        void SAHSplit(const BBox3fa& nodeBounds, size_t depth, size_t sahBlockSize, int bestChild, BuildRecord children[BVH_WIDTH], size_t& numChildren)
         {
           PrimInfoRange linfo, rinfo;
           BuildRecord brecord = children[bestChild];
           
           /* first perform centroid binning */
           CentroidBinner centroid_binner(prims.data());
-          CentroidBinner::Split bestSplit = centroid_binner.find_block_size(brecord.prims,sahBlockSize);
+          CentroidBinner::Split bestSplit;
+
+          /* optionally evaluate the SAH on the child bounds as quantized to the grid of the node */
+          if (build_flags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_QUANTIZED_SAH)
+          {
+            const QBVH6::InternalNode6 grid(nodeBounds);
+            bestSplit = centroid_binner.find_block_size(brecord.prims,sahBlockSize,[&] (const BBox3fa& box) {
+                                                          return quantizedHalfArea(grid,box);
+                                                        });
+          }
+          else
+            bestSplit = centroid_binner.find_block_size(brecord.prims,sahBlockSize);
           
           /* now split the primitive list */
           if (bestSplit.valid())
@@ -636,7 +1200,7 @@ namespace embree
         }
         
         /* creates a fat leaf, which is an internal node that only points to real leaves */
-        const ReductionTy createFatLeaf(const BuildRecord& curRecord, char* curAddr, size_t curBytes)
+        const ReductionTy createFatLeaf(const BuildRecord& curRecord, char* curAddr, size_t curBytes, ProceduralLeafBuilder* packed_leaf_builder)
         {
           /* this should never occur but is a fatal error */
           if (curRecord.depth > cfg.maxDepth)
@@ -676,7 +1240,7 @@ namespace embree
             {
               const int bestChild = findChildWithMostPrimitives(children,numChildren,1);
               if (bestChild == -1) break;
-              SAHSplit(curRecord.depth,1,bestChild,children,numChildren);
+              SAHSplit(curRecord.bounds(),curRecord.depth,1,bestChild,children,numChildren);
             }
             
             /* fallback in case largest leaf if still too large */
@@ -697,15 +1261,26 @@ namespace embree
           }
           
           /* sort build records for faster shadow ray traversal */
-          std::sort(children,children+numChildren, [](const BuildRecord& a,const BuildRecord& b) {
-                                                     return area(a.prims.geomBounds) > area(b.prims.geomBounds);
-                                                   });
-          
+          sortChildren(children,numChildren, [](const BuildRecord& a,const BuildRecord& b) {
+                                               return area(a.prims.geomBounds) > area(b.prims.geomBounds);
+                                             });
+
+          /* procedural and instance leaves store their primitives in primref order, thus the
+           * single primitive children get reordered to follow the ray distribution */
+          if ((ty == PROCEDURAL || ty == INSTANCE) && rayDistribution && !rayDistribution->empty() && numChildren == curRecord.size())
+          {
+            PrimRef sorted[BVH_WIDTH];
+            for (size_t i=0; i<numChildren; i++)
+              sorted[i] = prims[children[i].begin()];
+            for (size_t i=0; i<numChildren; i++)
+              prims[curRecord.begin()+i] = sorted[i];
+          }
+
           /* create leaf of proper type */
           if (ty == TRIANGLE || ty == QUAD)
             return createFatQuadLeaf(ty, curRecord, curAddr, curBytes, children, numChildren);
           else if (ty == PROCEDURAL)
-            return createProcedurals(curRecord,curAddr,curBytes);
+            return createProcedurals(curRecord,curAddr,curBytes,packed_leaf_builder);
           else if (ty == INSTANCE) {
             if (rtas_format == ZE_RTAS_DEVICE_FORMAT_EXP_VERSION_1)
               return createInstances<InstanceLeaf>(curRecord,curAddr,curBytes);
@@ -715,7 +1290,7 @@ namespace embree
           return ReductionTy();
         }
 
-        const ReductionTy createLargeLeaf(const BuildRecord& curRecord, char* curAddr, size_t curBytes)
+        const ReductionTy createLargeLeaf(const BuildRecord& curRecord, char* curAddr, size_t curBytes, ProceduralLeafBuilder* packed_leaf_builder)
         {
           /* this should never occur but is a fatal error */
           if (curRecord.depth > cfg.maxDepth)
@@ -728,7 +1303,7 @@ namespace embree
           
           /* create leaf for few primitives */
           if (curRecord.prims.size() <= cfg.leafSize[curRecord.type])
-            return createFatLeaf(curRecord,curAddr,curBytes);
+            return createFatLeaf(curRecord,curAddr,curBytes,packed_leaf_builder);
           
           /*! initialize child list with first child */
           ReductionTy values[BVH_WIDTH];
@@ -754,7 +1329,7 @@ namespace embree
           /* recurse into each child  and perform reduction */
           char* childPtr = childBase;
           for (size_t i=0; i<numChildren; i++) {
-            values[i] = createLargeLeaf(children[i],childPtr,sizeof(QBVH6::InternalNode6));
+            values[i] = createLargeLeaf(children[i],childPtr,sizeof(QBVH6::InternalNode6),packed_leaf_builder);
             if (!values[i].valid()) return ReductionTy();
             childPtr += sizeof(QBVH6::InternalNode6);
           }
@@ -762,7 +1337,22 @@ namespace embree
           return setNode(curAddr,curBytes,NODE_TYPE_INTERNAL,childBase,children,values,numChildren);
         }
         
-        const ReductionTy createInternalNode(BuildRecord& curRecord, char* curAddr, size_t curBytes)
+        /* checks if all primitives of a build record are procedurals that share the same leaf descriptor */
+        bool hasSingleProceduralLeafDesc(const BuildRecord& curRecord)
+        {
+          if (curRecord.type != PROCEDURAL)
+            return false;
+
+          auto prim0 = prims[curRecord.begin()];
+          auto desc0 = getProcedural(prim0.geomID(),prim0.primID()).desc(prim0.geomID());
+          for (size_t i=curRecord.begin()+1; i<curRecord.end(); i++) {
+            if (getProcedural(prims[i].geomID(),prims[i].primID()).desc(prims[i].geomID()) != desc0)
+              return false;
+          }
+          return true;
+        }
+        
+        const ReductionTy createInternalNode(BuildRecord& curRecord, char* curAddr, size_t curBytes, ProceduralLeafBuilder* packed_leaf_builder = nullptr)
         {
           /* create leaf when threshold reached or we are too deep */
           bool createLeaf = curRecord.prims.size() <= cfg.leafSize[curRecord.type] ||
@@ -783,9 +1373,28 @@ namespace embree
             performTypeSplit &= !curRecord.equalType();
           }
           
+          /* The procedural leaves of a subtree that is built by a single
+           * thread can get packed densely, by continuing to fill the
+           * current procedural leaf of the previous fat leaf. For a
+           * single leaf descriptor we know exactly how many procedural
+           * leaves the subtree requires. */
+          ProceduralLeafBuilder subtree_leaf_builder(nullptr,0);
+          if (!packed_leaf_builder && (build_flags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_PACK_PROCEDURALS) &&
+              curRecord.size() <= SINGLE_THREAD_THRESHOLD && hasSingleProceduralLeafDesc(curRecord))
+          {
+            const size_t numBlocks = (curRecord.size()+ProceduralLeaf::N-1)/ProceduralLeaf::N;
+            char* childData = (char*) allocator.malloc(numBlocks*sizeof(ProceduralLeaf), 64);
+
+            if (!childData)
+              return ReductionTy();
+
+            subtree_leaf_builder = ProceduralLeafBuilder(childData, numBlocks);
+            packed_leaf_builder = &subtree_leaf_builder;
+          }
+          
           /* create leaf node */
           if (!performTypeSplit && createLeaf)
-            return createLargeLeaf(curRecord,curAddr,curBytes);
+            return createLargeLeaf(curRecord,curAddr,curBytes,packed_leaf_builder);
           
           /*! initialize child list with first child */
           ReductionTy values[BVH_WIDTH];
@@ -806,15 +1415,20 @@ namespace embree
           }
           
           /*! perform SAH splits until node is full */
-          while (numChildren < BVH_WIDTH)
           {
-            const int bestChild = findChildWithLargestArea(children,numChildren,cfg.leafSize[curRecord.type]);
-            if (bestChild == -1) break;
-            SAHSplit(curRecord.depth,cfg.sahBlockSize,bestChild,children,numChildren);
+            /* the splits of large nodes run on a single thread, tracing them shows serial work at the top of the tree */
+            TraceScope trace(curRecord.size() > SINGLE_THREAD_THRESHOLD ? tracer : nullptr, "SAHSplit", curRecord.size());
+            
+            while (numChildren < BVH_WIDTH)
+            {
+              const int bestChild = findChildWithLargestArea(curRecord.bounds(),children,numChildren,cfg.leafSize[curRecord.type]);
+              if (bestChild == -1) break;
+              SAHSplit(curRecord.bounds(),curRecord.depth,cfg.sahBlockSize,bestChild,children,numChildren);
+            }
           }
           
           /* sort build records for faster shadow ray traversal */
-          std::sort(children,children+numChildren,std::less<BuildRecord>());
+          sortChildren(children,numChildren,std::less<BuildRecord>());
           
           /*! allocate data for all children */
           size_t childrenBytes = numChildren*sizeof(QBVH6::InternalNode6);
@@ -824,12 +1438,14 @@ namespace embree
             return ReductionTy();
 
           /* spawn tasks */
-          if (curRecord.size() > 1024) // cfg.singleThreadThreshold
+          if (curRecord.size() > SINGLE_THREAD_THRESHOLD)
           {
             std::atomic<bool> success = true;
             parallel_for(size_t(0), numChildren, [&] (const range<size_t>& r) {
               if (!success) return;
               for (size_t i=r.begin(); i<r.end(); i++) {
+                /* subtrees built by a single thread show the load balance of the parallel build */
+                TraceScope trace(children[i].size() <= SINGLE_THREAD_THRESHOLD ? tracer : nullptr, "subtree", children[i].size());
                 values[i] = createInternalNode(children[i],childBase+i*sizeof(QBVH6::InternalNode6),sizeof(QBVH6::InternalNode6));
                 if (!values[i].valid()) {
                   success = false;
@@ -850,7 +1466,7 @@ namespace embree
           {
             /* recurse into each child */
             for (size_t i=0; i<numChildren; i++) {
-              values[i] = createInternalNode(children[i],childBase+i*sizeof(QBVH6::InternalNode6),sizeof(QBVH6::InternalNode6));
+              values[i] = createInternalNode(children[i],childBase+i*sizeof(QBVH6::InternalNode6),sizeof(QBVH6::InternalNode6),packed_leaf_builder);
               if (!values[i].valid()) return ReductionTy();
             }
 
@@ -866,35 +1482,13 @@ namespace embree
           return ReductionTy(addr, NODE_TYPE_INTERNAL, 0x00, PrimRange(curBytes/64));
         }
         
-        PrimInfo createTrianglePairPrimRefArray(PrimRef* prims, const range<size_t>& r, size_t k, unsigned int geomID)
+        /* triangles get passed their pairing information, the callback creates one primref per triangle pair */
+        PrimInfo createPrimRefArrayForGeometry(const range<size_t>& r, size_t k, unsigned int geomID)
         {
-          PrimInfo pinfo(empty);
-          for (size_t j=r.begin(); j<r.end(); j++)
-          {
-            uint16_t pair = quadification[geomID][j];
-            if (pair == QUADIFIER_PAIRED) continue;
-            
-            BBox3fa bounds = empty;
-            Triangle tri0 = getTriangle(geomID,j);
-            bounds.extend(tri0.p0);
-            bounds.extend(tri0.p1);
-            bounds.extend(tri0.p2);
-            if (!tri0.valid()) continue;
-            
-            if (pair != QUADIFIER_TRIANGLE)
-            {
-              Triangle tri1 = getTriangle(geomID,j+pair);
-              bounds.extend(tri1.p0);
-              bounds.extend(tri1.p1);
-              bounds.extend(tri1.p2);
-              if (!tri1.valid()) continue;
-            }
-
-            const PrimRef prim(bounds,geomID,unsigned(j));
-            pinfo.add_center2(prim);
-            prims[k++] = prim;
-          }
-          return pinfo;
+          const QuadifierType* quads = nullptr;
+          if (getType(geomID) == QBVH6BuilderSAH::TRIANGLE)
+            quads = (const QuadifierType*) quadification[geomID];
+          return createPrimRefArray(prims,BBox1f(0,1),r,k,geomID,quads);
         }
 
         void splitTrianglePair(const PrimRef& prim, const size_t dim, const float pos, PrimRef& left_o, PrimRef& right_o) const
@@ -1003,14 +1597,21 @@ namespace embree
             }
           }
 
+          /* transform bounds of all opened nodes at once */
+          XfmBoundsBatch batch(instance.local2world);
+          for (size_t i=0; i<heap.size(); i++)
+            batch.add(heap[i].node->bounds());
+
+          BBox3fa bounds[XfmBoundsBatch::MAX_SIZE];
+          batch.transform(bounds);
+
           /* create primrefs */
           for (size_t i=0; i<heap.size(); i++)
           {
             QBVH6::InternalNode6* node = heap[i].node;
-            BBox3fa bounds = xfmBounds(instance.local2world,node->bounds());
             int64_t ofs = ((int64_t)node-(int64_t)root)/64;
             assert(ofs >= INT_MIN && ofs <= INT_MAX);
-            subPrims[numSubPrims++] = PrimRef(bounds,geomID,(int32_t)ofs);
+            subPrims[numSubPrims++] = PrimRef(bounds[i],geomID,(int32_t)ofs);
           }
         }
 
@@ -1056,80 +1657,123 @@ namespace embree
           }
         }
 
-        ReductionTy build(uint32_t numGeometries, PrimInfo& pinfo_o, char* root)
+        /* pairs the triangles of all geometries, afterwards pstate holds the primitive ranges of all tasks */
+        PrimInfo quadify(uint32_t numGeometries, ParallelForForPrefixSumState<PrimInfo>& pstate)
         {
-          double t1 = verbose ? getSeconds() : 0.0;
-
-          /* quadify all triangles */
-          ParallelForForPrefixSumState<PrimInfo> pstate;
           pstate.init(numGeometries,getSize,size_t(1024));
           PrimInfo pinfo = parallel_for_for_prefix_sum0_( pstate, size_t(1), getSize, PrimInfo(empty), [&](size_t geomID, const range<size_t>& r, size_t k) -> PrimInfo {
-            if (getType(geomID) == QBVH6BuilderSAH::TRIANGLE)
-              return PrimInfo(pair_triangles(geomID,(QuadifierType*) quadification[geomID].data(), r.begin(), r.end(), getTriangleIndices));
+            if (getType(geomID) == QBVH6BuilderSAH::TRIANGLE) {
+              if (pairingGeomIDs && pairingGeomIDs[geomID] != geomID) return PrimInfo(empty);
+              return PrimInfo(pair_triangles(geomID,(QuadifierType*) quadification[geomID], r.begin(), r.end(), getTriangleIndices));
+            }
             else
               return PrimInfo(r.size());
           }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); });
 
-          double t2 = verbose ? getSeconds() : 0.0;
+          if (!pairingGeomIDs)
+            return pinfo;
+
+          /* geometries that share a pairing can only count their primitives once that pairing is complete */
+          return parallel_for_for_prefix_sum0_( pstate, size_t(1), getSize, PrimInfo(empty), [&](size_t geomID, const range<size_t>& r, size_t k) -> PrimInfo {
+            if (getType(geomID) != QBVH6BuilderSAH::TRIANGLE)
+              return PrimInfo(r.size());
+
+            const uint16_t* quads = quadification[geomID];
+            size_t num = 0;
+            for (size_t i=r.begin(); i<r.end(); i++)
+              num += quads[i] != QUADIFIER_PAIRED;
+            return PrimInfo(num);
+          }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); });
+        }
+
+        /* splits large primitives and opens instances, the primrefs behind pinfo.size() are the budget for the additional primitives */
+        PrimInfo presplit(const PrimInfo& pinfo)
+        {
+          auto splitter = [this] (const PrimRef& prim, const size_t dim, const float pos, PrimRef& left_o, PrimRef& right_o) {
+            splitTriangleOrQuad(prim,dim,pos,left_o,right_o);
+          };
+
+          auto splitter1 = [&] (const PrimRef& prim,
+                                const unsigned int splitprims,
+                                const SplittingGrid& grid,
+                                PrimRef subPrims[MAX_PRESPLITS_PER_PRIMITIVE],
+                                unsigned int& numSubPrims)
+          {
+            if (getType(prim.geomID()) == QBVH6BuilderSAH::INSTANCE) {
+              openInstance(prim,splitprims,subPrims,numSubPrims);
+            } else {
+              splitPrimitive(splitter,prim,splitprims,grid,subPrims,numSubPrims);
+            }
+          };
+
+          auto primitiveArea1 = [this] (const PrimRef& prim) -> float {
+            return primitiveArea(prim);
+          };
+
+          return createPrimRefArray_presplit(pinfo.size(), prims, pinfo, splitter1, primitiveArea1);
+        }
+
+        ReductionTy build(uint32_t numGeometries, PrimInfo& pinfo_o, char* root)
+        {
+          double t1 = timing ? getSeconds() : 0.0;
+
+          /* quadify all triangles */
+          ParallelForForPrefixSumState<PrimInfo> pstate;
+          PrimInfo pinfo = quadify(numGeometries,pstate);
+
+          double t2 = timing ? getSeconds() : 0.0;
+          if (tracer) tracer->record("quadification",t1,t2,pinfo.size());
           if (verbose) std::cout << "quadification: " << std::setw(10) << (t2-t1)*1000.0 << "ms, " << std::endl; //<< std::setw(10) << 1E-6*double(numTriangles)/(t2-t1) << " Mtris/s" << std::endl;
 
           size_t numPrimitives = pinfo.size();
-          
+          if (statistics) statistics->numPrimitives = numPrimitives;
+
+          /* the streaming build reuses the scratch buffer for chunks of varying partitions, thus only this build touches it first */
+          if (build_flags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_FIRST_TOUCH_SCRATCH)
+            firstTouchPrims(pstate);
+
           /* first try */
           //pstate.init(numGeometries,getSize,size_t(1024));
           pinfo = parallel_for_for_prefix_sum1_( pstate, size_t(1), getSize, PrimInfo(empty), [&](size_t geomID, const range<size_t>& r, size_t k, const PrimInfo& base) -> PrimInfo {
-            if (getType(geomID) == QBVH6BuilderSAH::TRIANGLE)
-              return createTrianglePairPrimRefArray(prims.data(),r,base.size(),(unsigned)geomID);
-            else
-              return createPrimRefArray(prims,BBox1f(0,1),r,base.size(),(unsigned)geomID);
+            return createPrimRefArrayForGeometry(r,base.size(),(unsigned)geomID);
           }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); });
 
-          double t3 = verbose ? getSeconds() : 0.0;
+          double t3 = timing ? getSeconds() : 0.0;
+          if (tracer) tracer->record("primrefgen",t2,t3,numPrimitives);
           if (verbose) std::cout << "primrefgen   : " << std::setw(10) << (t3-t2)*1000.0 << "ms, " << std::setw(10) << 1E-6*double(numPrimitives)/(t3-t2) << " Mprims/s" << std::endl;
-          
+
           /* if we need to filter out geometry, run again */
-          if (pinfo.size() != numPrimitives)
+          const bool filtered = pinfo.size() != numPrimitives;
+          if (filtered)
           {
             numPrimitives = pinfo.size();
-            
+
             pinfo = parallel_for_for_prefix_sum1_( pstate, size_t(1), getSize, PrimInfo(empty), [&](size_t geomID, const range<size_t>& r, size_t k, const PrimInfo& base) -> PrimInfo {
-              if (getType(geomID) == QBVH6BuilderSAH::TRIANGLE) {
-                return createTrianglePairPrimRefArray(prims.data(),r,base.size(),(unsigned)geomID);
-              }
-              else                                                                               
-                return createPrimRefArray(prims,BBox1f(0,1),r,base.size(),(unsigned)geomID);
+              return createPrimRefArrayForGeometry(r,base.size(),(unsigned)geomID);
             }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); });
           }
           assert(pinfo.size() == numPrimitives);
-          
-          double t4 = verbose ? getSeconds() : 0.0;
+
+          double t4 = timing ? getSeconds() : 0.0;
+          if (tracer && filtered) tracer->record("primrefgen2",t3,t4,numPrimitives);
           if (verbose) std::cout << "primrefgen2  : " << std::setw(10) << (t4-t3)*1000.0 << "ms, " << std::setw(10) << 1E-6*double(numPrimitives)/(t4-t3) << " Mprims/s" << std::endl;
-          
+
           /* perform pre-splitting */
           if (useSpatialSplits(build_quality,build_flags) &&  numPrimitives)
-          {
-            auto splitter = [this] (const PrimRef& prim, const size_t dim, const float pos, PrimRef& left_o, PrimRef& right_o) {
-              splitTriangleOrQuad(prim,dim,pos,left_o,right_o);
-            };
+            pinfo = presplit(pinfo);
 
-            auto splitter1 = [&] (const PrimRef& prim,
-                                  const unsigned int splitprims,
-                                  const SplittingGrid& grid,
-                                  PrimRef subPrims[MAX_PRESPLITS_PER_PRIMITIVE],
-                                  unsigned int& numSubPrims)
-            {
-              if (getType(prim.geomID()) == QBVH6BuilderSAH::INSTANCE) {
-                openInstance(prim,splitprims,subPrims,numSubPrims);
-              } else {
-                splitPrimitive(splitter,prim,splitprims,grid,subPrims,numSubPrims);
-              }
-            };
+          double t5 = timing ? getSeconds() : 0.0;
+          if (tracer && useSpatialSplits(build_quality,build_flags)) tracer->record("presplit",t4,t5,pinfo.size());
+          if (verbose) std::cout << "presplit     : " << std::setw(10) << (t5-t4)*1000.0 << "ms, " << std::setw(10) << 1E-6*double(numPrimitives)/(t5-t4) << " Mprims/s" << std::endl;
 
-            auto primitiveArea1 = [this] (const PrimRef& prim) -> float {
-              return primitiveArea(prim);
-            };
-            
-            pinfo = createPrimRefArray_presplit(numPrimitives, prims, pinfo, splitter1, primitiveArea1);
+          if (statistics)
+          {
+            statistics->quadifySeconds = t2-t1;
+            statistics->primRefSeconds = t3-t2;
+            statistics->filterSeconds = t4-t3;
+            statistics->presplitSeconds = t5-t4;
+            statistics->numValidPrimitives = numPrimitives;
+            statistics->numBuildPrimitives = pinfo.size();
           }
 
           /* exit early if scene is empty */
@@ -1137,25 +1781,571 @@ namespace embree
             pinfo_o = pinfo;
             return createEmptyNode(root);
           }
-          
+
           /* build hierarchy */
           BuildRecord record(1,pinfo,UNKNOWN);
           ReductionTy r = createInternalNode(record,root,sizeof(QBVH6::InternalNode6));
-          
-          double t5 = verbose ? getSeconds() : 0.0;
-          if (verbose) std::cout << "bvh_build    : " << std::setw(10) << (t5-t4)*1000.0 << "ms, " << std::setw(10) << 1E-6*double(numPrimitives)/(t5-t4) << " Mprims/s" << std::endl;
+
+          double t6 = timing ? getSeconds() : 0.0;
+          if (tracer) tracer->record("bvh_build",t5,t6,pinfo.size());
+          if (verbose) std::cout << "bvh_build    : " << std::setw(10) << (t6-t5)*1000.0 << "ms, " << std::setw(10) << 1E-6*double(numPrimitives)/(t6-t5) << " Mprims/s" << std::endl;
+          if (statistics) statistics->hierarchySeconds = t6-t5;
 
           pinfo_o = pinfo;
           return r;
         }
 
+        static const size_t STREAM_BLOCK_SIZE = 256; //!< number of input primitives whose primrefs get created at once by a streaming build
+
+        /* creates the primrefs of a range of primitives block by block in a small local buffer and passes each block to func */
+        template<typename Func>
+        void streamPrimRefs(unsigned int geomID, const range<size_t>& r, const Func& func)
+        {
+          const QuadifierType* quads = nullptr;
+          if (getType(geomID) == QBVH6BuilderSAH::TRIANGLE)
+            quads = (const QuadifierType*) quadification[geomID];
+
+          struct __aligned(64) Block { PrimRef prims[STREAM_BLOCK_SIZE]; } block;
+          evector<PrimRef> blockPrims((void*)block.prims,sizeof(block.prims));
+          blockPrims.resize(STREAM_BLOCK_SIZE);
+
+          for (size_t i=r.begin(); i<r.end(); i+=STREAM_BLOCK_SIZE)
+          {
+            const range<size_t> rb(i,min(i+STREAM_BLOCK_SIZE,r.end()));
+            const PrimInfo info = createPrimRefArray(blockPrims,BBox1f(0,1),rb,0,geomID,quads);
+            func(block.prims,info.size());
+          }
+        }
+
+        /* creates the primrefs of a block of STREAM_BLOCK_SIZE consecutive input primitives of a geometry,
+         * geomBlocks holds the index of the first block of each geometry */
+        template<typename Func>
+        void streamBlock(const std::vector<size_t>& geomBlocks, size_t blockID, const Func& func)
+        {
+          const size_t geomID = std::upper_bound(geomBlocks.begin(),geomBlocks.end(),blockID) - geomBlocks.begin() - 1;
+          const size_t begin = (blockID-geomBlocks[geomID])*STREAM_BLOCK_SIZE;
+          streamPrimRefs((unsigned)geomID,range<size_t>(begin,min(begin+STREAM_BLOCK_SIZE,size_t(getSize(geomID)))),func);
+        }
+
+        /* Builds scenes whose primrefs do not fit into the scratch buffer. The primitives get
+         * grouped into spatially compact chunks of Morton ordered grid cells that fit into the
+         * scratch buffer. Each block of input primitives records the chunks it contributes to,
+         * thus the primrefs of a chunk get created again from just these blocks, and its subtree
+         * is built like a regular BVH. A hierarchy built with SAH over the chunk bounds connects
+         * the subtrees. With a tail capacity, the primrefs of chunks that exceed the scratch buffer
+         * get placed at the end of the acceleration structure buffer behind the BVH data built
+         * so far, and the build fails if that data reaches them. */
+        ReductionTy buildStreaming(uint32_t numGeometries, PrimInfo& pinfo_o, char* root, size_t tailEnd = 0, size_t tailCapacity = 0)
+        {
+          PrimRef* const scratchData = prims.data();
+          const size_t scratchCapacity = prims.capacity();
+          const size_t chunkCapacity = max(scratchCapacity,tailCapacity);
+          if (chunkCapacity == 0)
+            throw std::runtime_error("scratch buffer too small");
+
+          double t1 = timing ? getSeconds() : 0.0;
+
+          /* quadify all triangles */
+          ParallelForForPrefixSumState<PrimInfo> pstate;
+          const size_t numPrimitives = quadify(numGeometries,pstate).size();
+          if (statistics) statistics->numPrimitives = numPrimitives;
+
+          double t2 = timing ? getSeconds() : 0.0;
+          if (tracer) tracer->record("quadification",t1,t2,numPrimitives);
+          if (verbose) std::cout << "quadification: " << std::setw(10) << (t2-t1)*1000.0 << "ms, " << std::endl;
+
+          auto merge = [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); };
+
+          /* primrefs get created in blocks of consecutive primitives of a geometry */
+          std::vector<size_t> geomBlocks(numGeometries+1,0);
+          for (size_t geomID=0; geomID<numGeometries; geomID++)
+            geomBlocks[geomID+1] = geomBlocks[geomID] + (getSize(geomID)+STREAM_BLOCK_SIZE-1)/STREAM_BLOCK_SIZE;
+          const size_t numBlocks = geomBlocks[numGeometries];
+
+          /* get bounds of all valid primitives */
+          const PrimInfo sceneInfo = parallel_reduce(size_t(0), numBlocks, size_t(1), PrimInfo(empty), [&](const range<size_t>& r) -> PrimInfo {
+            PrimInfo info(empty);
+            for (size_t blockID=r.begin(); blockID<r.end(); blockID++)
+              streamBlock(geomBlocks,blockID,[&](const PrimRef* block, size_t num) {
+                for (size_t i=0; i<num; i++) info.add_center2(block[i]);
+              });
+            return info;
+          }, merge);
+
+          /* count primitives per top level cell and get the cell range of each block, neighboring primitives often share a cell */
+          StreamingChunks chunks;
+          chunks.grids.push_back(StreamingGrid(sceneInfo.centBounds,StreamingChunks::TOP_BITS));
+          chunks.first.push_back(0);
+          chunks.cells.resize(chunks.grids[0].size(),0);
+          const size_t numTopCells = chunks.cells.size();
+
+          std::vector<size_t> cellCounts(numTopCells,0);
+          std::vector<uint32_t> blockCells(2*numBlocks);
+          if (sceneInfo.size())
+          {
+            std::vector<std::atomic<size_t>> counts(numTopCells);
+            parallel_for(size_t(0), numBlocks, [&](const range<size_t>& r) {
+              for (size_t blockID=r.begin(); blockID<r.end(); blockID++)
+              {
+                uint32_t minCell = uint32_t(-1), maxCell = 0;
+                streamBlock(geomBlocks,blockID,[&](const PrimRef* block, size_t num) {
+                  for (size_t i=0, n=0; i<num; i+=n) {
+                    const uint32_t cell = chunks.grids[0].cell(block[i]);
+                    for (n=1; i+n<num && chunks.grids[0].cell(block[i+n]) == cell; n++);
+                    minCell = min(minCell,cell); maxCell = max(maxCell,cell);
+                    counts[cell] += n;
+                  }
+                });
+                blockCells[2*blockID+0] = minCell;
+                blockCells[2*blockID+1] = maxCell;
+              }
+            });
+            for (size_t cell=0; cell<numTopCells; cell++)
+              cellCounts[cell] = counts[cell];
+          }
+
+          double t3 = timing ? getSeconds() : 0.0;
+          if (tracer) tracer->record("primrefgen",t2,t3,numPrimitives);
+          if (verbose) std::cout << "primrefgen   : " << std::setw(10) << (t3-t2)*1000.0 << "ms, " << std::setw(10) << 1E-6*double(numPrimitives)/(t3-t2) << " Mprims/s" << std::endl;
+
+          if (statistics)
+          {
+            statistics->quadifySeconds = t2-t1;
+            statistics->primRefSeconds = t3-t2;
+            statistics->filterSeconds = 0.0;
+            statistics->numValidPrimitives = sceneInfo.size();
+          }
+
+          /* exit early if scene is empty */
+          if (sceneInfo.size() == 0) {
+            if (statistics) statistics->numBuildPrimitives = 0;
+            pinfo_o = sceneInfo;
+            return createEmptyNode(root);
+          }
+
+          /* leave a sixth of the primref buffer of each chunk for presplits */
+          const size_t maxChunkSize = useSpatialSplits(build_quality,build_flags) ? chunkCapacity*5/6 : chunkCapacity;
+
+          /* refine cells with more primitives than fit into a chunk level by level, for each new grid
+           * one pass gets the bounds of the primitives of the refined cell and one pass counts them per cell */
+          std::vector<uint32_t> gridTopCell(1,0);
+          for (size_t level=0, levelGrids=0;; level++)
+          {
+            const size_t firstPending = chunks.grids.size();
+            std::vector<uint32_t> refinedTopCells;
+            for (size_t g=levelGrids; g<firstPending; g++)
+            {
+              for (size_t cell=chunks.first[g]; cell<chunks.first[g]+chunks.grids[g].size(); cell++)
+              {
+                if (cellCounts[cell] <= maxChunkSize) continue;
+                if (level == StreamingChunks::MAX_LEVELS)
+                  throw std::runtime_error("scratch buffer too small for streaming build");
+
+                const uint32_t topCell = g == 0 ? uint32_t(cell) : gridTopCell[g];
+                chunks.cells[cell] = StreamingChunks::REFINED | uint32_t(chunks.grids.size());
+                chunks.grids.push_back(StreamingGrid());
+                gridTopCell.push_back(topCell);
+                refinedTopCells.push_back(topCell);
+              }
+            }
+            const size_t numPending = chunks.grids.size()-firstPending;
+            if (numPending == 0) break;
+            levelGrids = firstPending;
+
+            /* only blocks whose top level cell range contains a refined cell need to get streamed */
+            std::sort(refinedTopCells.begin(),refinedTopCells.end());
+            refinedTopCells.erase(std::unique(refinedTopCells.begin(),refinedTopCells.end()),refinedTopCells.end());
+            auto streamRefined = [&] (const auto& func) {
+              parallel_for(size_t(0), numBlocks, [&](const range<size_t>& r) {
+                for (size_t blockID=r.begin(); blockID<r.end(); blockID++)
+                {
+                  const uint32_t cell0 = blockCells[2*blockID+0], cell1 = blockCells[2*blockID+1];
+                  if (cell0 > cell1) continue;
+                  if (std::lower_bound(refinedTopCells.begin(),refinedTopCells.end(),cell0) == std::upper_bound(refinedTopCells.begin(),refinedTopCells.end(),cell1))
+                    continue;
+                  streamBlock(geomBlocks,blockID,func);
+                }
+              });
+            };
+
+            /* get the bounds of the primitive centers of each refined cell, runs of primitives in the same cell get merged before the atomic update */
+            std::vector<std::atomic<float>> bounds(6*numPending);
+            for (size_t i=0; i<numPending; i++)
+              for (size_t dim=0; dim<3; dim++) {
+                bounds[6*i+dim+0] = +std::numeric_limits<float>::infinity();
+                bounds[6*i+dim+3] = -std::numeric_limits<float>::infinity();
+              }
+
+            auto atomic_update = [] (std::atomic<float>& dst, float v, bool lower) {
+              float cur = dst.load();
+              while ((lower ? v < cur : v > cur) && !dst.compare_exchange_weak(cur,v));
+            };
+
+            streamRefined([&](const PrimRef* block, size_t num) {
+              for (size_t i=0, n=0; i<num; i+=n)
+              {
+                const size_t cell = chunks.cell(block[i],firstPending);
+                BBox3fa b(block[i].center2());
+                for (n=1; i+n<num && chunks.cell(block[i+n],firstPending) == cell; n++)
+                  b.extend(block[i+n].center2());
+
+                if (!(chunks.cells[cell] & StreamingChunks::REFINED)) continue;
+                const size_t slot = (chunks.cells[cell] & ~StreamingChunks::REFINED) - firstPending;
+                for (size_t dim=0; dim<3; dim++) {
+                  atomic_update(bounds[6*slot+dim+0],b.lower[dim],true);
+                  atomic_update(bounds[6*slot+dim+3],b.upper[dim],false);
+                }
+              }
+            });
+
+            /* create the grids of the refined cells, primitives with the same center cannot get separated */
+            const size_t levelCells = chunks.cells.size();
+            for (size_t i=0; i<numPending; i++)
+            {
+              const BBox3fa b(Vec3fa(bounds[6*i+0],bounds[6*i+1],bounds[6*i+2]),Vec3fa(bounds[6*i+3],bounds[6*i+4],bounds[6*i+5]));
+              if (b.lower.x == b.upper.x && b.lower.y == b.upper.y && b.lower.z == b.upper.z)
+                throw std::runtime_error("scratch buffer too small for streaming build");
+
+              chunks.grids[firstPending+i] = StreamingGrid(b,StreamingChunks::SUB_BITS);
+              chunks.first.push_back(chunks.cells.size());
+              chunks.cells.resize(chunks.cells.size()+chunks.grids[firstPending+i].size(),0);
+            }
+
+            /* count the primitives per cell of the new grids */
+            std::vector<std::atomic<size_t>> counts(chunks.cells.size()-levelCells);
+            streamRefined([&](const PrimRef* block, size_t num) {
+              for (size_t i=0, n=0; i<num; i+=n)
+              {
+                const size_t cell = chunks.cell(block[i],chunks.grids.size());
+                for (n=1; i+n<num && chunks.cell(block[i+n],chunks.grids.size()) == cell; n++);
+                if (cell >= levelCells) counts[cell-levelCells] += n;
+              }
+            });
+            cellCounts.resize(chunks.cells.size());
+            for (size_t cell=levelCells; cell<chunks.cells.size(); cell++)
+              cellCounts[cell] = counts[cell-levelCells];
+          }
+
+          /* assign consecutive leaf cells in depth first order to chunks */
+          chunks.chunkSizes.push_back(0);
+          auto assign = [&] (size_t num) -> uint32_t
+          {
+            if (chunks.chunkSizes.back()+num > maxChunkSize)
+              chunks.chunkSizes.push_back(0);
+
+            chunks.chunkSizes.back() += num;
+            return uint32_t(chunks.size()-1);
+          };
+
+          auto startChunk = [&] () {
+            if (chunks.chunkSizes.back())
+              chunks.chunkSizes.push_back(0);
+          };
+
+          std::function<void(size_t)> assignGrid = [&] (size_t g)
+          {
+            for (size_t cell=chunks.first[g]; cell<chunks.first[g]+chunks.grids[g].size(); cell++)
+            {
+              if (chunks.cells[cell] & StreamingChunks::REFINED)
+                assignGrid(chunks.cells[cell] & ~StreamingChunks::REFINED);
+              else
+                chunks.cells[cell] = assign(cellCounts[cell]);
+            }
+          };
+
+          /* refined top level cells get chunks of their own, thus the dense regions of the scene
+           * do not share chunks with small distant cells that would enlarge their bounds */
+          std::vector<uint32_t> topChunks(2*numTopCells);
+          for (size_t cell=0; cell<numTopCells; cell++)
+          {
+            if (chunks.cells[cell] & StreamingChunks::REFINED) {
+              startChunk();
+              topChunks[2*cell+0] = uint32_t(chunks.size()-1);
+              assignGrid(chunks.cells[cell] & ~StreamingChunks::REFINED);
+              topChunks[2*cell+1] = uint32_t(chunks.size()-1);
+              startChunk();
+            } else {
+              chunks.cells[cell] = assign(cellCounts[cell]);
+              topChunks[2*cell+0] = topChunks[2*cell+1] = chunks.cells[cell];
+            }
+          }
+          if (chunks.size() > 1 && chunks.chunkSizes.back() == 0)
+            chunks.chunkSizes.pop_back();
+          const size_t numChunks = chunks.size();
+
+          /* each block contributes to the chunks of its top level cell range, blocks in a single chunk contribute all their primitives */
+          std::vector<size_t> blockEntries(numBlocks+1,0);
+          std::vector<uint32_t> blockChunk(numBlocks,0);
+          for (size_t blockID=0; blockID<numBlocks; blockID++)
+          {
+            blockEntries[blockID+1] = blockEntries[blockID];
+            if (blockCells[2*blockID+0] > blockCells[2*blockID+1]) continue;
+            blockChunk[blockID] = topChunks[2*blockCells[2*blockID+0]+0];
+            blockEntries[blockID+1] += topChunks[2*blockCells[2*blockID+1]+1]-blockChunk[blockID]+1;
+          }
+
+          std::vector<uint32_t> entryCounts(blockEntries[numBlocks],0);
+          std::vector<BBox3fa> entryBounds(blockEntries[numBlocks],BBox3fa(empty));
+          parallel_for(size_t(0), numBlocks, [&](const range<size_t>& r) {
+            for (size_t blockID=r.begin(); blockID<r.end(); blockID++)
+            {
+              const size_t numEntries = blockEntries[blockID+1]-blockEntries[blockID];
+              if (numEntries == 0) continue;
+
+              streamBlock(geomBlocks,blockID,[&](const PrimRef* block, size_t num) {
+                for (size_t i=0; i<num; i++) {
+                  const size_t e = numEntries == 1 ? blockEntries[blockID] : blockEntries[blockID] + chunks.chunk(block[i]) - blockChunk[blockID];
+                  entryCounts[e]++;
+                  entryBounds[e].extend(block[i].bounds());
+                }
+              });
+            }
+          });
+
+          /* per chunk list of the contributing blocks in input order, with the offset of their primitives in the chunk */
+          struct ChunkEntry { size_t blockID; size_t offset; };
+          std::vector<size_t> chunkEntries(numChunks+1,0);
+          for (size_t blockID=0; blockID<numBlocks; blockID++)
+            for (size_t e=blockEntries[blockID]; e<blockEntries[blockID+1]; e++)
+              chunkEntries[blockChunk[blockID]+e-blockEntries[blockID]+1] += entryCounts[e] != 0;
+
+          for (size_t chunk=0; chunk<numChunks; chunk++)
+            chunkEntries[chunk+1] += chunkEntries[chunk];
+
+          std::vector<ChunkEntry> entries(chunkEntries[numChunks]);
+          std::vector<size_t> chunkFill(chunkEntries.begin(),chunkEntries.end()-1);
+          std::vector<size_t> chunkOffset(numChunks,0);
+          std::vector<BBox3fa> chunkBounds(numChunks,BBox3fa(empty));
+          for (size_t blockID=0; blockID<numBlocks; blockID++)
+          {
+            for (size_t e=blockEntries[blockID]; e<blockEntries[blockID+1]; e++)
+            {
+              if (entryCounts[e] == 0) continue;
+              const size_t chunk = blockChunk[blockID]+e-blockEntries[blockID];
+              entries[chunkFill[chunk]++] = { blockID, chunkOffset[chunk] };
+              chunkOffset[chunk] += entryCounts[e];
+              chunkBounds[chunk].extend(entryBounds[e]);
+            }
+          }
+
+          /* the hierarchy over the chunk roots gets built with SAH from the chunk bounds before the chunks,
+           * as the children of a node are stored consecutively and the chunk roots are part of them */
+          struct StreamingNode
+          {
+            char* addr;                    //!< address of the node
+            char* childAddr;               //!< address of its first child
+            size_t depth;                  //!< depth of the node
+            size_t numChildren;            //!< number of children
+            size_t children[BVH_WIDTH];    //!< chunk of each child, or numChunks plus the index of a node, as nodes get appended to the records of the chunks
+          };
+          std::vector<StreamingNode> nodes;  // children get stored before their parents
+          std::vector<char*> chunkRoots(numChunks,root);
+          std::vector<size_t> chunkDepths(numChunks,1);
+
+          std::vector<uint32_t> order(numChunks);
+          for (size_t chunk=0; chunk<numChunks; chunk++)
+            order[chunk] = uint32_t(chunk);
+
+          auto orderBounds = [&] (size_t begin, size_t end) -> BBox3fa {
+            BBox3fa bounds(empty);
+            for (size_t i=begin; i<end; i++) bounds.extend(chunkBounds[order[i]]);
+            return bounds;
+          };
+
+          /* sorts a range of chunks along the axis of their centers that gives the lowest SAH
+           * cost of a split, and returns the position of the split */
+          auto splitSAH = [&] (size_t begin, size_t end) -> size_t
+          {
+            auto sortAlong = [&] (size_t dim) {
+              std::sort(order.begin()+begin, order.begin()+end, [&] (uint32_t a, uint32_t b) {
+                const float ca = chunkBounds[a].lower[dim]+chunkBounds[a].upper[dim];
+                const float cb = chunkBounds[b].lower[dim]+chunkBounds[b].upper[dim];
+                return ca < cb || (ca == cb && a < b);
+              });
+            };
+
+            std::vector<float> rightCosts(end-begin);
+            size_t bestDim = 0, bestPos = begin+(end-begin)/2;
+            float bestCost = std::numeric_limits<float>::infinity();
+            for (size_t dim=0; dim<3; dim++)
+            {
+              sortAlong(dim);
+              BBox3fa right(empty); size_t numRight = 0;
+              for (size_t i=end; i-->begin+1; ) {
+                right.extend(chunkBounds[order[i]]); numRight += chunks.chunkSizes[order[i]];
+                rightCosts[i-begin] = halfArea(right)*float(numRight);
+              }
+              BBox3fa left(empty); size_t numLeft = 0;
+              for (size_t i=begin+1; i<end; i++) {
+                left.extend(chunkBounds[order[i-1]]); numLeft += chunks.chunkSizes[order[i-1]];
+                const float cost = halfArea(left)*float(numLeft) + rightCosts[i-begin];
+                if (cost < bestCost) { bestCost = cost; bestDim = dim; bestPos = i; }
+              }
+            }
+            sortAlong(bestDim);
+            return bestPos;
+          };
+
+          /* splits the child with the largest surface area until the node is full */
+          std::function<bool(size_t,size_t,char*,size_t)> createNode = [&] (size_t begin, size_t end, char* addr, size_t depth) -> bool
+          {
+            size_t ranges[BVH_WIDTH][2] = { { begin, end } };
+            size_t numChildren = 1;
+            while (numChildren < BVH_WIDTH)
+            {
+              size_t bestChild = numChildren;
+              float bestArea = -std::numeric_limits<float>::infinity();
+              for (size_t i=0; i<numChildren; i++) {
+                if (ranges[i][1]-ranges[i][0] < 2) continue;
+                const float area = halfArea(orderBounds(ranges[i][0],ranges[i][1]));
+                if (area > bestArea) { bestArea = area; bestChild = i; }
+              }
+              if (bestChild == numChildren) break;
+
+              const size_t split = splitSAH(ranges[bestChild][0],ranges[bestChild][1]);
+              ranges[numChildren][0] = split;
+              ranges[numChildren][1] = ranges[bestChild][1];
+              ranges[bestChild][1] = split;
+              numChildren++;
+            }
+
+            StreamingNode node;
+            node.addr = addr;
+            node.childAddr = (char*) allocator.malloc(numChildren*sizeof(QBVH6::InternalNode6),64);
+            if (!node.childAddr) return false;
+            node.depth = depth;
+            node.numChildren = numChildren;
+
+            for (size_t i=0; i<numChildren; i++)
+            {
+              char* childAddr = node.childAddr + i*sizeof(QBVH6::InternalNode6);
+              if (ranges[i][1]-ranges[i][0] == 1) {
+                const uint32_t chunk = order[ranges[i][0]];
+                chunkRoots[chunk] = childAddr;
+                chunkDepths[chunk] = depth+1;
+                node.children[i] = chunk;
+              } else {
+                if (!createNode(ranges[i][0],ranges[i][1],childAddr,depth+1)) return false;
+                node.children[i] = numChunks + nodes.size()-1;
+              }
+            }
+            nodes.push_back(node);
+            return true;
+          };
+
+          /* a single chunk gets built directly into the root */
+          if (numChunks > 1 && !createNode(0,numChunks,root,1))
+            return ReductionTy();
+
+          /* build the subtree of each chunk */
+          std::vector<BuildRecord> records(numChunks);
+          std::vector<ReductionTy> values(numChunks);
+          size_t numBuildPrimitives = 0;
+          double primRefSeconds = 0.0, presplitSeconds = 0.0;
+
+          for (size_t chunk=0; chunk<numChunks; chunk++)
+          {
+            double c0 = timing ? getSeconds() : 0.0;
+
+            /* place the primrefs of the chunk into the scratch buffer if possible, otherwise behind the BVH data */
+            const size_t chunkSize = chunks.chunkSizes[chunk];
+            const size_t chunkPrims = min(chunkCapacity, useSpatialSplits(build_quality,build_flags) ? chunkSize+chunkSize/5 : chunkSize);
+            if (chunkPrims <= scratchCapacity)
+            {
+              prims = evector<PrimRef>((void*)scratchData,scratchCapacity*sizeof(PrimRef));
+              if (tailEnd) allocator.extend(tailEnd);
+            }
+            else
+            {
+              const size_t chunkBytes = chunkPrims*sizeof(PrimRef);
+              if (tailEnd < chunkBytes || ((tailEnd - chunkBytes) & ~size_t(63)) < allocator.bytesAllocated())
+                return ReductionTy();
+              const size_t chunkOffset = (tailEnd - chunkBytes) & ~size_t(63);
+              prims = evector<PrimRef>((void*)(accel + chunkOffset),chunkBytes);
+              allocator.extend(chunkOffset);
+            }
+            prims.resize(prims.capacity());
+
+            /* create the primrefs of the chunk from its blocks */
+            PrimInfo pinfo = parallel_reduce(chunkEntries[chunk], chunkEntries[chunk+1], size_t(1), PrimInfo(empty), [&](const range<size_t>& r) -> PrimInfo {
+              PrimInfo info(empty);
+              for (size_t e=r.begin(); e<r.end(); e++)
+              {
+                size_t j = entries[e].offset;
+                streamBlock(geomBlocks,entries[e].blockID,[&](const PrimRef* block, size_t num) {
+                  for (size_t i=0; i<num; i++) {
+                    if (chunks.chunk(block[i]) != chunk) continue;
+                    prims[j++] = block[i];
+                    info.add_center2(block[i]);
+                  }
+                });
+              }
+              return info;
+            }, merge);
+            assert(pinfo.size() == chunkSize);
+
+            double c1 = timing ? getSeconds() : 0.0;
+
+            /* presplits of a chunk get the same relative budget as the worst case size estimate assumes */
+            if (useSpatialSplits(build_quality,build_flags))
+            {
+              prims.resize(min(prims.capacity(),pinfo.size()+pinfo.size()/5));
+              pinfo = presplit(pinfo);
+              prims.resize(prims.capacity());
+            }
+
+            double c2 = timing ? getSeconds() : 0.0;
+
+            records[chunk] = BuildRecord(chunkDepths[chunk],pinfo,UNKNOWN);
+            values[chunk] = createInternalNode(records[chunk],chunkRoots[chunk],sizeof(QBVH6::InternalNode6));
+            if (!values[chunk].valid()) return ReductionTy();
+
+            double c3 = timing ? getSeconds() : 0.0;
+            if (tracer) tracer->record("chunk",c0,c3,pinfo.size());
+            primRefSeconds += c1-c0;
+            presplitSeconds += c2-c1;
+            numBuildPrimitives += pinfo.size();
+          }
+
+          /* connect the chunk roots bottom up */
+          for (size_t n=0; n<nodes.size(); n++)
+          {
+            const StreamingNode& node = nodes[n];
+            BuildRecord children[BVH_WIDTH];
+            ReductionTy childValues[BVH_WIDTH];
+            CentGeomBBox3fa bounds(empty);
+            for (size_t i=0; i<node.numChildren; i++)
+            {
+              const size_t id = node.children[i];
+              children[i] = records[id];
+              childValues[i] = values[id];
+              bounds.merge(children[i].prims);
+            }
+            records.push_back(BuildRecord(node.depth,PrimInfoRange(0,0,bounds),UNKNOWN));
+            values.push_back(setInternalNode(node.addr,sizeof(QBVH6::InternalNode6),NODE_TYPE_INTERNAL,node.childAddr,children,childValues,node.numChildren));
+          }
+
+          double t4 = timing ? getSeconds() : 0.0;
+          if (verbose) std::cout << "chunks       : " << std::setw(10) << (t4-t3)*1000.0 << "ms, " << numChunks << " chunks" << std::endl;
+          if (statistics)
+          {
+            statistics->primRefSeconds += primRefSeconds;
+            statistics->presplitSeconds = presplitSeconds;
+            statistics->hierarchySeconds = t4-t3-primRefSeconds-presplitSeconds;
+            statistics->numBuildPrimitives = numBuildPrimitives;
+          }
+
+          /* the root is the last node, or the single chunk */
+          pinfo_o = PrimInfo(0,numBuildPrimitives,records.back().prims);
+          return values.back();
+        }
+
         bool build(size_t numGeometries, char* accel, size_t bytes, BBox3f* boundsOut, size_t* accelBufferBytesOut, void* dispatchGlobalsPtr)
         {
-          double t0 = verbose ? getSeconds() : 0.0;
+          double t0 = timing ? getSeconds() : 0.0;
 
           Stats stats;
           size_t numPrimitives = 0;
-          quadification.resize(numGeometries);
           for (size_t geomID=0; geomID<numGeometries; geomID++)
           {
             const uint32_t N = getSize(geomID);
@@ -1163,10 +2353,7 @@ namespace embree
             if (N == 0) continue;
 
             switch (getType(geomID)) {
-            case QBVH6BuilderSAH::TRIANGLE  :
-              stats.numTriangles += numPrimitives;
-              quadification[geomID].resize(N);
-              break;
+            case QBVH6BuilderSAH::TRIANGLE  : stats.numTriangles += N; break;
             case QBVH6BuilderSAH::QUAD      : stats.numQuads += N; break;
             case QBVH6BuilderSAH::PROCEDURAL: stats.numProcedurals += N; break;
             case QBVH6BuilderSAH::INSTANCE  : stats.numInstances += N; break;
@@ -1174,22 +2361,78 @@ namespace embree
             }
           }
 
+          allocateQuadification(numGeometries,getSize,getType,pairingGeomIDs,quadificationData,quadification);
+
+          /* the presplit estimate scales the triangle count, thus record the input count before */
+          const size_t numInputTriangles = stats.numTriangles;
+
+          /* the expected size gets estimated like for the build properties */
+          Stats expectedStats = stats;
+          if (useSpatialSplits(build_quality,build_flags))
+            expectedStats.estimate_presplits(1.2);
+          expectedStats.estimate_quadification();
+
           stats.estimate_presplits(1.2);
           size_t worstCaseBytes = stats.worst_case_bvh_bytes();
+          if (build_flags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS)
+            worstCaseBytes += Stats::back_pointer_bytes(worstCaseBytes);
           if (accelBufferBytesOut) *accelBufferBytesOut = std::min(std::max(bytes+64,size_t(1.2*bytes)), worstCaseBytes);
 
-          prims.resize(numPrimitives);
-          
-          double t1 = verbose ? getSeconds() : 0.0;
+          /* Optionally place the primrefs at the end of the acceleration structure buffer. If all
+           * of them fit behind the worst case BVH data the build cannot reach them. Otherwise the
+           * scene gets built in chunks, and chunks larger than the scratch buffer place their
+           * primrefs behind the BVH data built so far. Chunks sized by the space the worst case
+           * BVH data leaves never get reached either. Only without scratch buffer the chunks get
+           * sized by the expected BVH data, and the build fails with a retry if the BVH data
+           * reaches their primrefs, as the chunks built already cannot get moved to make room. */
+          const size_t tailBytes = (numPrimitives*sizeof(PrimRef)+63) & ~size_t(63);
+          size_t tailOffset = bytes;
+          size_t tailCapacity = 0;
+          if (build_flags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SCRATCH_IN_RTAS_BUFFER)
+          {
+            if (accelBufferBytesOut) *accelBufferBytesOut = std::min(std::max(bytes+64,size_t(1.2*bytes)), worstCaseBytes + tailBytes);
+
+            if (numPrimitives && bytes >= tailBytes && ((bytes - tailBytes) & ~size_t(63)) >= stats.worst_case_bvh_bytes()) {
+              tailOffset = (bytes - tailBytes) & ~size_t(63);
+              prims = evector<PrimRef>((void*)(accel + tailOffset), tailBytes);
+            }
+            else if (numPrimitives > prims.capacity())
+            {
+              const size_t bvhBytes = prims.capacity() ? stats.worst_case_bvh_bytes() : expectedStats.expected_bvh_bytes();
+              tailCapacity = bytes > bvhBytes ? min(numPrimitives,(bytes - bvhBytes)/sizeof(PrimRef)) : 0;
+              if (tailCapacity <= prims.capacity()) tailCapacity = 0;
+              if (tailCapacity == 0 && prims.capacity() == 0) return false;
+            }
+          }
+
+          double t1 = timing ? getSeconds() : 0.0;
+          if (tracer) tracer->record("scene_size",t0,t1,numPrimitives);
           if (verbose) std::cout << "scene_size   : " << std::setw(10) << (t1-t0)*1000.0 << "ms" << std::endl;
 
+          if (statistics)
+          {
+            statistics->setupSeconds = t1-t0;
+            statistics->numInputPrimitives = numPrimitives;
+            statistics->numInputTriangles = numInputTriangles;
+            statistics->accelBytesProvided = bytes;
+          }
+
           PrimInfo pinfo;
           BBox3f bounds = empty;
 
           if (verbose) std::cout << "trying BVH build with " << bytes << " bytes" << std::endl;
-            
-          /* allocate BVH memory */
-          allocator.init(accel,bytes);
+
+          /* build in spatial chunks when the primrefs of the scene do not fit into the scratch buffer */
+          const bool streaming = numPrimitives > prims.capacity();
+          prims.resize(streaming ? prims.capacity() : numPrimitives);
+
+          /* back pointers get collected per 64 byte block and are appended after the build */
+          this->accel = accel;
+          if (build_flags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS)
+            backPointers.init(bytes/64);
+
+          /* allocate BVH memory in front of the primrefs at the end of the buffer */
+          allocator.init(accel,tailOffset);
           allocator.malloc(128); // header
 
           uint32_t numRoots = 1;
@@ -1198,15 +2441,42 @@ namespace embree
 
           /* build BVH static BVH */
           QBVH6::InternalNode6* root = roots+0;
-          ReductionTy r = build(numGeometries,pinfo,(char*)root);
+          ReductionTy r = streaming ?
+            buildStreaming(numGeometries,pinfo,(char*)root,tailCapacity ? bytes : 0,tailCapacity) :
+            build(numGeometries,pinfo,(char*)root);
+          double t2 = timing ? getSeconds() : 0.0;
+
+          if (statistics) {
+            statistics->numTrianglePairs = statistics->numInputPrimitives - statistics->numPrimitives;
+            statistics->accelBytesUsed = allocator.bytesAllocated();
+          }
 
           /* check if build failed */
           if (!r.valid()) {
+            if (statistics) statistics->totalSeconds = t2-t0;
             return false;
           }
 
           bounds.extend(pinfo.geomBounds);
 
+          /* primrefs at the end of the buffer are no longer needed */
+          allocator.extend(bytes);
+
+          /* the root has no parent */
+          uint32_t* backPointersData = nullptr;
+          size_t numBackPointers = 0;
+          if (!backPointers.empty())
+          {
+            backPointers[getBackPointerID(r.node)] |= 0x03FFFFFFu << 6;
+
+            numBackPointers = allocator.bytesAllocated()/64 - roundOffsetTo128(sizeof(QBVH6));
+            backPointersData = (uint32_t*) allocator.malloc(Stats::back_pointer_bytes(64*numBackPointers),64);
+            if (!backPointersData)
+              return false;
+
+            backPointers.copy(backPointersData,numBackPointers,Stats::back_pointer_bytes(64*numBackPointers)/sizeof(uint32_t));
+          }
+
           if (boundsOut) *boundsOut = bounds;
           if (accelBufferBytesOut)
             *accelBufferBytesOut = allocator.bytesAllocated();
@@ -1222,6 +2492,33 @@ namespace embree
           qbvh->numTimeSegments = 1; 
           qbvh->dispatchGlobalsPtr = (uint64_t) dispatchGlobalsPtr;
 
+          /* the back pointer section ends the acceleration structure, such that its size can get
+           * obtained from the header when copying it */
+          if (backPointersData) {
+            qbvh->backPointerDataStart = uint32_t(((char*)backPointersData - accel)/64);
+            qbvh->backPointerDataEnd = qbvh->backPointerDataStart + uint32_t(Stats::back_pointer_bytes(64*numBackPointers)/64);
+          } else {
+            qbvh->backPointerDataStart = qbvh->backPointerDataEnd = uint32_t((allocator.bytesAllocated()+63)/64);
+          }
+
+          /* nodes and leaves get counted after the build to not slow down the hierarchy build */
+          if (statistics)
+          {
+            BVHStatistics bvhStats = qbvh->computeStatistics();
+            statistics->numInternalNodes = bvhStats.internalNode.numNodes;
+            statistics->numQuadLeaves = bvhStats.quadLeaf.numLeaves;
+            statistics->numProceduralLeaves = bvhStats.proceduralLeaf.numLeaves;
+            statistics->numInstanceLeaves = bvhStats.instanceLeaf.numLeaves;
+            statistics->accelBytesUsed = allocator.bytesAllocated();
+          }
+
+          double t3 = timing ? getSeconds() : 0.0;
+          if (tracer) tracer->record("finalize",t2,t3);
+          if (statistics) {
+            statistics->finalizeSeconds = t3-t2;
+            statistics->totalSeconds = t3-t0;
+          }
+
 #if 0
           BVHStatistics stats = qbvh->computeStatistics();
           stats.print(std::cout);
@@ -1251,23 +2548,105 @@ namespace embree
         Settings cfg;
         evector<PrimRef> prims;
         Allocator allocator;
-        std::vector<std::vector<uint16_t>> quadification;
+        char* accel;
+        BackPointerArray backPointers;
+        ovector<uint16_t> quadificationData;   // pairing of all triangles, stored in one OS allocation that may use huge pages
+        std::vector<uint16_t*> quadification;  // pairing of the triangles of each geometry inside quadificationData
         ze_raytracing_accel_format_internal_t rtas_format;
         ze_rtas_builder_build_quality_hint_exp_t build_quality;
         ze_rtas_builder_build_op_exp_flags_t build_flags;
+        const RayDistribution* rayDistribution;
+        const uint32_t* pairingGeomIDs;   // for each geometry the geometry whose triangle pairing it shares, nullptr if none get shared
         bool verbose;
+        BuildStatistics* statistics;
+        BuildTracer* tracer;
+        bool timing;                  // measure phases, only enabled when the times get printed, reported, or traced
         
       };
 
+      /* places the pairing information of all triangles into one OS allocation, which uses
+       * huge pages when possible, and returns where the pairing of each geometry starts. Geometries
+       * that share the pairing of an earlier geometry with identical index buffer get no own pairing. */
       template<typename getSizeFunc,
                typename getTypeFunc>
+
+      static void allocateQuadification(size_t numGeometries,
+                                        const getSizeFunc& getSize,
+                                        const getTypeFunc& getType,
+                                        const uint32_t* pairingGeomIDs,
+                                        ovector<uint16_t>& data_o,
+                                        std::vector<uint16_t*>& quadification_o)
+      {
+        auto sharesPairing = [&](size_t geomID) {
+          return pairingGeomIDs && pairingGeomIDs[geomID] != geomID;
+        };
+
+        size_t numTriangles = 0;
+        for (size_t geomID=0; geomID<numGeometries; geomID++)
+        {
+          const uint32_t N = getSize(geomID);
+          if (N == 0 || getType(geomID) != QBVH6BuilderSAH::TRIANGLE || sharesPairing(geomID)) continue;
+          numTriangles += N;
+        }
+
+        data_o.resize(numTriangles);
+        quadification_o.resize(numGeometries,nullptr);
+
+        size_t ofs = 0;
+        for (size_t geomID=0; geomID<numGeometries; geomID++)
+        {
+          const uint32_t N = getSize(geomID);
+          if (N == 0 || getType(geomID) != QBVH6BuilderSAH::TRIANGLE) continue;
+
+          if (sharesPairing(geomID)) {
+            assert(pairingGeomIDs[geomID] < geomID);
+            quadification_o[geomID] = quadification_o[pairingGeomIDs[geomID]];
+            continue;
+          }
+
+          quadification_o[geomID] = data_o.data() + ofs;
+          ofs += N;
+        }
+        assert(ofs == numTriangles);
+      }
+
+      /* pairs triangles exactly like the build does and returns the number of resulting quads */
+      template<typename getSizeFunc,
+               typename getTypeFunc,
+               typename getTriangleIndicesFunc>
+      
+      static size_t countTriangleQuads(size_t numGeometries,
+                                       const getSizeFunc& getSize,
+                                       const getTypeFunc& getType,
+                                       const getTriangleIndicesFunc& getTriangleIndices)
+      {
+        ovector<uint16_t> quadificationData;
+        std::vector<uint16_t*> quadification;
+        allocateQuadification(numGeometries,getSize,getType,nullptr,quadificationData,quadification);
+
+        /* has to use same partitioning as the build, as triangles never get paired across tasks */
+        ParallelForForPrefixSumState<size_t> pstate;
+        pstate.init(numGeometries,getSize,size_t(1024));
+        return parallel_for_for_prefix_sum0_( pstate, size_t(1), getSize, size_t(0), [&](size_t geomID, const range<size_t>& r, size_t k) -> size_t {
+          if (getType(geomID) == QBVH6BuilderSAH::TRIANGLE)
+            return pair_triangles(geomID,(QuadifierType*) quadification[geomID], r.begin(), r.end(), getTriangleIndices);
+          else
+            return 0;
+        }, [](const size_t a, const size_t b) -> size_t { return a+b; });
+      }
+
+      template<typename getSizeFunc,
+               typename getTypeFunc,
+               typename getTriangleIndicesFunc>
        
       static void estimateSize(size_t numGeometries,
                                const getSizeFunc& getSize,
                                const getTypeFunc& getType,
+                               const getTriangleIndicesFunc& getTriangleIndices,
                                ze_rtas_format_exp_t rtas_format,
                                ze_rtas_builder_build_quality_hint_exp_t build_quality,
                                ze_rtas_builder_build_op_exp_flags_t build_flags,
+                               bool quadify,
                                size_t& expectedBytes,
                                size_t& worstCaseBytes,
                                size_t& scratchBytes)
@@ -1286,14 +2665,36 @@ namespace embree
           case QBVH6BuilderSAH::INSTANCE  : stats.numInstances += numPrimitives; break;
           };
         }
-        
-        if (useSpatialSplits(build_quality,build_flags))
-          stats.estimate_presplits(1.2);
-        
-        worstCaseBytes = stats.worst_case_bvh_bytes();
+
+        /* the build stores one primref per input primitive in the scratch buffer, presplits only fill up that array */
+        const size_t numPrimitives = stats.size();
         scratchBytes = stats.scratch_space_bytes();
-        stats.estimate_quadification();
-        expectedBytes = stats.expected_bvh_bytes();
+
+        /* count real number of quads to get tight bounds */
+        if (quadify)
+        {
+          stats.set_quadification(countTriangleQuads(numGeometries,getSize,getType,getTriangleIndices));
+          
+          if (useSpatialSplits(build_quality,build_flags))
+            stats.add_presplits(numPrimitives-stats.size());
+
+          worstCaseBytes = stats.worst_case_bvh_bytes();
+          expectedBytes = stats.expected_bvh_bytes();
+        }
+        else
+        {
+          if (useSpatialSplits(build_quality,build_flags))
+            stats.estimate_presplits(1.2);
+        
+          worstCaseBytes = stats.worst_case_bvh_bytes();
+          stats.estimate_quadification();
+          expectedBytes = stats.expected_bvh_bytes();
+        }
+
+        if (build_flags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS) {
+          worstCaseBytes += Stats::back_pointer_bytes(worstCaseBytes);
+          expectedBytes += Stats::back_pointer_bytes(expectedBytes);
+        }
       }      
 
        template<typename getSizeFunc,
@@ -1322,16 +2723,21 @@ namespace embree
                           ze_rtas_format_exp_t rtas_format,
                           ze_rtas_builder_build_quality_hint_exp_t build_quality,
                           ze_rtas_builder_build_op_exp_flags_t build_flags,
+                          const RayDistribution* rayDistribution,
+                          const uint32_t* pairingGeomIDs,
                           bool verbose,
+                          BuildStatistics* statistics,
+                          BuildTracer* tracer,
                           void* dispatchGlobalsPtr)
       {
-        /* align scratch buffer to 64 bytes */
-        bool scratchAligned = std::align(64,0,scratch_ptr,scratch_bytes);
-        if (!scratchAligned)
+        /* align scratch buffer to 64 bytes, it is optional when the primrefs get placed into the acceleration structure buffer */
+        if (scratch_ptr == nullptr)
+          scratch_bytes = 0;
+        else if (!std::align(64,0,scratch_ptr,scratch_bytes))
           throw std::runtime_error("scratch buffer cannot get aligned");
     
         BuilderT<getSizeFunc, getTypeFunc, createPrimRefArrayFunc, getTriangleFunc, getTriangleIndicesFunc, getQuadFunc, getProceduralFunc, getInstanceFunc> builder
-          (device, getSize, getType, createPrimRefArray, getTriangle, getTriangleIndices, getQuad, getProcedural, getInstance, scratch_ptr, scratch_bytes, rtas_format, build_quality, build_flags, verbose);
+          (device, getSize, getType, createPrimRefArray, getTriangle, getTriangleIndices, getQuad, getProcedural, getInstance, scratch_ptr, scratch_bytes, rtas_format, build_quality, build_flags, rayDistribution, pairingGeomIDs, verbose, statistics, tracer);
         
         return builder.build(numGeometries, accel_ptr, accel_bytes, boundsOut, accelBufferBytesOut, dispatchGlobalsPtr);
       }
@@ -0,0 +1,614 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "qbvh6_traversal.h"
+
+#include <vector>
+
+namespace embree
+{
+  namespace
+  {
+    typedef Vec3<vfloat4> Vec3vf4;
+
+    /* ray/box test against dequantized child bounds */
+    __forceinline bool intersectBox(const BBox3f& box, const Vec3f& org, const Vec3f& rdir, float tnear, float tfar, float& dist)
+    {
+      const Vec3f t0 = (box.lower - org) * rdir;
+      const Vec3f t1 = (box.upper - org) * rdir;
+      const float tmin = max(tnear, min(t0.x,t1.x), min(t0.y,t1.y), min(t0.z,t1.z));
+      const float tmax = min(tfar , max(t0.x,t1.x), max(t0.y,t1.y), max(t0.z,t1.z));
+      dist = tmin;
+      return tmin <= tmax;
+    }
+
+    /* Ray/box test of four children using the SIMD wrappers. The
+     * quantized bounds are read from the padded copy q of the six
+     * quantized bound arrays, starting at child i. */
+    __forceinline size_t intersectChildren4(const unsigned char* q, size_t i, const Vec3vf4& scale, const Vec3vf4& base,
+                                            const Vec3vf4& org, const Vec3vf4& rdir, const vfloat4& tnear, const vfloat4& tfar, float* dist)
+    {
+      const size_t N = QBVH6::InternalNode6::NUM_CHILDREN;
+      const vint4 qlower_x = vint4::load(q+0*N+i);
+      const vint4 qupper_x = vint4::load(q+1*N+i);
+      const vboolf4 valid = ((qlower_x & 0x80) == vint4(zero)) | ((qupper_x & 0x80) != vint4(zero));
+
+      const vfloat4 lower_x = madd(vfloat4(qlower_x), scale.x, base.x);
+      const vfloat4 upper_x = madd(vfloat4(qupper_x), scale.x, base.x);
+      const vfloat4 lower_y = madd(vfloat4::load(q+2*N+i), scale.y, base.y);
+      const vfloat4 upper_y = madd(vfloat4::load(q+3*N+i), scale.y, base.y);
+      const vfloat4 lower_z = madd(vfloat4::load(q+4*N+i), scale.z, base.z);
+      const vfloat4 upper_z = madd(vfloat4::load(q+5*N+i), scale.z, base.z);
+
+      const vfloat4 t0_x = (lower_x - org.x) * rdir.x, t1_x = (upper_x - org.x) * rdir.x;
+      const vfloat4 t0_y = (lower_y - org.y) * rdir.y, t1_y = (upper_y - org.y) * rdir.y;
+      const vfloat4 t0_z = (lower_z - org.z) * rdir.z, t1_z = (upper_z - org.z) * rdir.z;
+      const vfloat4 tmin = max(tnear, min(t0_x,t1_x), min(t0_y,t1_y), min(t0_z,t1_z));
+      const vfloat4 tmax = min(tfar , max(t0_x,t1_x), max(t0_y,t1_y), max(t0_z,t1_z));
+      vfloat4::storeu(dist+i, tmin);
+      return movemask(valid & (tmin <= tmax)) << i;
+    }
+
+    /* Ray/box test of all six children of an internal node. The
+     * quantized bounds get copied into a padded buffer as the SIMD
+     * loads may read up to 16 bytes past the last child. Two passes
+     * over children 0-3 and 2-5 cover all children. */
+    __forceinline uint32_t intersectNodeSIMD(const QBVH6::InternalNode6* qnode, const Vec3f& org, const Vec3f& rdir, float tnear, float tfar, float* dist)
+    {
+      const size_t N = QBVH6::InternalNode6::NUM_CHILDREN;
+      unsigned char q[6*N+16];
+      memcpy(q, qnode->lower_x, 6*N);
+
+      const Vec3vf4 scale(ldexpf(1.0f, qnode->exp_x-8), ldexpf(1.0f, qnode->exp_y-8), ldexpf(1.0f, qnode->exp_z-8));
+      const Vec3vf4 base(qnode->lower.x, qnode->lower.y, qnode->lower.z);
+      const Vec3vf4 vorg(org.x, org.y, org.z);
+      const Vec3vf4 vrdir(rdir.x, rdir.y, rdir.z);
+
+      size_t mask = intersectChildren4(q, 0, scale, base, vorg, vrdir, vfloat4(tnear), vfloat4(tfar), dist);
+      mask |= intersectChildren4(q, N-4, scale, base, vorg, vrdir, vfloat4(tnear), vfloat4(tfar), dist);
+      return (uint32_t) mask;
+    }
+
+    /* reciprocal of the ray direction that never produces a NaN in the box test */
+    __forceinline Vec3f safeRcp(const Vec3f& dir)
+    {
+      const float eps = 1E-18f;
+      const float x = abs(dir.x) < eps ? (dir.x < 0.0f ? -eps : eps) : dir.x;
+      const float y = abs(dir.y) < eps ? (dir.y < 0.0f ? -eps : eps) : dir.y;
+      const float z = abs(dir.z) < eps ? (dir.z < 0.0f ? -eps : eps) : dir.z;
+      return Vec3f(1.0f/x, 1.0f/y, 1.0f/z);
+    }
+
+    /* Ray/triangle test using edge functions. The u barycentric
+     * weights the second vertex and the v barycentric the third
+     * vertex. The triangle is front facing if its vertices appear
+     * clockwise when looking along the ray. */
+    __forceinline bool intersectTriangle(const TraversalRay& ray, float tfar, const Vec3f& tri_v0, const Vec3f& tri_v1, const Vec3f& tri_v2,
+                                         float& t_o, float& u_o, float& v_o, bool& frontFace_o)
+    {
+      /* calculate vertices relative to ray origin */
+      const Vec3f v0 = tri_v0 - ray.org;
+      const Vec3f v1 = tri_v1 - ray.org;
+      const Vec3f v2 = tri_v2 - ray.org;
+
+      /* calculate triangle edges */
+      const Vec3f e0 = v2 - v0;
+      const Vec3f e1 = v0 - v1;
+      const Vec3f e2 = v1 - v2;
+
+      /* perform edge tests */
+      const float U = dot(cross(e0,v2+v0),ray.dir);
+      const float V = dot(cross(e1,v0+v1),ray.dir);
+      const float W = dot(cross(e2,v1+v2),ray.dir);
+      const float UVW = U+V+W;
+      if (!(min(U,V,W) >= -0.0f || max(U,V,W) <= 0.0f))
+        return false;
+
+      /* calculate geometry normal and denominator */
+      const Vec3f Ng = cross(e2,e1);
+      const float den = 2.0f*dot(Ng,ray.dir);
+      if (den == 0.0f || UVW == 0.0f)
+        return false;
+
+      /* perform depth test */
+      const float T = 2.0f*dot(v0,Ng);
+      const float t = T/den;
+      if (!(ray.tnear <= t && t <= tfar))
+        return false;
+
+      t_o = t;
+      u_o = U/UVW;
+      v_o = V/UVW;
+      frontFace_o = den > 0.0f;
+      return true;
+    }
+
+    /* Resolves the stops of a ray query using the any-hit and
+     * intersect functions of the traversal. Non-opaque triangles
+     * without an any-hit function get committed, procedurals without
+     * an intersect function never produce a hit. */
+    void resolve(const QBVH6Traversal& traversal, QBVH6RayQuery& query)
+    {
+      while (query.proceed())
+      {
+        TraversalHit& potentialHit = query.potentialHit();
+        const TraversalRay& ray = query.ray(potentialHit.bvhLevel);
+
+        if (potentialHit.candidate == TRAVERSAL_CANDIDATE_TRIANGLE)
+        {
+          if (!traversal.anyHit || traversal.anyHit(traversal.userPtr, ray, potentialHit))
+            query.commit();
+          continue;
+        }
+
+        if (!traversal.intersectProcedural)
+          continue;
+
+        const float tfar = query.committedHit().t;
+        TraversalRay localRay = ray;
+        localRay.tfar = tfar;
+        if (!traversal.intersectProcedural(traversal.userPtr, localRay, potentialHit))
+          continue;
+
+        if (ray.tnear <= potentialHit.t && potentialHit.t <= tfar)
+          query.commit();
+      }
+    }
+  }
+
+  QBVH6RayQuery::QBVH6RayQuery (const TraversalRay& ray, TraversalMode mode)
+    : stackPtr(0), inst(nullptr), level(0), done(false), mode(mode)
+  {
+    rays[0] = ray;
+    rdirs[0] = safeRcp(ray.dir);
+    committed.t = ray.tfar;
+  }
+
+  void QBVH6RayQuery::push(const StackEntry& entry)
+  {
+    if (stackPtr >= QBVH6Traversal::MAX_STACK_DEPTH)
+      throw std::runtime_error("traversal stack overflow");
+    stack[stackPtr++] = entry;
+  }
+
+  void QBVH6RayQuery::push(QBVH6::Node node, float tnear) {
+    push({ node.node, tnear, (uint8_t) node.type, node.cur_prim, 0, false, nullptr });
+  }
+
+  void QBVH6RayQuery::forward(uint32_t bvhLevel, QBVH6::Node root, const TraversalRay& ray)
+  {
+    if (bvhLevel == 0 || bvhLevel >= QBVH6Traversal::MAX_BVH_LEVELS)
+      throw std::runtime_error("invalid BVH level");
+
+    rays[bvhLevel] = ray;
+    rdirs[bvhLevel] = safeRcp(ray.dir);
+    level = bvhLevel;
+    inst = nullptr;
+    push({ root.node, ray.tnear, (uint8_t) root.type, root.cur_prim, (uint8_t) bvhLevel, false, nullptr });
+  }
+
+  bool QBVH6RayQuery::proceed()
+  {
+    while (stackPtr && !done)
+    {
+      const StackEntry cur = stack[--stackPtr];
+
+      /* skip nodes that are further away than the closest hit */
+      if (cur.tnear > committed.t)
+        continue;
+
+      /* switch to the BVH level of the node */
+      if (cur.bvhLevel != level || cur.inst != inst)
+        setLevel(cur.bvhLevel, cur.inst);
+
+      const QBVH6::Node node(cur.node, (NodeType) cur.type, cur.curPrim);
+      switch (node.type)
+      {
+      case NODE_TYPE_INTERNAL:
+      {
+        counters.numInternalNodes++;
+        const QBVH6::InternalNode6* qnode = node.innerNode<QBVH6::InternalNode6>();
+        if ((qnode->nodeMask & rays[level].mask) == 0)
+          break;
+
+        /* intersect all children and push hit children far to near onto the stack */
+        float dist[QBVH6::InternalNode6::NUM_CHILDREN];
+        uint32_t mask = intersectNode(qnode, level, dist);
+
+        StackEntry children[QBVH6::InternalNode6::NUM_CHILDREN];
+        size_t numChildren = 0;
+        while (mask)
+        {
+          const uint32_t i = bscf(mask);
+          const QBVH6::Node child = qnode->child(i);
+          size_t j = numChildren++;
+          for (; j>0 && children[j-1].tnear < dist[i]; j--)
+            children[j] = children[j-1];
+          children[j] = { child.node, dist[i], (uint8_t) child.type, child.cur_prim, (uint8_t) level, false, inst };
+        }
+
+        for (size_t i=0; i<numChildren; i++)
+          push(children[i]);
+        break;
+      }
+      case NODE_TYPE_INSTANCE:
+      {
+        const InstanceLeaf* leaf = enterInstance(node);
+        if (!leaf) break;
+
+        const QBVH6::Node root(leaf->part0.startNodePtr);
+        push({ root.node, cur.tnear, (uint8_t) root.type, root.cur_prim, (uint8_t) (level+1), false, leaf });
+        break;
+      }
+      case NODE_TYPE_QUAD:
+        if (intersectQuads(node, cur.resume))
+          return true;
+        break;
+
+      case NODE_TYPE_PROCEDURAL:
+        if (intersectProcedurals(node, cur.resume))
+          return true;
+        break;
+
+      default:
+        throw std::runtime_error("invalid node type");
+      }
+    }
+    return false;
+  }
+
+  uint32_t QBVH6RayQuery::intersectNode(const QBVH6::InternalNode6* qnode, uint32_t bvhLevel, float* dist) const
+  {
+    const TraversalRay& ray = rays[bvhLevel];
+    if (mode == TRAVERSAL_MODE_SIMD)
+      return intersectNodeSIMD(qnode, ray.org, rdirs[bvhLevel], ray.tnear, committed.t, dist);
+
+    uint32_t mask = 0;
+    for (uint32_t i=0; i<QBVH6::InternalNode6::NUM_CHILDREN; i++)
+    {
+      if (!qnode->valid(i)) continue;
+      if (intersectBox(qnode->bounds(i), ray.org, rdirs[bvhLevel], ray.tnear, committed.t, dist[i]))
+        mask |= 1 << i;
+    }
+    return mask;
+  }
+
+  /* returns the instance leaf if the ray has to enter the instance, and nullptr otherwise */
+  const InstanceLeaf* QBVH6RayQuery::enterInstance(QBVH6::Node node)
+  {
+    counters.numLeaves++;
+    const InstanceLeaf* leaf = node.leafNodeInstance();
+    if ((leaf->part0.geomMask & rays[level].mask) == 0)
+      return nullptr;
+
+    /* the hardware supports only a single level of instancing */
+    if (level+1 >= QBVH6Traversal::MAX_BVH_LEVELS)
+      return nullptr;
+
+    counters.numInstances++;
+    return leaf;
+  }
+
+  /* Switches to the BVH level of a node. The ray of a hardware
+   * instance gets transformed from the previous level, the ray of a
+   * software instance got forwarded already. */
+  void QBVH6RayQuery::setLevel(uint32_t bvhLevel, const InstanceLeaf* inst_in)
+  {
+    level = bvhLevel;
+    inst = inst_in;
+    if (!inst) return;
+
+    const AffineSpace3f world2obj = inst->World2Obj();
+    rays[level] = rays[level-1];
+    rays[level].org = xfmPoint(world2obj, rays[level-1].org);
+    rays[level].dir = xfmVector(world2obj, rays[level-1].dir);
+    rdirs[level] = safeRcp(rays[level].dir);
+  }
+
+  /* calculates if a primitive is treated as opaque, instance flags override geometry flags and ray flags override both */
+  bool QBVH6RayQuery::isOpaque(GeometryFlags gflags) const
+  {
+    bool opaque = gflags & GeometryFlags::OPAQUE;
+    if (inst)
+    {
+      const InstanceFlags iflags((uint8_t)inst->part0.instFlags);
+      if (iflags.force_opaque)     opaque = true;
+      if (iflags.force_non_opaque) opaque = false;
+    }
+    const uint32_t flags = rays[level].flags;
+    if (flags & RAY_FLAGS_FORCE_OPAQUE)     opaque = true;
+    if (flags & RAY_FLAGS_FORCE_NON_OPAQUE) opaque = false;
+    return opaque;
+  }
+
+  /* checks if a primitive of the given opacity is culled */
+  bool QBVH6RayQuery::isOpacityCulled(bool opaque) const
+  {
+    const uint32_t flags = rays[level].flags;
+    if (opaque  && (flags & RAY_FLAGS_CULL_OPAQUE))     return true;
+    if (!opaque && (flags & RAY_FLAGS_CULL_NON_OPAQUE)) return true;
+    return false;
+  }
+
+  /* fills the fields of the potential hit that are shared by all primitive types */
+  void QBVH6RayQuery::initPotentialHit(TraversalCandidateType candidate, const PrimLeafDesc& desc, const void* leaf, uint32_t leafIndex, uint32_t primID, bool opaque)
+  {
+    potential = TraversalHit();
+    potential.candidate = candidate;
+    potential.bvhLevel = level;
+    potential.opaque = opaque;
+    potential.geomID = desc.geomIndex;
+    potential.primID = primID;
+    potential.primLeafPtr = leaf;
+    potential.primLeafIndex = leafIndex;
+    potential.instLeafPtr = inst;
+    if (inst) {
+      potential.instID = inst->part1.instanceIndex;
+      potential.instUserID = inst->part1.instanceID;
+    }
+  }
+
+  void QBVH6RayQuery::commit()
+  {
+    committed = potential;
+    committed.valid = true;
+    if (rays[0].flags & RAY_FLAGS_ACCEPT_FIRST_HIT_AND_END_SEARCH)
+      done = true;
+  }
+
+  /* Intersects a list of quad leaves starting at triangle node.cur_prim
+   * of the first quad. Opaque hits get committed right away. At a
+   * non-opaque hit the rest of the list gets pushed onto the stack and
+   * traversal stops. */
+  bool QBVH6RayQuery::intersectQuads(QBVH6::Node node, bool resume)
+  {
+    if (!resume) counters.numLeaves++;
+    const TraversalRay& ray = rays[level];
+    if (ray.flags & RAY_FLAGS_SKIP_TRIANGLES)
+      return false;
+
+    bool cullDisable = false;
+    bool frontCCW = false;
+    if (inst)
+    {
+      const InstanceFlags iflags((uint8_t)inst->part0.instFlags);
+      cullDisable = iflags.triangle_cull_disable;
+      frontCCW = iflags.triangle_front_counterclockwise;
+    }
+
+    uint32_t first = node.cur_prim;
+    bool last = false;
+    do
+    {
+      const QuadLeaf* quad = node.leafNodeQuad();
+      node.node += sizeof(QuadLeaf);
+      last = quad->isLast();
+
+      const uint32_t begin = first;
+      first = 0;
+
+      if ((quad->leafDesc.geomMask & ray.mask) == 0)
+        continue;
+
+      const bool opaque = isOpaque(quad->leafDesc.getGeomFlags());
+      if (isOpacityCulled(opaque))
+        continue;
+
+      for (uint32_t i=begin; i<quad->size() && !done; i++)
+      {
+        const Vec3f v0 = i == 0 ? quad->v0 : quad->vertex(quad->j0);
+        const Vec3f v1 = i == 0 ? quad->v1 : quad->vertex(quad->j1);
+        const Vec3f v2 = i == 0 ? quad->v2 : quad->vertex(quad->j2);
+
+        counters.numTriangles++;
+        float t, u, v; bool frontFace;
+        if (!intersectTriangle(ray, committed.t, v0, v1, v2, t, u, v, frontFace))
+          continue;
+
+        if (frontCCW) frontFace = !frontFace;
+        if (!cullDisable && frontFace  && (ray.flags & RAY_FLAGS_CULL_FRONT_FACING_TRIANGLES)) continue;
+        if (!cullDisable && !frontFace && (ray.flags & RAY_FLAGS_CULL_BACK_FACING_TRIANGLES))  continue;
+
+        initPotentialHit(TRAVERSAL_CANDIDATE_TRIANGLE, quad->leafDesc, quad, i, quad->primIndex(i), opaque);
+        potential.t = t;
+        potential.u = u;
+        potential.v = v;
+        potential.frontFace = frontFace;
+
+        if (opaque) {
+          commit();
+          continue;
+        }
+
+        /* continue with the next triangle after the caller decided about the potential hit */
+        if (i+1 < quad->size())
+          push({ (char*) quad, -float(inf), NODE_TYPE_QUAD, (uint8_t) (i+1), (uint8_t) level, true, inst });
+        else if (!last)
+          push({ node.node, -float(inf), NODE_TYPE_QUAD, 0, (uint8_t) level, true, inst });
+        return true;
+      }
+
+    } while (!last && !done);
+
+    return false;
+  }
+
+  /* Visits a list of procedural primitives starting at slot
+   * node.cur_prim. Each primitive that is not culled pushes the rest
+   * of the list onto the stack and stops traversal. */
+  bool QBVH6RayQuery::intersectProcedurals(QBVH6::Node node, bool resume)
+  {
+    if (!resume) counters.numLeaves++;
+    const TraversalRay& ray = rays[level];
+    if (ray.flags & RAY_FLAGS_SKIP_PROCEDURAL_PRIMITIVES)
+      return false;
+
+    bool last = false;
+    uint32_t currPrim = node.cur_prim;
+    do
+    {
+      const ProceduralLeaf* leaf = node.leafNodeProcedural();
+      last = leaf->isLast(currPrim);
+      const uint32_t slot = currPrim;
+
+      if (++currPrim >= leaf->size()) {
+        currPrim = 0;
+        node.node += sizeof(ProceduralLeaf);
+      }
+
+      if ((leaf->leafDesc.geomMask & ray.mask) == 0)
+        continue;
+
+      const bool opaque = isOpaque(leaf->leafDesc.getGeomFlags());
+      if (leaf->leafDesc.opaqueCullingEnabled() && isOpacityCulled(opaque))
+        continue;
+
+      counters.numProcedurals++;
+      if (!last)
+        push({ node.node, -float(inf), NODE_TYPE_PROCEDURAL, (uint8_t) currPrim, (uint8_t) level, true, inst });
+
+      initPotentialHit(TRAVERSAL_CANDIDATE_PROCEDURAL, leaf->leafDesc, leaf, slot, leaf->primIndex(slot), opaque);
+      potential.t = committed.t;
+      return true;
+
+    } while (!last);
+
+    return false;
+  }
+
+  namespace
+  {
+    /* entry of the stream traversal stack */
+    struct StreamStackEntry
+    {
+      QBVH6::Node node;    // node to traverse
+      float tnear;         // smallest entry distance of the node bounds over all rays
+      uint64_t rayMask;    // rays that have to traverse the node
+    };
+
+    /* Traverses up to MAX_STREAM_SIZE rays through the top level BVH
+     * together. Each ray keeps its own ray query which performs the
+     * node and leaf tests, the stream only shares the node visits. */
+    void traverseStream(const QBVH6Traversal& traversal, const TraversalRay* rays, TraversalHit* hits, size_t numRays, uint32_t rayFlags, TraversalStats& stats)
+    {
+      assert(numRays <= QBVH6Traversal::MAX_STREAM_SIZE);
+      std::vector<QBVH6RayQuery> queries;
+      queries.reserve(numRays);
+
+      for (size_t i=0; i<numRays; i++)
+      {
+        TraversalRay ray = rays[i];
+        ray.flags |= rayFlags;
+        queries.emplace_back(ray, traversal.mode);
+      }
+
+      StreamStackEntry stack[QBVH6Traversal::MAX_STACK_DEPTH];
+      size_t stackPtr = 0;
+      const uint64_t allRays = numRays == 64 ? uint64_t(-1) : (uint64_t(1) << numRays) - 1;
+      stack[stackPtr++] = { traversal.bvh->root(), -float(inf), allRays };
+
+      while (stackPtr)
+      {
+        const StreamStackEntry cur = stack[--stackPtr];
+        QBVH6::Node node = cur.node;
+
+        /* each ray traverses the leaf and the subtree of an instance on its own */
+        if (node.type != NODE_TYPE_INTERNAL)
+        {
+          for (size_t rayMask = cur.rayMask; rayMask; )
+          {
+            QBVH6RayQuery& query = queries[bscf(rayMask)];
+            if (query.isDone()) continue;
+            query.push(node, -float(inf));
+            resolve(traversal, query);
+          }
+          continue;
+        }
+
+        /* intersect the children with all active rays and gather the rays that hit each child */
+        const QBVH6::InternalNode6* qnode = node.innerNode<QBVH6::InternalNode6>();
+        uint64_t childRays[QBVH6::InternalNode6::NUM_CHILDREN] = { 0 };
+        float childDist[QBVH6::InternalNode6::NUM_CHILDREN];
+        for (auto& d : childDist) d = inf;
+
+        for (size_t rayMask = cur.rayMask; rayMask; )
+        {
+          const size_t r = bscf(rayMask);
+          const QBVH6RayQuery& query = queries[r];
+          if (query.isDone() || cur.tnear > query.committedHit().t)
+            continue;
+
+          stats.numInternalNodes++;
+          if ((qnode->nodeMask & query.ray().mask) == 0)
+            continue;
+
+          float dist[QBVH6::InternalNode6::NUM_CHILDREN];
+          uint32_t mask = query.intersectNode(qnode, 0, dist);
+          while (mask)
+          {
+            const uint32_t i = bscf(mask);
+            childRays[i] |= uint64_t(1) << r;
+            childDist[i] = min(childDist[i], dist[i]);
+          }
+        }
+
+        /* push children hit by any ray far to near onto the stack */
+        StreamStackEntry children[QBVH6::InternalNode6::NUM_CHILDREN];
+        size_t numChildren = 0;
+        for (uint32_t i=0; i<QBVH6::InternalNode6::NUM_CHILDREN; i++)
+        {
+          if (!childRays[i]) continue;
+          size_t j = numChildren++;
+          for (; j>0 && children[j-1].tnear < childDist[i]; j--)
+            children[j] = children[j-1];
+          children[j] = { qnode->child(i), childDist[i], childRays[i] };
+        }
+
+        if (stackPtr + numChildren > QBVH6Traversal::MAX_STACK_DEPTH)
+          throw std::runtime_error("traversal stack overflow");
+
+        for (size_t i=0; i<numChildren; i++)
+          stack[stackPtr++] = children[i];
+      }
+
+      for (size_t i=0; i<numRays; i++)
+      {
+        hits[i] = queries[i].committedHit();
+        stats += queries[i].stats();
+      }
+    }
+  }
+
+  bool QBVH6Traversal::intersect(const TraversalRay& ray, TraversalHit& hit, TraversalStats* stats) const
+  {
+    QBVH6RayQuery query(ray, mode);
+    query.push(bvh->root(), ray.tnear);
+    resolve(*this, query);
+    hit = query.committedHit();
+    if (stats) *stats = query.stats();
+    return hit.valid;
+  }
+
+  bool QBVH6Traversal::occluded(const TraversalRay& ray_in, TraversalHit& hit, TraversalStats* stats) const
+  {
+    TraversalRay ray = ray_in;
+    ray.flags |= RAY_FLAGS_ACCEPT_FIRST_HIT_AND_END_SEARCH;
+    return intersect(ray, hit, stats);
+  }
+
+  void QBVH6Traversal::intersectStream(const TraversalRay* rays, TraversalHit* hits, size_t numRays, TraversalStats* stats_o) const
+  {
+    TraversalStats stats;
+    for (size_t i=0; i<numRays; i+=MAX_STREAM_SIZE)
+      traverseStream(*this, rays+i, hits+i, min(numRays-i, MAX_STREAM_SIZE), RAY_FLAGS_NONE, stats);
+    if (stats_o) *stats_o = stats;
+  }
+
+  void QBVH6Traversal::occludedStream(const TraversalRay* rays, TraversalHit* hits, size_t numRays, TraversalStats* stats_o) const
+  {
+    TraversalStats stats;
+    for (size_t i=0; i<numRays; i+=MAX_STREAM_SIZE)
+      traverseStream(*this, rays+i, hits+i, min(numRays-i, MAX_STREAM_SIZE), RAY_FLAGS_ACCEPT_FIRST_HIT_AND_END_SEARCH, stats);
+    if (stats_o) *stats_o = stats;
+  }
+}
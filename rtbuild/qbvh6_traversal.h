@@ -0,0 +1,266 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "qbvh6.h"
+
+namespace embree
+{
+  /*
+
+    Host side reference traversal of the QBVH6 format. The traversal
+    decodes the data structures the same way the hardware does and can
+    be used to validate acceleration structures and to measure BVH
+    quality without a GPU.
+
+   */
+
+  /* ray flags, the values match the intel_ray_flags_t of the ray query API */
+  enum RayFlags : uint32_t
+  {
+    RAY_FLAGS_NONE = 0x00,
+    RAY_FLAGS_FORCE_OPAQUE = 0x01,                      // forces geometry to be opaque (no anyhit shader invokation)
+    RAY_FLAGS_FORCE_NON_OPAQUE = 0x02,                  // forces geometry to be non-opqaue (invoke anyhit shader)
+    RAY_FLAGS_ACCEPT_FIRST_HIT_AND_END_SEARCH = 0x04,   // terminates traversal on the first hit found (shadow rays)
+    RAY_FLAGS_SKIP_CLOSEST_HIT_SHADER = 0x08,           // skip execution of the closest hit shader
+    RAY_FLAGS_CULL_BACK_FACING_TRIANGLES = 0x10,        // back facing triangles to not produce a hit
+    RAY_FLAGS_CULL_FRONT_FACING_TRIANGLES = 0x20,       // front facing triangles do not produce a hit
+    RAY_FLAGS_CULL_OPAQUE = 0x40,                       // opaque geometry does not produce a hit
+    RAY_FLAGS_CULL_NON_OPAQUE = 0x80,                   // non-opaque geometry does not produce a hit
+    RAY_FLAGS_SKIP_TRIANGLES = 0x100,                   // treat all triangle intersections as misses.
+    RAY_FLAGS_SKIP_PROCEDURAL_PRIMITIVES = 0x200,       // skip execution of intersection shaders
+  };
+
+  /* ray as passed to traversal */
+  struct TraversalRay
+  {
+    TraversalRay () {}
+
+    TraversalRay (const Vec3f& org, const Vec3f& dir, float tnear = 0.0f, float tfar = inf, uint32_t mask = 0xFF, uint32_t flags = RAY_FLAGS_NONE)
+      : org(org), dir(dir), tnear(tnear), tfar(tfar), mask(mask), flags(flags) {}
+
+  public:
+    Vec3f org;       // ray origin
+    Vec3f dir;       // ray direction
+    float tnear;     // start of ray segment
+    float tfar;      // end of ray segment
+    uint32_t mask;   // 8-bit ray mask, tested against node, geometry, and instance masks
+    uint32_t flags;  // some combination of RayFlags
+  };
+
+  /* type of primitive that got hit */
+  enum TraversalCandidateType : uint32_t
+  {
+    TRAVERSAL_CANDIDATE_TRIANGLE = 0,
+    TRAVERSAL_CANDIDATE_PROCEDURAL = 1
+  };
+
+  /* hit information reported by traversal */
+  struct TraversalHit
+  {
+    static const uint32_t INVALID_ID = 0xFFFFFFFF;
+
+    TraversalHit ()
+      : valid(false), frontFace(false), opaque(false), bvhLevel(0), candidate(TRAVERSAL_CANDIDATE_TRIANGLE),
+        t(inf), u(0.0f), v(0.0f), geomID(INVALID_ID), primID(INVALID_ID), instID(INVALID_ID), instUserID(INVALID_ID),
+        primLeafPtr(nullptr), primLeafIndex(0), instLeafPtr(nullptr) {}
+
+  public:
+    bool valid;                        // true if there is a hit
+    bool frontFace;                    // true if the front face of a triangle got hit
+    bool opaque;                       // true if the primitive is treated as opaque
+    uint32_t bvhLevel;                 // instancing level of the hit
+    TraversalCandidateType candidate;  // triangle or procedural hit
+    float t;                           // hit distance
+    float u, v;                        // barycentric hit coordinates
+    uint32_t geomID;                   // geometry index of the hit primitive
+    uint32_t primID;                   // primitive index of the hit primitive
+    uint32_t instID;                   // geometry index of the instance, or INVALID_ID
+    uint32_t instUserID;               // user ID of the instance, or INVALID_ID
+    const void* primLeafPtr;           // quad or procedural leaf that contains the hit primitive
+    uint32_t primLeafIndex;            // triangle inside the quad leaf or slot inside the procedural leaf
+    const InstanceLeaf* instLeafPtr;   // instance leaf of the hit, or nullptr
+  };
+
+  /* per ray traversal counters */
+  struct TraversalStats
+  {
+    TraversalStats ()
+      : numInternalNodes(0), numLeaves(0), numTriangles(0), numProcedurals(0), numInstances(0) {}
+
+    TraversalStats& operator+= (const TraversalStats& other)
+    {
+      numInternalNodes += other.numInternalNodes;
+      numLeaves += other.numLeaves;
+      numTriangles += other.numTriangles;
+      numProcedurals += other.numProcedurals;
+      numInstances += other.numInstances;
+      return *this;
+    }
+
+  public:
+    uint64_t numInternalNodes;  // number of internal nodes visited
+    uint64_t numLeaves;         // number of leaves visited
+    uint64_t numTriangles;      // number of ray/triangle tests
+    uint64_t numProcedurals;    // number of procedural primitives reported
+    uint64_t numInstances;      // number of instances entered
+  };
+
+  /* implementation used to intersect the children of internal nodes */
+  enum TraversalMode : uint32_t
+  {
+    TRAVERSAL_MODE_SCALAR = 0,   // scalar reference implementation, decodes one child at a time
+    TRAVERSAL_MODE_SIMD = 1      // dequantizes and tests all six children at once using 4-wide SIMD
+  };
+
+  struct QBVH6Traversal
+  {
+    /* Invoked for triangles that are not opaque. Returning true
+     * commits the potential hit, returning false ignores it. */
+    typedef bool (*AnyHitFunc)(void* userPtr, const TraversalRay& ray, const TraversalHit& potentialHit);
+
+    /* Invoked for procedural primitives with the ray of the current
+     * instancing level. To report a hit the function sets t, u, v
+     * of the potential hit and returns true. */
+    typedef bool (*IntersectFunc)(void* userPtr, const TraversalRay& ray, TraversalHit& potentialHit);
+
+    /* maximal number of nested BVH levels the hardware supports */
+    static const uint32_t MAX_BVH_LEVELS = 2;
+
+    /* maximal depth of the traversal stack */
+    static const uint32_t MAX_STACK_DEPTH = 256;
+
+    /* maximal number of rays traversed together in stream mode */
+    static const size_t MAX_STREAM_SIZE = 64;
+
+    QBVH6Traversal (const QBVH6* bvh, AnyHitFunc anyHit = nullptr, IntersectFunc intersectProcedural = nullptr, void* userPtr = nullptr)
+      : bvh(bvh), anyHit(anyHit), intersectProcedural(intersectProcedural), userPtr(userPtr), mode(TRAVERSAL_MODE_SIMD) {}
+
+    /* Finds the closest hit along the ray. Non-opaque triangles
+     * without an any-hit function get committed, procedurals without
+     * an intersect function never produce a hit. */
+    bool intersect(const TraversalRay& ray, TraversalHit& hit, TraversalStats* stats = nullptr) const;
+
+    /* Finds any hit along the ray by terminating traversal at the first committed hit. */
+    bool occluded(const TraversalRay& ray, TraversalHit& hit, TraversalStats* stats = nullptr) const;
+
+    /* Traverses a stream of rays. Groups of up to MAX_STREAM_SIZE
+     * rays share each visit of a top level node, which amortizes
+     * node decoding for coherent rays. Instances are traversed ray by
+     * ray. Each ray gets the same closest hit as with intersect, the
+     * stats get accumulated over all rays. */
+    void intersectStream(const TraversalRay* rays, TraversalHit* hits, size_t numRays, TraversalStats* stats = nullptr) const;
+
+    /* Finds any hit for each ray of a stream of rays. */
+    void occludedStream(const TraversalRay* rays, TraversalHit* hits, size_t numRays, TraversalStats* stats = nullptr) const;
+
+  public:
+    const QBVH6* bvh;
+    AnyHitFunc anyHit;
+    IntersectFunc intersectProcedural;
+    void* userPtr;
+    TraversalMode mode;
+  };
+
+  /*
+
+    Resumable traversal of a single ray as performed by the ray query
+    API of the hardware. Traversal stops at each potential hit that
+    requires a decision of the caller, which are triangles that are
+    not opaque and procedural primitives. The caller inspects the
+    potential hit, optionally commits it, and proceeds. QBVH6Traversal
+    resolves these stops using its any-hit and intersect functions.
+
+   */
+  struct QBVH6RayQuery
+  {
+    /* initializes the query for the ray without any node to traverse */
+    QBVH6RayQuery (const TraversalRay& ray, TraversalMode mode = TRAVERSAL_MODE_SIMD);
+
+    /* adds a node of the top level BVH to traverse */
+    void push(QBVH6::Node node, float tnear);
+
+    /* Continues traversal with the BVH of a software instance and the
+     * ray transformed into its object space. The subtree gets traversed
+     * at the specified BVH level before traversal returns to the nodes
+     * of the previous levels. */
+    void forward(uint32_t bvhLevel, QBVH6::Node root, const TraversalRay& ray);
+
+    /* Continues traversal. Returns true if traversal stopped at a
+     * potential hit, and false if there is nothing left to traverse. */
+    bool proceed();
+
+    /* Commits the potential hit traversal stopped at. The caller may
+     * have changed its distance and barycentrics before. */
+    void commit();
+
+    /* Intersects the children of an internal node with the ray of the
+     * specified BVH level and the distance of the committed hit. Returns
+     * the mask of hit children and their entry distances. */
+    uint32_t intersectNode(const QBVH6::InternalNode6* qnode, uint32_t bvhLevel, float* dist) const;
+
+    /* the ray of a BVH level, the ray of a hardware instance gets transformed when traversal enters it */
+    const TraversalRay& ray(uint32_t bvhLevel = 0) const {
+      return rays[bvhLevel];
+    }
+
+    /* the potential hit traversal stopped at */
+    TraversalHit& potentialHit() {
+      return potential;
+    }
+
+    /* the closest hit committed so far */
+    const TraversalHit& committedHit() const {
+      return committed;
+    }
+
+    /* returns true if a committed hit terminated traversal */
+    bool isDone() const {
+      return done;
+    }
+
+    /* the counters of all traversal steps so far */
+    const TraversalStats& stats() const {
+      return counters;
+    }
+
+  private:
+    const InstanceLeaf* enterInstance(QBVH6::Node node);
+    void setLevel(uint32_t bvhLevel, const InstanceLeaf* inst);
+    bool isOpaque(GeometryFlags gflags) const;
+    bool isOpacityCulled(bool opaque) const;
+    void initPotentialHit(TraversalCandidateType candidate, const PrimLeafDesc& desc, const void* leaf, uint32_t leafIndex, uint32_t primID, bool opaque);
+    bool intersectQuads(QBVH6::Node node, bool resume);
+    bool intersectProcedurals(QBVH6::Node node, bool resume);
+
+    /* entry of the traversal stack, trivially constructible such that the stack does not get initialized */
+    struct StackEntry
+    {
+      char* node;                 // node to traverse
+      float tnear;                // entry distance of the node bounds
+      uint8_t type;               // type of the node
+      uint8_t curPrim;            // first primitive to intersect in a leaf list
+      uint8_t bvhLevel;           // BVH level the node belongs to
+      bool resume;                // leaf list that got interrupted by a potential hit
+      const InstanceLeaf* inst;   // hardware instance the node belongs to, or nullptr
+    };
+
+    void push(const StackEntry& entry);
+
+  private:
+    StackEntry stack[QBVH6Traversal::MAX_STACK_DEPTH];
+    size_t stackPtr;
+
+    TraversalRay rays[QBVH6Traversal::MAX_BVH_LEVELS];  // ray for each BVH level
+    Vec3f rdirs[QBVH6Traversal::MAX_BVH_LEVELS];        // reciprocal ray direction for each BVH level
+    const InstanceLeaf* inst;                           // hardware instance currently traversed
+    uint32_t level;                                     // current BVH level
+    bool done;                                          // set to terminate traversal
+    TraversalMode mode;
+
+    TraversalHit committed;
+    TraversalHit potential;
+    TraversalStats counters;
+  };
+}
@@ -213,8 +213,9 @@ namespace embree
       return enlarge(box, Vec3f(err));
     }
 
-    /* this function quantizes the provided bounds */
-    const BBox3f quantize_bounds(BBox3f fbounds, Vec3f base) const
+    /* this function quantizes the provided bounds, it is force inlined as the builder
+     * gets compiled for multiple ISAs that must not share a single out of line copy */
+    __forceinline const BBox3f quantize_bounds(BBox3f fbounds, Vec3f base) const
     {
       const Vec3f lower = fbounds.lower-base;
       const Vec3f upper = fbounds.upper-base;
@@ -251,6 +252,11 @@ namespace embree
       return qbounds;
     }
     
+    /* returns the bounds of a child as seen by the hardware after conservative quantization */
+    __forceinline const BBox3f quantized_bounds(const BBox3f& fbounds) const {
+      return dequantize_bounds(quantize_bounds(conservativeBox(fbounds), this->lower), this->lower);
+    }
+    
     /* this function de-quantizes the provided bounds */
     const BBox3f dequantize_bounds(const BBox3f& qbounds, Vec3f base) const
     {
@@ -402,13 +408,13 @@ namespace embree
 
     /* Constructs an internal node. The quantization grid gets
      * initialized from the provided parent bounds. */
-    InternalNode (BBox3f box, NodeType type = NODE_TYPE_MIXED)
+    __forceinline InternalNode (BBox3f box, NodeType type = NODE_TYPE_MIXED)
       : InternalNode(type)
     {
       setNodeBounds(box);
     }
 
-    void setNodeBounds(BBox3f box)
+    __forceinline void setNodeBounds(BBox3f box)
     {
       /* initialize quantization grid */
       box = conservativeBox(box);
@@ -441,7 +447,7 @@ namespace embree
                                this->lower);
     }
 
-    const BBox3f bounds() const
+    __forceinline const BBox3f bounds() const
     {
       BBox3f b = empty;
       for (size_t i=0; i<NUM_CHILDREN; i++) {
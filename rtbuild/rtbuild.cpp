@@ -4,203 +4,74 @@
 #define RTHWIF_EXPORT_API
 
 #include "rtbuild.h"
-#include "qbvh6_builder_sah.h"
+#include "rtbuild_builder.h"
+#include "qbvh6.h"
+#include "statistics.h"
+#include "serialize.h"
+#include "cache.h"
+#include "algorithms/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 
 namespace embree
 {
-  using namespace embree::isa;
+  /* environment variable that limits the number of builder threads, read when the library gets loaded */
+  static const char* BUILDER_THREADS_ENVIRONMENT_VARIABLE = "ZE_RAYTRACING_BUILDER_THREADS";
 
-  static tbb::task_arena g_arena(tbb::this_task_arena::max_concurrency(),tbb::this_task_arena::max_concurrency());
-  
-  inline ze_rtas_triangle_indices_uint32_exp_t getPrimitive(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, uint32_t primID) {
-    assert(primID < geom->triangleCount);
-    return *(ze_rtas_triangle_indices_uint32_exp_t*)((char*)geom->pTriangleBuffer + uint64_t(primID)*geom->triangleStride);
-  }
-  
-  inline Vec3f getVertex(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, uint32_t vertexID) {
-    assert(vertexID < geom->vertexCount);
-    return *(Vec3f*)((char*)geom->pVertexBuffer + uint64_t(vertexID)*geom->vertexStride);
-  }
-  
-  inline ze_rtas_quad_indices_uint32_exp_t getPrimitive(const ze_rtas_builder_quads_geometry_info_exp_t* geom, uint32_t primID) {
-    assert(primID < geom->quadCount);
-    return *(ze_rtas_quad_indices_uint32_exp_t*)((char*)geom->pQuadBuffer + uint64_t(primID)*geom->quadStride);
-  }
-  
-  inline Vec3f getVertex(const ze_rtas_builder_quads_geometry_info_exp_t* geom, uint32_t vertexID) {
-    assert(vertexID < geom->vertexCount);
-    return *(Vec3f*)((char*)geom->pVertexBuffer + uint64_t(vertexID)*geom->vertexStride);
-  }
-
-  inline AffineSpace3fa getTransform(const ze_rtas_builder_instance_geometry_info_exp_t* geom)
-  {
-    switch (geom->transformFormat)
-    {
-    case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_COLUMN_MAJOR: {
-      const ze_rtas_transform_float3x4_column_major_exp_t* xfm = (const ze_rtas_transform_float3x4_column_major_exp_t*) geom->pTransform;
-      return {
-        { xfm->vx_x, xfm->vx_y, xfm->vx_z },
-        { xfm->vy_x, xfm->vy_y, xfm->vy_z },
-        { xfm->vz_x, xfm->vz_y, xfm->vz_z },
-        { xfm-> p_x, xfm-> p_y, xfm-> p_z }
-      };
-    }
-    case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_ALIGNED_COLUMN_MAJOR: {
-      const ze_rtas_transform_float3x4_aligned_column_major_exp_t* xfm = (const ze_rtas_transform_float3x4_aligned_column_major_exp_t*) geom->pTransform;
-      return {
-        { xfm->vx_x, xfm->vx_y, xfm->vx_z },
-        { xfm->vy_x, xfm->vy_y, xfm->vy_z },
-        { xfm->vz_x, xfm->vz_y, xfm->vz_z },
-        { xfm-> p_x, xfm-> p_y, xfm-> p_z }
-      };
-    }
-    case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_ROW_MAJOR: {
-      const ze_rtas_transform_float3x4_row_major_exp_t* xfm = (const ze_rtas_transform_float3x4_row_major_exp_t*) geom->pTransform;
-      return {
-        { xfm->vx_x, xfm->vx_y, xfm->vx_z },
-        { xfm->vy_x, xfm->vy_y, xfm->vy_z },
-        { xfm->vz_x, xfm->vz_y, xfm->vz_z },
-        { xfm-> p_x, xfm-> p_y, xfm-> p_z }
-      };
-    }
-    default:
-      throw std::runtime_error("invalid transform format");
-    }
-  }
-  
-  inline void verifyGeometryDesc(const ze_rtas_builder_triangles_geometry_info_exp_t* geom)
+  static int getBuilderThreads()
   {
-    if (geom->triangleFormat != ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_TRIANGLE_INDICES_UINT32)
-      throw std::runtime_error("triangle format must be ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_TRIANGLE_INDICES_UINT32");
-    
-    if (geom->vertexFormat != ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3)
-      throw std::runtime_error("vertex format must be ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3");
- 
-    if (geom->triangleCount && geom->pTriangleBuffer == nullptr) throw std::runtime_error("no triangle buffer specified");
-    if (geom->vertexCount   && geom->pVertexBuffer   == nullptr) throw std::runtime_error("no vertex buffer specified");
+    const char* str = getenv(BUILDER_THREADS_ENVIRONMENT_VARIABLE);
+    const int threads = str ? atoi(str) : 0;
+    if (threads <= 0) return tbb::this_task_arena::max_concurrency();
+    return threads;
   }
 
-  inline void verifyGeometryDesc(const ze_rtas_builder_quads_geometry_info_exp_t* geom)
-  {
-    if (geom->quadFormat != ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_QUAD_INDICES_UINT32)
-      throw std::runtime_error("quad format must be ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_QUAD_INDICES_UINT32");
-    
-    if (geom->vertexFormat != ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3)
-      throw std::runtime_error("vertex format must be ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3");
- 
-    if (geom->quadCount   && geom->pQuadBuffer   == nullptr) throw std::runtime_error("no quad buffer specified");
-    if (geom->vertexCount && geom->pVertexBuffer == nullptr) throw std::runtime_error("no vertex buffer specified");
-  }
+  static const int g_numThreads = getBuilderThreads();
+  static tbb::task_arena g_arena(g_numThreads,g_numThreads);
 
-  inline void verifyGeometryDesc(const ze_rtas_builder_procedural_geometry_info_exp_t* geom)
+  /* builder bodies compiled for one ISA */
+  struct BuilderBodies
   {
-    if (geom->primCount   && geom->pfnGetBoundsCb == nullptr) throw std::runtime_error("no bounds function specified");
-    if (geom->reserved != 0) throw std::runtime_error("reserved value must be zero");
-  }
+    decltype(&isa::zeRTASBuilderGetBuildPropertiesExpBody) getBuildProperties;
+    decltype(&isa::zeRTASBuilderBuildExpBody) build;
+  };
 
-  inline void verifyGeometryDesc(const ze_rtas_builder_instance_geometry_info_exp_t* geom)
-  {
-    if (geom->pTransform == nullptr) throw std::runtime_error("no instance transformation specified");
-    if (geom->pBounds == nullptr) throw std::runtime_error("no acceleration structure bounds specified");
-    if (geom->pAccelerationStructure == nullptr) throw std::runtime_error("no acceleration structure to instanciate specified");
-  }
+  /* environment variable that limits the ISA of the builder to sse2, sse4.2, avx2, or avx512 */
+  static const char* BUILDER_ISA_ENVIRONMENT_VARIABLE = "ZE_RAYTRACING_BUILDER_ISA";
 
-  inline bool buildBounds(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, uint32_t primID, BBox3fa& bbox, void* buildUserPtr)
+  static int getMaxBuilderISA()
   {
-    if (primID >= geom->triangleCount) return false;
-    const ze_rtas_triangle_indices_uint32_exp_t tri = getPrimitive(geom,primID);
-    if (unlikely(tri.v0 >= geom->vertexCount)) return false;
-    if (unlikely(tri.v1 >= geom->vertexCount)) return false;
-    if (unlikely(tri.v2 >= geom->vertexCount)) return false;
-    
-    const Vec3f p0 = getVertex(geom,tri.v0);
-    const Vec3f p1 = getVertex(geom,tri.v1);
-    const Vec3f p2 = getVertex(geom,tri.v2);
-    if (unlikely(!isvalid(p0))) return false;
-    if (unlikely(!isvalid(p1))) return false;
-    if (unlikely(!isvalid(p2))) return false;
-    
-    bbox = BBox3fa(min(p0,p1,p2),max(p0,p1,p2));
-    return true;
+    const char* name = getenv(BUILDER_ISA_ENVIRONMENT_VARIABLE);
+    if (name == nullptr)            return getCPUFeatures();
+    if (strcmp(name,"sse2"  ) == 0) return SSE2;
+    if (strcmp(name,"sse4.2") == 0) return SSE42;
+    if (strcmp(name,"avx2"  ) == 0) return AVX2;
+    if (strcmp(name,"avx512") == 0) return AVX512;
+    return getCPUFeatures();
   }
 
-  inline bool buildBounds(const ze_rtas_builder_quads_geometry_info_exp_t* geom, uint32_t primID, BBox3fa& bbox, void* buildUserPtr)
+  /* selects the builder bodies of the best ISA supported by the CPU, falling back to the baseline ISA */
+  static BuilderBodies selectBuilderBodies()
   {
-    if (primID >= geom->quadCount) return false;
-    const ze_rtas_quad_indices_uint32_exp_t tri = getPrimitive(geom,primID);
-    if (unlikely(tri.v0 >= geom->vertexCount)) return false;
-    if (unlikely(tri.v1 >= geom->vertexCount)) return false;
-    if (unlikely(tri.v2 >= geom->vertexCount)) return false;
-    if (unlikely(tri.v3 >= geom->vertexCount)) return false;
-    
-    const Vec3f p0 = getVertex(geom,tri.v0);
-    const Vec3f p1 = getVertex(geom,tri.v1);
-    const Vec3f p2 = getVertex(geom,tri.v2);
-    const Vec3f p3 = getVertex(geom,tri.v3);
-    if (unlikely(!isvalid(p0))) return false;
-    if (unlikely(!isvalid(p1))) return false;
-    if (unlikely(!isvalid(p2))) return false;
-    if (unlikely(!isvalid(p3))) return false;
-    
-    bbox = BBox3fa(min(p0,p1,p2,p3),max(p0,p1,p2,p3));
-    return true;
-  }
+    MAYBE_UNUSED const int features = getCPUFeatures() & getMaxBuilderISA();
 
-  inline bool buildBounds(const ze_rtas_builder_procedural_geometry_info_exp_t* geom, uint32_t primID, BBox3fa& bbox, void* buildUserPtr)
-  {
-    if (primID >= geom->primCount) return false;
-    if (geom->pfnGetBoundsCb == nullptr) return false;
-
-    BBox3f bounds;
-    ze_rtas_geometry_aabbs_exp_cb_params_t params = { ZE_STRUCTURE_TYPE_RTAS_GEOMETRY_AABBS_EXP_CB_PARAMS };
-    params.primID = primID;
-    params.primIDCount = 1;
-    params.pGeomUserPtr = geom->pGeomUserPtr;
-    params.pBuildUserPtr = buildUserPtr;
-    params.pBoundsOut = (ze_rtas_aabb_exp_t*) &bounds;
-    (geom->pfnGetBoundsCb)(&params);
-    
-    if (unlikely(!isvalid(bounds.lower))) return false;
-    if (unlikely(!isvalid(bounds.upper))) return false;
-    if (unlikely(bounds.empty())) return false;
-    
-    bbox = (BBox3f&) bounds;
-    return true;
-  }
-
-  inline bool buildBounds(const ze_rtas_builder_instance_geometry_info_exp_t* geom, uint32_t primID, BBox3fa& bbox, void* buildUserPtr)
-  {
-    if (primID >= 1) return false;
-    if (geom->pAccelerationStructure == nullptr) return false;
-    if (geom->pTransform == nullptr) return false;
-    
-    const AffineSpace3fa local2world = getTransform(geom);
-    const Vec3fa lower(geom->pBounds->lower.x,geom->pBounds->lower.y,geom->pBounds->lower.z);
-    const Vec3fa upper(geom->pBounds->upper.x,geom->pBounds->upper.y,geom->pBounds->upper.z);
-    const BBox3fa bounds = xfmBounds(local2world,BBox3fa(lower,upper));
-     
-    if (unlikely(!isvalid(bounds.lower))) return false;
-    if (unlikely(!isvalid(bounds.upper))) return false;
-    if (unlikely(bounds.empty())) return false;
-    
-    bbox = bounds;
-    return true;
+#if defined(ZE_RAYTRACING_TARGET_AVX512)
+    if ((features & AVX512) == AVX512) return { avx512::zeRTASBuilderGetBuildPropertiesExpBody, avx512::zeRTASBuilderBuildExpBody };
+#endif
+#if defined(ZE_RAYTRACING_TARGET_AVX2)
+    if ((features & AVX2) == AVX2) return { avx2::zeRTASBuilderGetBuildPropertiesExpBody, avx2::zeRTASBuilderBuildExpBody };
+#endif
+#if defined(ZE_RAYTRACING_TARGET_SSE42)
+    if ((features & SSE42) == SSE42) return { sse42::zeRTASBuilderGetBuildPropertiesExpBody, sse42::zeRTASBuilderBuildExpBody };
+#endif
+    return { isa::zeRTASBuilderGetBuildPropertiesExpBody, isa::zeRTASBuilderBuildExpBody };
   }
 
-  template<typename GeometryType>
-  PrimInfo createGeometryPrimRefArray(const GeometryType* geom, void* buildUserPtr, evector<PrimRef>& prims, const range<size_t>& r, size_t k, unsigned int geomID)
-  {
-    PrimInfo pinfo(empty);
-    for (uint32_t primID=r.begin(); primID<r.end(); primID++)
-    {
-      BBox3fa bounds = empty;
-      if (!buildBounds(geom,primID,bounds,buildUserPtr)) continue;
-      const PrimRef prim(bounds,geomID,primID);
-      pinfo.add_center2(prim);
-      prims[k++] = prim;
-    }
-    return pinfo;
-  }
+  static const BuilderBodies g_builder = selectBuilderBodies();
   
   typedef struct _zet_base_desc_t
   {
@@ -249,6 +120,14 @@ namespace embree
     return false;
   }
 
+  const void* findDescInChain(const void* pNext, ze_structure_type_t stype)
+  {
+    /* chain got already checked for cycles */
+    for (zet_base_desc_t_* desc = (zet_base_desc_t_*) pNext; desc; desc = (zet_base_desc_t_*) desc->pNext)
+      if (desc->stype == stype) return desc;
+    return nullptr;
+  }
+
   struct ze_rtas_builder
   {
     ze_rtas_builder () {
@@ -340,6 +219,71 @@ namespace embree
     return ZE_RESULT_SUCCESS;
   }
 
+  ze_result_t validate(ze_rtas_statistics_exp_t* pStatistics)
+  { 
+    if (pStatistics == nullptr)
+      return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+
+    if (pStatistics->stype != ZE_STRUCTURE_TYPE_RTAS_STATISTICS_EXP)
+      return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+    
+    if (!checkDescChain((zet_base_desc_t_*)pStatistics))
+      return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+    
+    return ZE_RESULT_SUCCESS;
+  }
+
+  ze_result_t validate(const ze_rtas_copy_exp_desc_t* pDescriptor)
+  {
+    if (pDescriptor == nullptr)
+      return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+
+    if (pDescriptor->stype != ZE_STRUCTURE_TYPE_RTAS_COPY_EXP_DESC)
+      return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+
+    if (!checkDescChain((zet_base_desc_t_*)pDescriptor))
+      return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+
+    if (pDescriptor->numRemapEntries && pDescriptor->pRemapEntries == nullptr)
+      return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+
+    return ZE_RESULT_SUCCESS;
+  }
+
+  ze_result_t validate(const ze_rtas_serialize_exp_desc_t* pDescriptor)
+  {
+    if (pDescriptor == nullptr)
+      return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+
+    if (pDescriptor->stype != ZE_STRUCTURE_TYPE_RTAS_SERIALIZE_EXP_DESC)
+      return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+
+    if (!checkDescChain((zet_base_desc_t_*)pDescriptor))
+      return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+
+    if (pDescriptor->numAccels && pDescriptor->ppAccels == nullptr)
+      return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+
+    return ZE_RESULT_SUCCESS;
+  }
+
+  ze_result_t validate(const ze_rtas_deserialize_exp_desc_t* pDescriptor)
+  {
+    if (pDescriptor == nullptr)
+      return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+
+    if (pDescriptor->stype != ZE_STRUCTURE_TYPE_RTAS_DESERIALIZE_EXP_DESC)
+      return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+
+    if (!checkDescChain((zet_base_desc_t_*)pDescriptor))
+      return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+
+    if (pDescriptor->numAccels && pDescriptor->ppAccels == nullptr)
+      return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+
+    return ZE_RESULT_SUCCESS;
+  }
+
   ze_result_t validate(ze_rtas_format_exp_t rtasFormat)
   {
     if (rtasFormat == ZE_RTAS_FORMAT_EXP_INVALID)
@@ -381,8 +325,30 @@ namespace embree
       return ZE_RESULT_ERROR_INVALID_ENUMERATION;
 
     /* validate build flags */
-    if (args->buildFlags >= (ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_NO_DUPLICATE_ANYHIT_INVOCATION<<1))
+    const ze_rtas_builder_build_op_exp_flags_t supportedBuildFlags =
+      ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_COMPACT |
+      ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_NO_DUPLICATE_ANYHIT_INVOCATION |
+      ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS |
+      ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_QUANTIZED_SAH |
+      ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_PACK_PROCEDURALS |
+      ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_FIRST_TOUCH_SCRATCH |
+      ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SHARE_DUPLICATE_INDICES |
+      ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SCRATCH_IN_RTAS_BUFFER;
+    
+    if (args->buildFlags & ~supportedBuildFlags)
       return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+
+    /* validate optional ray distribution */
+    const ze_rtas_builder_build_op_ray_distribution_exp_desc_t* ray_ext = (const ze_rtas_builder_build_op_ray_distribution_exp_desc_t*)
+      findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_RAY_DISTRIBUTION_EXP_DESC);
+    if (ray_ext)
+    {
+      if (ray_ext->childOrder != ZE_RTAS_BUILDER_CHILD_ORDER_EXP_HIT_PROBABILITY && ray_ext->childOrder != ZE_RTAS_BUILDER_CHILD_ORDER_EXP_DISTANCE)
+        return ZE_RESULT_ERROR_INVALID_ENUMERATION;
+
+      if (ray_ext->numDirections && ray_ext->pDirections == nullptr)
+        return ZE_RESULT_ERROR_INVALID_NULL_POINTER;
+    }
     
     return ZE_RESULT_SUCCESS;
   }
@@ -436,6 +402,11 @@ namespace embree
   {
     VALIDATE(hBuilder);
     delete (ze_rtas_builder*) hBuilder;
+
+    /* pending cache files get written before the application may unload the library */
+    if (BuildCache* cache = BuildCache::get())
+      cache->flush();
+
     return ZE_RESULT_SUCCESS;
   }
 
@@ -456,17 +427,6 @@ namespace embree
     return ZE_RESULT_EXP_ERROR_OPERANDS_INCOMPATIBLE;
   }
 
-  uint32_t getNumPrimitives(const ze_rtas_builder_geometry_info_exp_t* geom)
-  {
-    switch (geom->geometryType) {
-    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES  : return ((ze_rtas_builder_triangles_geometry_info_exp_t*) geom)->triangleCount;
-    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL : return ((ze_rtas_builder_procedural_geometry_info_exp_t*) geom)->primCount;
-    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS      : return ((ze_rtas_builder_quads_geometry_info_exp_t*) geom)->quadCount;
-    case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE   : return 1;
-    default                              : return 0;
-    };
-  }
-  
   RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASBuilderGetBuildPropertiesExpImpl(ze_rtas_builder_exp_handle_t hBuilder,
                                                                                   const ze_rtas_builder_build_op_exp_desc_t* args,
                                                                                   ze_rtas_builder_exp_properties_t* pProp)
@@ -476,188 +436,10 @@ namespace embree
     VALIDATE(args);
     VALIDATE(pProp);
 
-    const ze_rtas_builder_geometry_info_exp_t** geometries = args->ppGeometries;
-    const size_t numGeometries = args->numGeometries;
-
-    auto getSize = [&](uint32_t geomID) -> size_t {
-      const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
-      if (geom == nullptr) return 0;
-      return getNumPrimitives(geom);
-    };
-    
-    auto getType = [&](unsigned int geomID)
-    {
-      const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
-      assert(geom);
-      switch (geom->geometryType) {
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES : return QBVH6BuilderSAH::TRIANGLE;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS: return QBVH6BuilderSAH::QUAD;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: return QBVH6BuilderSAH::PROCEDURAL;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: return QBVH6BuilderSAH::INSTANCE;
-      default: throw std::runtime_error("invalid geometry type");
-      };
-    };
-
-    /* query memory requirements from builder */
-    size_t expectedBytes = 0;
-    size_t worstCaseBytes = 0;
-    size_t scratchBytes = 0;
-    QBVH6BuilderSAH::estimateSize(numGeometries, getSize, getType, args->rtasFormat, args->buildQuality, args->buildFlags, expectedBytes, worstCaseBytes, scratchBytes);
-    
-    /* fill return struct */
-    pProp->flags = 0;
-    pProp->rtasBufferSizeBytesExpected = expectedBytes;
-    pProp->rtasBufferSizeBytesMaxRequired = worstCaseBytes;
-    pProp->scratchBufferSizeBytes = scratchBytes;
-    return ZE_RESULT_SUCCESS;
-  }
-  
-  ze_result_t zeRTASBuilderBuildExpBody(const ze_rtas_builder_build_op_exp_desc_t* args,
-                                            void *pScratchBuffer, size_t scratchBufferSizeBytes,
-                                            void *pRtasBuffer, size_t rtasBufferSizeBytes,
-                                            void *pBuildUserPtr, ze_rtas_aabb_exp_t *pBounds, size_t *pRtasBufferSizeBytes) try
-  {
-    const ze_rtas_builder_geometry_info_exp_t** geometries = args->ppGeometries;
-    const uint32_t numGeometries = args->numGeometries;
-
-    /* verify input descriptors */
-    parallel_for(numGeometries,[&](uint32_t geomID) {
-      const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
-      if (geom == nullptr) return;
-      
-      switch (geom->geometryType) {
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES  : verifyGeometryDesc((ze_rtas_builder_triangles_geometry_info_exp_t*)geom); break;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS      : verifyGeometryDesc((ze_rtas_builder_quads_geometry_info_exp_t*    )geom); break;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL : verifyGeometryDesc((ze_rtas_builder_procedural_geometry_info_exp_t*)geom); break;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE   : verifyGeometryDesc((ze_rtas_builder_instance_geometry_info_exp_t* )geom); break;
-      default: throw std::runtime_error("invalid geometry type");
-      };
-    });
-    
-    auto getSize = [&](uint32_t geomID) -> size_t {
-      const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
-      if (geom == nullptr) return 0;
-      return getNumPrimitives(geom);
-    };
-    
-    auto getType = [&](unsigned int geomID)
-    {
-      const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
-      assert(geom);
-      switch (geom->geometryType) {
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES : return QBVH6BuilderSAH::TRIANGLE;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS: return QBVH6BuilderSAH::QUAD;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: return QBVH6BuilderSAH::PROCEDURAL;
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: return QBVH6BuilderSAH::INSTANCE;
-      default: throw std::runtime_error("invalid geometry type");
-      };
-    };
-    
-    auto createPrimRefArray = [&] (evector<PrimRef>& prims, BBox1f time_range, const range<size_t>& r, size_t k, unsigned int geomID) -> PrimInfo
-    {
-      const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
-      assert(geom);
-
-      switch (geom->geometryType) {
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES  : return createGeometryPrimRefArray((ze_rtas_builder_triangles_geometry_info_exp_t*)geom,pBuildUserPtr,prims,r,k,geomID);
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS      : return createGeometryPrimRefArray((ze_rtas_builder_quads_geometry_info_exp_t*    )geom,pBuildUserPtr,prims,r,k,geomID);
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: return createGeometryPrimRefArray((ze_rtas_builder_procedural_geometry_info_exp_t*)geom,pBuildUserPtr,prims,r,k,geomID);
-      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: return createGeometryPrimRefArray((ze_rtas_builder_instance_geometry_info_exp_t* )geom,pBuildUserPtr,prims,r,k,geomID);
-      default: throw std::runtime_error("invalid geometry type");
-      };
-    };
-
-    auto convertGeometryFlags = [&] (ze_rtas_builder_packed_geometry_exp_flags_t flags) -> GeometryFlags {
-      return (flags & ZE_RTAS_BUILDER_GEOMETRY_EXP_FLAG_NON_OPAQUE) ? GeometryFlags::NONE : GeometryFlags::OPAQUE;
-    };
-    
-    auto getTriangle = [&](unsigned int geomID, unsigned int primID)
-    {
-      const ze_rtas_builder_triangles_geometry_info_exp_t* geom = (const ze_rtas_builder_triangles_geometry_info_exp_t*) geometries[geomID];
-      assert(geom);
-      
-      const ze_rtas_triangle_indices_uint32_exp_t tri = getPrimitive(geom,primID);
-      if (unlikely(tri.v0 >= geom->vertexCount)) return QBVH6BuilderSAH::Triangle();
-      if (unlikely(tri.v1 >= geom->vertexCount)) return QBVH6BuilderSAH::Triangle();
-      if (unlikely(tri.v2 >= geom->vertexCount)) return QBVH6BuilderSAH::Triangle();
-      
-      const Vec3f p0 = getVertex(geom,tri.v0);
-      const Vec3f p1 = getVertex(geom,tri.v1);
-      const Vec3f p2 = getVertex(geom,tri.v2);
-      if (unlikely(!isvalid(p0))) return QBVH6BuilderSAH::Triangle();
-      if (unlikely(!isvalid(p1))) return QBVH6BuilderSAH::Triangle();
-      if (unlikely(!isvalid(p2))) return QBVH6BuilderSAH::Triangle();
-
-      const GeometryFlags gflags = convertGeometryFlags(geom->geometryFlags);
-      return QBVH6BuilderSAH::Triangle(tri.v0,tri.v1,tri.v2,p0,p1,p2,gflags,geom->geometryMask);
-    };
-    
-    auto getTriangleIndices = [&] (uint32_t geomID, uint32_t primID) {
-      const ze_rtas_builder_triangles_geometry_info_exp_t* geom = (const ze_rtas_builder_triangles_geometry_info_exp_t*) geometries[geomID];
-      assert(geom);
-      const ze_rtas_triangle_indices_uint32_exp_t tri = getPrimitive(geom,primID);
-      return Vec3<uint32_t>(tri.v0,tri.v1,tri.v2);
-    };
-    
-    auto getQuad = [&](unsigned int geomID, unsigned int primID)
-    {
-      const ze_rtas_builder_quads_geometry_info_exp_t* geom = (const ze_rtas_builder_quads_geometry_info_exp_t*) geometries[geomID];
-      assert(geom);
-                     
-      const ze_rtas_quad_indices_uint32_exp_t quad = getPrimitive(geom,primID);
-      const Vec3f p0 = getVertex(geom,quad.v0);
-      const Vec3f p1 = getVertex(geom,quad.v1);
-      const Vec3f p2 = getVertex(geom,quad.v2);
-      const Vec3f p3 = getVertex(geom,quad.v3);
-
-      const GeometryFlags gflags = convertGeometryFlags(geom->geometryFlags);
-      return QBVH6BuilderSAH::Quad(p0,p1,p2,p3,gflags,geom->geometryMask);
-    };
-    
-    auto getProcedural = [&](unsigned int geomID, unsigned int primID) {
-      const ze_rtas_builder_procedural_geometry_info_exp_t* geom = (const ze_rtas_builder_procedural_geometry_info_exp_t*) geometries[geomID];
-      assert(geom);
-      return QBVH6BuilderSAH::Procedural(geom->geometryMask); // FIXME: pass gflags
-    };
-    
-    auto getInstance = [&](unsigned int geomID, unsigned int primID)
-    {
-      assert(geometries[geomID]);
-      assert(geometries[geomID]->geometryType == ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE);
-      const ze_rtas_builder_instance_geometry_info_exp_t* geom = (const ze_rtas_builder_instance_geometry_info_exp_t*) geometries[geomID];
-      void* accel = geom->pAccelerationStructure;
-      const AffineSpace3fa local2world = getTransform(geom);
-      return QBVH6BuilderSAH::Instance(local2world,accel,geom->geometryMask,geom->instanceUserID); // FIXME: pass instance flags
-    };
-
-    /* dispatch globals ptr for debugging purposes */
-    void* dispatchGlobalsPtr = nullptr;
-#if defined(EMBREE_SYCL_ALLOC_DISPATCH_GLOBALS)
-    if (args->pNext) {
-      zet_base_desc_t_* next = (zet_base_desc_t_*) args->pNext;
-      if (next->stype == ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_DEBUG_EXP_DESC) {
-        ze_rtas_builder_build_op_debug_exp_desc_t* debug_ext = (ze_rtas_builder_build_op_debug_exp_desc_t*) next;
-        dispatchGlobalsPtr = debug_ext->dispatchGlobalsPtr;
-      }
-    }
-#endif
-
-    bool verbose = false;
-    bool success = QBVH6BuilderSAH::build(numGeometries, nullptr, 
-                           getSize, getType, 
-                           createPrimRefArray, getTriangle, getTriangleIndices, getQuad, getProcedural, getInstance,
-                           (char*)pRtasBuffer, rtasBufferSizeBytes,
-                           pScratchBuffer, scratchBufferSizeBytes,
-                           (BBox3f*) pBounds, pRtasBufferSizeBytes,
-                           args->rtasFormat, args->buildQuality, args->buildFlags, verbose, dispatchGlobalsPtr);
-    if (!success) {
-      return ZE_RESULT_EXP_RTAS_BUILD_RETRY;
-    }
-    return ZE_RESULT_SUCCESS;
-  }
-  catch (std::exception& e) {
-    //std::cerr << "caught exception during BVH build: " << e.what() << std::endl;
-    return ZE_RESULT_ERROR_UNKNOWN;
+    /* execute inside task arena to pair triangles with the same partitioning as the build */
+    ze_result_t errorCode = ZE_RESULT_SUCCESS;
+    g_arena.execute([&](){ errorCode = g_builder.getBuildProperties(args, pProp); });
+    return errorCode;
   }
   
   RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASBuilderBuildExpImpl(ze_rtas_builder_exp_handle_t hBuilder,
@@ -670,7 +452,9 @@ namespace embree
     /* input validation */
     VALIDATE(hBuilder);
     VALIDATE(args);
-    VALIDATE_PTR(pScratchBuffer);
+    /* the scratch buffer is optional when the primrefs get placed into the acceleration structure buffer, but a provided size requires a buffer */
+    if (!(args->buildFlags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SCRATCH_IN_RTAS_BUFFER) || scratchBufferSizeBytes)
+      VALIDATE_PTR(pScratchBuffer);
     VALIDATE_PTR(pRtasBuffer);
     
     /* if parallel operation is provided then execute using thread arena inside task group ... */
@@ -686,10 +470,10 @@ namespace embree
       op->object_in_use.store(true);
       
       g_arena.execute([&](){ op->group.run([=](){
-         op->errorCode = zeRTASBuilderBuildExpBody(args,
-                                                       pScratchBuffer, scratchBufferSizeBytes,
-                                                       pRtasBuffer, rtasBufferSizeBytes,
-                                                       pBuildUserPtr, pBounds, pRtasBufferSizeBytes);
+         op->errorCode = g_builder.build(args,
+                                         pScratchBuffer, scratchBufferSizeBytes,
+                                         pRtasBuffer, rtasBufferSizeBytes,
+                                         pBuildUserPtr, pBounds, pRtasBufferSizeBytes);
                                             });
                        });
       return ZE_RESULT_EXP_RTAS_BUILD_DEFERRED;
@@ -698,10 +482,10 @@ namespace embree
     else
     {
       ze_result_t errorCode = ZE_RESULT_SUCCESS;
-      g_arena.execute([&](){ errorCode = zeRTASBuilderBuildExpBody(args,
-                                                                        pScratchBuffer, scratchBufferSizeBytes,
-                                                                        pRtasBuffer, rtasBufferSizeBytes,
-                                                                        pBuildUserPtr, pBounds, pRtasBufferSizeBytes);
+      g_arena.execute([&](){ errorCode = g_builder.build(args,
+                                                         pScratchBuffer, scratchBufferSizeBytes,
+                                                         pRtasBuffer, rtasBufferSizeBytes,
+                                                         pBuildUserPtr, pBounds, pRtasBufferSizeBytes);
                        });
       return errorCode;
     }
@@ -754,4 +538,183 @@ namespace embree
     op->object_in_use.store(false); // this is slighty too early
     return op->errorCode;
   }
+
+  RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASGetStatisticsExpImpl(const void* pRtasBuffer, ze_rtas_statistics_exp_t* pStatistics) try
+  {
+    /* input validation */
+    VALIDATE_PTR(pRtasBuffer);
+    VALIDATE(pStatistics);
+
+    const QBVH6* qbvh = (const QBVH6*) pRtasBuffer;
+    if (validate((ze_rtas_format_exp_t)qbvh->rtas_format) != ZE_RESULT_SUCCESS)
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    /* execute inside task arena to traverse the subtrees in parallel */
+    BVHStatistics stats;
+    g_arena.execute([&](){ stats = qbvh->computeStatistics(); });
+
+    auto convertLeafStat = [] (const BVHStatistics::LeafStat& leaf)
+    {
+      ze_rtas_leaf_statistics_exp_t out;
+      out.sah = leaf.leafSAH;
+      out.numLeaves = leaf.numLeaves;
+      out.numBlocks = leaf.numBlocks;
+      out.numPrimsUsed = leaf.numPrimsUsed;
+      out.numPrimsTotal = leaf.numPrimsTotal;
+      out.numBytesUsed = leaf.numBytesUsed;
+      out.numBytesTotal = leaf.numBytesTotal;
+      out.fillRate = leaf.fillRate();
+      return out;
+    };
+
+    pStatistics->internalNodes.sah = stats.internalNode.nodeSAH;
+    pStatistics->internalNodes.numNodes = stats.internalNode.numNodes;
+    pStatistics->internalNodes.numChildrenUsed = stats.internalNode.numChildrenUsed;
+    pStatistics->internalNodes.numChildrenTotal = stats.internalNode.numChildrenTotal;
+    pStatistics->internalNodes.numBytes = stats.internalNode.numBytes;
+    pStatistics->internalNodes.fillRate = stats.internalNode.fillRate();
+    pStatistics->quadLeaves = convertLeafStat(stats.quadLeaf);
+    pStatistics->proceduralLeaves = convertLeafStat(stats.proceduralLeaf);
+    pStatistics->instanceLeaves = convertLeafStat(stats.instanceLeaf);
+    pStatistics->sah = stats.internalNode.sah() + stats.quadLeaf.sah() + stats.proceduralLeaf.sah() + stats.instanceLeaf.sah();
+    pStatistics->numBytes = stats.internalNode.bytes() + stats.quadLeaf.bytes() + stats.proceduralLeaf.bytes() + stats.instanceLeaf.bytes();
+    pStatistics->bounds = { { qbvh->bounds.lower.x, qbvh->bounds.lower.y, qbvh->bounds.lower.z },
+                            { qbvh->bounds.upper.x, qbvh->bounds.upper.y, qbvh->bounds.upper.z } };
+    return ZE_RESULT_SUCCESS;
+  }
+  catch (std::exception& e) {
+    return ZE_RESULT_ERROR_UNKNOWN;
+  }
+
+  RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASCopyExpImpl(const void* pSrcRtasBuffer, void* pDstRtasBuffer, size_t dstRtasBufferSizeBytes,
+                                                             const ze_rtas_copy_exp_desc_t* pDescriptor, size_t* pRtasBufferSizeBytes) try
+  {
+    /* input validation */
+    VALIDATE_PTR(pSrcRtasBuffer);
+    if (pDescriptor) VALIDATE(pDescriptor);
+
+    const QBVH6* src = (const QBVH6*) pSrcRtasBuffer;
+    if (validate((ze_rtas_format_exp_t)src->rtas_format) != ZE_RESULT_SUCCESS)
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    /* the size of the source gets obtained from its header */
+    if (!src->hasValidTotalBytes())
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    const size_t bytes = src->getTotalBytes();
+    if (pRtasBufferSizeBytes) *pRtasBufferSizeBytes = bytes;
+
+    /* without destination buffer only the required size is returned */
+    if (pDstRtasBuffer == nullptr)
+      return ZE_RESULT_SUCCESS;
+
+    if (dstRtasBufferSizeBytes < bytes)
+      return ZE_RESULT_ERROR_INVALID_SIZE;
+
+    /* all node and leaf references are relative to the acceleration structure, thus only the
+     * dispatch globals pointer and the start node pointers of instances need patching */
+    memmove(pDstRtasBuffer,pSrcRtasBuffer,bytes);
+    QBVH6* dst = (QBVH6*) pDstRtasBuffer;
+
+    if (pDescriptor == nullptr)
+      return ZE_RESULT_SUCCESS;
+
+    if (pDescriptor->dispatchGlobalsPtr)
+      dst->dispatchGlobalsPtr = (uint64_t) pDescriptor->dispatchGlobalsPtr;
+
+    if (pDescriptor->numRemapEntries == 0)
+      return ZE_RESULT_SUCCESS;
+
+    /* instances point into the instanced acceleration structure, thus we search the entry with
+     * the closest lower source address */
+    std::vector<ze_rtas_remap_entry_exp_t> entries(pDescriptor->pRemapEntries,pDescriptor->pRemapEntries+pDescriptor->numRemapEntries);
+    std::sort(entries.begin(), entries.end(), [](const ze_rtas_remap_entry_exp_t& a, const ze_rtas_remap_entry_exp_t& b) {
+      return a.pSrcRtasBuffer < b.pSrcRtasBuffer;
+    });
+
+    auto remap = [&](InstanceLeaf* leaf)
+    {
+      const uint64_t startNodePtr = leaf->part0.startNodePtr;
+      auto entry = std::upper_bound(entries.begin(), entries.end(), startNodePtr, [](uint64_t ptr, const ze_rtas_remap_entry_exp_t& e) {
+        return ptr < (uint64_t) e.pSrcRtasBuffer;
+      });
+      if (entry == entries.begin()) return;
+      entry--;
+
+      const uint64_t offset = startNodePtr - (uint64_t) entry->pSrcRtasBuffer;
+      if (offset < entry->rtasBufferSizeBytes)
+        leaf->part0.startNodePtr = (uint64_t) entry->pDstRtasBuffer + offset;
+    };
+
+    /* execute inside task arena to traverse the subtrees in parallel */
+    g_arena.execute([&](){ dst->forEachInstanceLeaf(remap); });
+    return ZE_RESULT_SUCCESS;
+  }
+  catch (std::exception& e) {
+    return ZE_RESULT_ERROR_UNKNOWN;
+  }
+
+  RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASSerializeExpImpl(const void* pRtasBuffer, const ze_rtas_serialize_exp_desc_t* pDescriptor,
+                                                                  void* pSerializedBuffer, size_t serializedBufferSizeBytes, size_t* pSerializedBufferSizeBytes) try
+  {
+    /* input validation */
+    VALIDATE_PTR(pRtasBuffer);
+    if (pDescriptor) VALIDATE(pDescriptor);
+
+    const QBVH6* qbvh = (const QBVH6*) pRtasBuffer;
+    if (validate((ze_rtas_format_exp_t)qbvh->rtas_format) != ZE_RESULT_SUCCESS)
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    /* execute inside task arena to traverse the subtrees in parallel */
+    ze_result_t errorCode = ZE_RESULT_SUCCESS;
+    g_arena.execute([&](){
+      errorCode = serializeRTAS(pRtasBuffer, pDescriptor ? pDescriptor->numAccels : 0, pDescriptor ? pDescriptor->ppAccels : nullptr,
+                                pSerializedBuffer, serializedBufferSizeBytes, pSerializedBufferSizeBytes);
+    });
+    return errorCode;
+  }
+  catch (std::exception& e) {
+    return ZE_RESULT_ERROR_UNKNOWN;
+  }
+
+  RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASDeserializeExpImpl(ze_driver_handle_t hDriver, const void* pSerializedBuffer, size_t serializedBufferSizeBytes,
+                                                                    const ze_rtas_deserialize_exp_desc_t* pDescriptor,
+                                                                    void* pRtasBuffer, size_t rtasBufferSizeBytes, size_t* pRtasBufferSizeBytes) try
+  {
+    /* input validation */
+    VALIDATE(hDriver);
+    VALIDATE_PTR(pSerializedBuffer);
+    VALIDATE(pDescriptor);
+
+    SerializedHeader header;
+    ze_result_t errorCode = readSerializedHeader(pSerializedBuffer, serializedBufferSizeBytes, header);
+    if (errorCode != ZE_RESULT_SUCCESS)
+      return errorCode;
+
+    /* data serialized with an incompatible format has to get rebuilt */
+    if (validate((ze_rtas_format_exp_t)header.rtasFormat) != ZE_RESULT_SUCCESS)
+      return ZE_RESULT_EXP_ERROR_OPERANDS_INCOMPATIBLE;
+
+    errorCode = zeDriverRTASFormatCompatibilityCheckExpImpl(hDriver, pDescriptor->rtasFormat, (ze_rtas_format_exp_t)header.rtasFormat);
+    if (errorCode != ZE_RESULT_SUCCESS)
+      return errorCode;
+
+    if (pRtasBufferSizeBytes) *pRtasBufferSizeBytes = header.rtasBytes;
+
+    /* without acceleration structure buffer only the required size is returned */
+    if (pRtasBuffer == nullptr)
+      return ZE_RESULT_SUCCESS;
+
+    if (rtasBufferSizeBytes < header.rtasBytes)
+      return ZE_RESULT_ERROR_INVALID_SIZE;
+
+    /* execute inside task arena to copy and relocate in parallel */
+    g_arena.execute([&](){
+      errorCode = deserializeRTAS(pSerializedBuffer, header, pDescriptor->numAccels, pDescriptor->ppAccels, pDescriptor->dispatchGlobalsPtr, pRtasBuffer);
+    });
+    return errorCode;
+  }
+  catch (std::exception& e) {
+    return ZE_RESULT_ERROR_UNKNOWN;
+  }
 }
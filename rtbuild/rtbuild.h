@@ -60,3 +60,22 @@ RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASParallelOperationGetPropertiesExp
 
 RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASParallelOperationJoinExpImpl( ze_rtas_parallel_operation_exp_handle_t hParallelOperation);
 
+/* computes quality statistics of a built acceleration structure, the buffer is only read */
+RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASGetStatisticsExpImpl(const void* pRtasBuffer, ze_rtas_statistics_exp_t* pStatistics);
+
+/* copies a built acceleration structure into another buffer, optionally redirecting instances to relocated
+ * acceleration structures, without destination buffer only the required size gets returned, sources whose
+ * size cannot get determined from their header get rejected with ZE_RESULT_ERROR_INVALID_ARGUMENT */
+RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASCopyExpImpl(const void* pSrcRtasBuffer, void* pDstRtasBuffer, size_t dstRtasBufferSizeBytes,
+                                                           const ze_rtas_copy_exp_desc_t* pDescriptor, size_t* pRtasBufferSizeBytes);
+
+/* serializes a built acceleration structure into a host buffer, without buffer only the required size gets returned */
+RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASSerializeExpImpl(const void* pRtasBuffer, const ze_rtas_serialize_exp_desc_t* pDescriptor,
+                                                                void* pSerializedBuffer, size_t serializedBufferSizeBytes, size_t* pSerializedBufferSizeBytes);
+
+/* loads a serialized acceleration structure and relocates its instances, without acceleration structure buffer only the
+ * required size gets returned */
+RTHWIF_API_EXPORT ze_result_t ZE_APICALL zeRTASDeserializeExpImpl(ze_driver_handle_t hDriver, const void* pSerializedBuffer, size_t serializedBufferSizeBytes,
+                                                                  const ze_rtas_deserialize_exp_desc_t* pDescriptor,
+                                                                  void* pRtasBuffer, size_t rtasBufferSizeBytes, size_t* pRtasBufferSizeBytes);
+
@@ -0,0 +1,715 @@
+// Copyright 2009-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "rtbuild_builder.h"
+#include "qbvh6_builder_sah.h"
+#include "capture.h"
+#include "hash.h"
+#include "cache.h"
+
+/* this file gets compiled once for each enabled ISA, see rtbuild/CMakeLists.txt */
+
+namespace embree
+{
+  namespace isa
+  {
+    inline ze_rtas_triangle_indices_uint32_exp_t getPrimitive(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, uint32_t primID) {
+      assert(primID < geom->triangleCount);
+      return *(ze_rtas_triangle_indices_uint32_exp_t*)((char*)geom->pTriangleBuffer + uint64_t(primID)*geom->triangleStride);
+    }
+
+    inline Vec3f getVertex(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, uint32_t vertexID) {
+      assert(vertexID < geom->vertexCount);
+      return *(Vec3f*)((char*)geom->pVertexBuffer + uint64_t(vertexID)*geom->vertexStride);
+    }
+
+    inline ze_rtas_quad_indices_uint32_exp_t getPrimitive(const ze_rtas_builder_quads_geometry_info_exp_t* geom, uint32_t primID) {
+      assert(primID < geom->quadCount);
+      return *(ze_rtas_quad_indices_uint32_exp_t*)((char*)geom->pQuadBuffer + uint64_t(primID)*geom->quadStride);
+    }
+
+    inline Vec3f getVertex(const ze_rtas_builder_quads_geometry_info_exp_t* geom, uint32_t vertexID) {
+      assert(vertexID < geom->vertexCount);
+      return *(Vec3f*)((char*)geom->pVertexBuffer + uint64_t(vertexID)*geom->vertexStride);
+    }
+
+    inline AffineSpace3fa getTransform(const ze_rtas_builder_instance_geometry_info_exp_t* geom)
+    {
+      switch (geom->transformFormat)
+      {
+      case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_COLUMN_MAJOR: {
+        const ze_rtas_transform_float3x4_column_major_exp_t* xfm = (const ze_rtas_transform_float3x4_column_major_exp_t*) geom->pTransform;
+        return {
+          { xfm->vx_x, xfm->vx_y, xfm->vx_z },
+          { xfm->vy_x, xfm->vy_y, xfm->vy_z },
+          { xfm->vz_x, xfm->vz_y, xfm->vz_z },
+          { xfm-> p_x, xfm-> p_y, xfm-> p_z }
+        };
+      }
+      case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_ALIGNED_COLUMN_MAJOR: {
+        const ze_rtas_transform_float3x4_aligned_column_major_exp_t* xfm = (const ze_rtas_transform_float3x4_aligned_column_major_exp_t*) geom->pTransform;
+        return {
+          { xfm->vx_x, xfm->vx_y, xfm->vx_z },
+          { xfm->vy_x, xfm->vy_y, xfm->vy_z },
+          { xfm->vz_x, xfm->vz_y, xfm->vz_z },
+          { xfm-> p_x, xfm-> p_y, xfm-> p_z }
+        };
+      }
+      case ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_ROW_MAJOR: {
+        const ze_rtas_transform_float3x4_row_major_exp_t* xfm = (const ze_rtas_transform_float3x4_row_major_exp_t*) geom->pTransform;
+        return {
+          { xfm->vx_x, xfm->vx_y, xfm->vx_z },
+          { xfm->vy_x, xfm->vy_y, xfm->vy_z },
+          { xfm->vz_x, xfm->vz_y, xfm->vz_z },
+          { xfm-> p_x, xfm-> p_y, xfm-> p_z }
+        };
+      }
+      default:
+        throw std::runtime_error("invalid transform format");
+      }
+    }
+
+    inline void verifyGeometryDesc(const ze_rtas_builder_triangles_geometry_info_exp_t* geom)
+    {
+      if (geom->triangleFormat != ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_TRIANGLE_INDICES_UINT32)
+        throw std::runtime_error("triangle format must be ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_TRIANGLE_INDICES_UINT32");
+
+      if (geom->vertexFormat != ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3)
+        throw std::runtime_error("vertex format must be ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3");
+
+      if (geom->triangleCount && geom->pTriangleBuffer == nullptr) throw std::runtime_error("no triangle buffer specified");
+      if (geom->vertexCount   && geom->pVertexBuffer   == nullptr) throw std::runtime_error("no vertex buffer specified");
+    }
+
+    inline void verifyGeometryDesc(const ze_rtas_builder_quads_geometry_info_exp_t* geom)
+    {
+      if (geom->quadFormat != ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_QUAD_INDICES_UINT32)
+        throw std::runtime_error("quad format must be ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_QUAD_INDICES_UINT32");
+
+      if (geom->vertexFormat != ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3)
+        throw std::runtime_error("vertex format must be ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3");
+
+      if (geom->quadCount   && geom->pQuadBuffer   == nullptr) throw std::runtime_error("no quad buffer specified");
+      if (geom->vertexCount && geom->pVertexBuffer == nullptr) throw std::runtime_error("no vertex buffer specified");
+    }
+
+    inline void verifyGeometryDesc(const ze_rtas_builder_procedural_geometry_info_exp_t* geom)
+    {
+      if (geom->primCount   && geom->pfnGetBoundsCb == nullptr) throw std::runtime_error("no bounds function specified");
+      if (geom->reserved != 0) throw std::runtime_error("reserved value must be zero");
+    }
+
+    inline void verifyGeometryDesc(const ze_rtas_builder_instance_geometry_info_exp_t* geom)
+    {
+      if (geom->pTransform == nullptr) throw std::runtime_error("no instance transformation specified");
+      if (geom->pBounds == nullptr) throw std::runtime_error("no acceleration structure bounds specified");
+      if (geom->pAccelerationStructure == nullptr) throw std::runtime_error("no acceleration structure to instanciate specified");
+    }
+
+    inline bool buildBounds(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, uint32_t primID, BBox3fa& bbox, void* buildUserPtr)
+    {
+      if (primID >= geom->triangleCount) return false;
+      const ze_rtas_triangle_indices_uint32_exp_t tri = getPrimitive(geom,primID);
+      if (unlikely(tri.v0 >= geom->vertexCount)) return false;
+      if (unlikely(tri.v1 >= geom->vertexCount)) return false;
+      if (unlikely(tri.v2 >= geom->vertexCount)) return false;
+
+      const Vec3f p0 = getVertex(geom,tri.v0);
+      const Vec3f p1 = getVertex(geom,tri.v1);
+      const Vec3f p2 = getVertex(geom,tri.v2);
+      if (unlikely(!isvalid(p0))) return false;
+      if (unlikely(!isvalid(p1))) return false;
+      if (unlikely(!isvalid(p2))) return false;
+
+      bbox = BBox3fa(min(p0,p1,p2),max(p0,p1,p2));
+      return true;
+    }
+
+    inline bool buildBounds(const ze_rtas_builder_quads_geometry_info_exp_t* geom, uint32_t primID, BBox3fa& bbox, void* buildUserPtr)
+    {
+      if (primID >= geom->quadCount) return false;
+      const ze_rtas_quad_indices_uint32_exp_t tri = getPrimitive(geom,primID);
+      if (unlikely(tri.v0 >= geom->vertexCount)) return false;
+      if (unlikely(tri.v1 >= geom->vertexCount)) return false;
+      if (unlikely(tri.v2 >= geom->vertexCount)) return false;
+      if (unlikely(tri.v3 >= geom->vertexCount)) return false;
+
+      const Vec3f p0 = getVertex(geom,tri.v0);
+      const Vec3f p1 = getVertex(geom,tri.v1);
+      const Vec3f p2 = getVertex(geom,tri.v2);
+      const Vec3f p3 = getVertex(geom,tri.v3);
+      if (unlikely(!isvalid(p0))) return false;
+      if (unlikely(!isvalid(p1))) return false;
+      if (unlikely(!isvalid(p2))) return false;
+      if (unlikely(!isvalid(p3))) return false;
+
+      bbox = BBox3fa(min(p0,p1,p2,p3),max(p0,p1,p2,p3));
+      return true;
+    }
+
+    inline bool buildBounds(const ze_rtas_builder_procedural_geometry_info_exp_t* geom, uint32_t primID, BBox3fa& bbox, void* buildUserPtr)
+    {
+      if (primID >= geom->primCount) return false;
+      if (geom->pfnGetBoundsCb == nullptr) return false;
+
+      BBox3f bounds;
+      ze_rtas_geometry_aabbs_exp_cb_params_t params = { ZE_STRUCTURE_TYPE_RTAS_GEOMETRY_AABBS_EXP_CB_PARAMS };
+      params.primID = primID;
+      params.primIDCount = 1;
+      params.pGeomUserPtr = geom->pGeomUserPtr;
+      params.pBuildUserPtr = buildUserPtr;
+      params.pBoundsOut = (ze_rtas_aabb_exp_t*) &bounds;
+      (geom->pfnGetBoundsCb)(&params);
+
+      if (unlikely(!isvalid(bounds.lower))) return false;
+      if (unlikely(!isvalid(bounds.upper))) return false;
+      if (unlikely(bounds.empty())) return false;
+
+      bbox = (BBox3f&) bounds;
+      return true;
+    }
+
+    inline bool buildBounds(const ze_rtas_builder_instance_geometry_info_exp_t* geom, uint32_t primID, BBox3fa& bbox, void* buildUserPtr)
+    {
+      if (primID >= 1) return false;
+      if (geom->pAccelerationStructure == nullptr) return false;
+      if (geom->pTransform == nullptr) return false;
+
+      const AffineSpace3fa local2world = getTransform(geom);
+      const Vec3fa lower(geom->pBounds->lower.x,geom->pBounds->lower.y,geom->pBounds->lower.z);
+      const Vec3fa upper(geom->pBounds->upper.x,geom->pBounds->upper.y,geom->pBounds->upper.z);
+      const BBox3fa bounds = likely(isvalid(local2world) && isvalid(lower) && isvalid(upper))
+        ? xfmBoundsFinite(local2world,BBox3fa(lower,upper))
+        : xfmBounds(local2world,BBox3fa(lower,upper));
+
+      if (unlikely(!isvalid(bounds.lower))) return false;
+      if (unlikely(!isvalid(bounds.upper))) return false;
+      if (unlikely(bounds.empty())) return false;
+
+      bbox = bounds;
+      return true;
+    }
+
+    template<typename GeometryType>
+    PrimInfo createGeometryPrimRefArray(const GeometryType* geom, void* buildUserPtr, evector<PrimRef>& prims, const range<size_t>& r, size_t k, unsigned int geomID)
+    {
+      PrimInfo pinfo(empty);
+      for (uint32_t primID=r.begin(); primID<r.end(); primID++)
+      {
+        BBox3fa bounds = empty;
+        if (!buildBounds(geom,primID,bounds,buildUserPtr)) continue;
+        const PrimRef prim(bounds,geomID,primID);
+        pinfo.add_center2(prim);
+        prims[k++] = prim;
+      }
+      return pinfo;
+    }
+
+    /* creates the primref for a triangle and the triangle it got paired with by the quadifier */
+    __forceinline void createTrianglePairPrimRef(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, const QuadifierType* quadification, uint32_t primID,
+                                                 evector<PrimRef>& prims, size_t& k, unsigned int geomID, PrimInfo& pinfo)
+    {
+      const uint16_t pair = quadification[primID];
+      if (pair == QUADIFIER_PAIRED) return;
+
+      BBox3fa bounds = empty;
+      if (!buildBounds(geom,primID,bounds,nullptr)) return;
+
+      if (pair != QUADIFIER_TRIANGLE)
+      {
+        BBox3fa bounds1 = empty;
+        if (!buildBounds(geom,primID+pair,bounds1,nullptr)) return;
+        bounds.extend(bounds1);
+      }
+
+      const PrimRef prim(bounds,geomID,primID);
+      pinfo.add_center2(prim);
+      prims[k++] = prim;
+    }
+
+#if defined(__AVX2__)
+
+    /* the 8-wide path gathers using 32 bit byte offsets */
+    inline bool canGatherTriangles(const ze_rtas_builder_triangles_geometry_info_exp_t* geom)
+    {
+      const uint64_t maxOffset = uint64_t(std::numeric_limits<int32_t>::max()) - 16;
+      if (uint64_t(geom->triangleCount)*geom->triangleStride > maxOffset) return false;
+      if (uint64_t(geom->vertexCount)*geom->vertexStride > maxOffset) return false;
+      return geom->vertexCount <= maxOffset;
+    }
+
+    /* primitive info of the 8-wide path, kept in SoA layout and reduced once at the end */
+    struct PrimInfo8
+    {
+      __forceinline PrimInfo8 ()
+        : count(0)
+      {
+        for (size_t i=0; i<3; i++) {
+          geomLower[i] = centLower[i] = vfloat8(pos_inf);
+          geomUpper[i] = centUpper[i] = vfloat8(neg_inf);
+        }
+      }
+
+      __forceinline void add(const vboolf8& valid, const vfloat8 lower[3], const vfloat8 upper[3])
+      {
+        for (size_t i=0; i<3; i++)
+        {
+          const vfloat8 center2 = lower[i]+upper[i];
+          geomLower[i] = min(geomLower[i],select(valid,lower[i],vfloat8(pos_inf)));
+          geomUpper[i] = max(geomUpper[i],select(valid,upper[i],vfloat8(neg_inf)));
+          centLower[i] = min(centLower[i],select(valid,center2,vfloat8(pos_inf)));
+          centUpper[i] = max(centUpper[i],select(valid,center2,vfloat8(neg_inf)));
+        }
+        count += popcnt(valid);
+      }
+
+      __forceinline void reduce(PrimInfo& pinfo) const
+      {
+        if (count == 0) return;
+        pinfo.geomBounds.extend(BBox3fa(Vec3fa(reduce_min(geomLower[0]),reduce_min(geomLower[1]),reduce_min(geomLower[2])),
+                                        Vec3fa(reduce_max(geomUpper[0]),reduce_max(geomUpper[1]),reduce_max(geomUpper[2]))));
+        pinfo.centBounds.extend(BBox3fa(Vec3fa(reduce_min(centLower[0]),reduce_min(centLower[1]),reduce_min(centLower[2])),
+                                        Vec3fa(reduce_max(centUpper[0]),reduce_max(centUpper[1]),reduce_max(centUpper[2]))));
+        pinfo.end += count;
+      }
+
+      vfloat8 geomLower[3], geomUpper[3];
+      vfloat8 centLower[3], centUpper[3];
+      size_t count;
+    };
+
+    /* creates the primrefs for triangles primID to primID+7, returns false
+     * without writing anything if some triangle has invalid indices or
+     * vertices, such blocks get handled by the scalar path */
+    __forceinline bool createTrianglePairPrimRefs8(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, const QuadifierType* quadification, uint32_t primID,
+                                                   evector<PrimRef>& prims, size_t& k, unsigned int geomID, PrimInfo8& pinfo)
+    {
+      const vint8 pair = vint8::loadu((const unsigned short*)quadification + primID);
+      const vboolf8 active = pair != vint8(QUADIFIER_PAIRED);
+      if (none(active)) return true;
+
+      /* unpaired triangles have a pair offset of zero and get combined with themselves */
+      const vint8 primID0 = vint8(int(primID)) + vint8(step);
+      const vint8 primID1 = primID0 + pair;
+
+      /* gather vertex indices of both triangles */
+      const int* indices = (const int*) geom->pTriangleBuffer;
+      const vint8 ofs0 = primID0 * int(geom->triangleStride);
+      const vint8 ofs1 = primID1 * int(geom->triangleStride);
+      vint8 v[6];
+      v[0] = vint8::gather<1>(active,indices,ofs0+0);
+      v[1] = vint8::gather<1>(active,indices,ofs0+4);
+      v[2] = vint8::gather<1>(active,indices,ofs0+8);
+      v[3] = vint8::gather<1>(active,indices,ofs1+0);
+      v[4] = vint8::gather<1>(active,indices,ofs1+4);
+      v[5] = vint8::gather<1>(active,indices,ofs1+8);
+
+      vboolf8 valid = active;
+      const vint8 numVertices(int(geom->vertexCount));
+      for (size_t i=0; i<6; i++)
+        valid &= (v[i] >= vint8(zero)) & (v[i] < numVertices);
+      if (unlikely(any(active & !valid))) return false;
+
+      /* gather vertices and calculate bounds */
+      const float* vertices = (const float*) geom->pVertexBuffer;
+      vfloat8 lower[3] = { vfloat8(pos_inf), vfloat8(pos_inf), vfloat8(pos_inf) };
+      vfloat8 upper[3] = { vfloat8(neg_inf), vfloat8(neg_inf), vfloat8(neg_inf) };
+      for (size_t i=0; i<6; i++)
+      {
+        const vint8 ofs = v[i] * int(geom->vertexStride);
+        for (size_t dim=0; dim<3; dim++)
+        {
+          const vfloat8 p = vfloat8::gather<1>(active,vertices,ofs+int(4*dim));
+          valid &= (p > vfloat8(-FLT_LARGE)) & (p < vfloat8(+FLT_LARGE));
+          lower[dim] = min(lower[dim],p);
+          upper[dim] = max(upper[dim],p);
+        }
+      }
+      if (unlikely(any(active & !valid))) return false;
+
+      /* compact valid triangles and store them as primrefs */
+      const vint8 perm = vint8::compact(active,vint8(step));
+      vfloat8 r[8];
+      transpose(permute(lower[0],perm),permute(lower[1],perm),permute(lower[2],perm),asFloat(vint8(int(geomID))),
+                permute(upper[0],perm),permute(upper[1],perm),permute(upper[2],perm),asFloat(permute(primID0,perm)),
+                r[0],r[1],r[2],r[3],r[4],r[5],r[6],r[7]);
+
+      const size_t num = popcnt(active);
+      for (size_t i=0; i<num; i++)
+        vfloat8::store(&prims[k+i],r[i]);
+      k += num;
+
+      pinfo.add(active,lower,upper);
+      return true;
+    }
+
+#endif
+
+    PrimInfo createTrianglePairPrimRefArray(const ze_rtas_builder_triangles_geometry_info_exp_t* geom, const QuadifierType* quadification,
+                                            evector<PrimRef>& prims, const range<size_t>& r, size_t k, unsigned int geomID)
+    {
+      PrimInfo pinfo(empty);
+      uint32_t primID = r.begin();
+
+#if defined(__AVX2__)
+      if (canGatherTriangles(geom))
+      {
+        PrimInfo8 pinfo8;
+        for (; primID+8<=r.end(); primID+=8)
+        {
+          if (likely(createTrianglePairPrimRefs8(geom,quadification,primID,prims,k,geomID,pinfo8)))
+            continue;
+
+          for (uint32_t i=primID; i<primID+8; i++)
+            createTrianglePairPrimRef(geom,quadification,i,prims,k,geomID,pinfo);
+        }
+        pinfo8.reduce(pinfo);
+      }
+#endif
+
+      for (; primID<r.end(); primID++)
+        createTrianglePairPrimRef(geom,quadification,primID,prims,k,geomID,pinfo);
+
+      return pinfo;
+    }
+
+    uint32_t getNumPrimitives(const ze_rtas_builder_geometry_info_exp_t* geom)
+    {
+      switch (geom->geometryType) {
+      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES  : return ((ze_rtas_builder_triangles_geometry_info_exp_t*) geom)->triangleCount;
+      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL : return ((ze_rtas_builder_procedural_geometry_info_exp_t*) geom)->primCount;
+      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS      : return ((ze_rtas_builder_quads_geometry_info_exp_t*) geom)->quadCount;
+      case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE   : return 1;
+      default                              : return 0;
+      };
+    }
+
+    ze_result_t zeRTASBuilderGetBuildPropertiesExpBody(const ze_rtas_builder_build_op_exp_desc_t* args,
+                                                      ze_rtas_builder_exp_properties_t* pProp) try
+    {
+      const ze_rtas_builder_geometry_info_exp_t** geometries = args->ppGeometries;
+      const size_t numGeometries = args->numGeometries;
+
+      /* optionally pair triangles to compute tight bounds */
+      bool quadify = false;
+      const ze_rtas_builder_build_op_estimate_exp_desc_t* estimate_ext = (const ze_rtas_builder_build_op_estimate_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_ESTIMATE_EXP_DESC);
+      if (estimate_ext)
+        quadify = estimate_ext->flags & ZE_RTAS_BUILDER_BUILD_OP_ESTIMATE_EXP_FLAG_QUADIFY;
+
+      /* quadification reads the index buffers, thus verify triangle descriptors */
+      if (quadify)
+      {
+        for (size_t geomID=0; geomID<numGeometries; geomID++) {
+          const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
+          if (geom && geom->geometryType == ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES)
+            verifyGeometryDesc((ze_rtas_builder_triangles_geometry_info_exp_t*)geom);
+        }
+      }
+
+      auto getSize = [&](uint32_t geomID) -> size_t {
+        const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
+        if (geom == nullptr) return 0;
+        return getNumPrimitives(geom);
+      };
+
+      auto getType = [&](unsigned int geomID)
+      {
+        const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
+        assert(geom);
+        switch (geom->geometryType) {
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES : return QBVH6BuilderSAH::TRIANGLE;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS: return QBVH6BuilderSAH::QUAD;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: return QBVH6BuilderSAH::PROCEDURAL;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: return QBVH6BuilderSAH::INSTANCE;
+        default: throw std::runtime_error("invalid geometry type");
+        };
+      };
+
+      auto getTriangleIndices = [&] (uint32_t geomID, uint32_t primID) {
+        const ze_rtas_builder_triangles_geometry_info_exp_t* geom = (const ze_rtas_builder_triangles_geometry_info_exp_t*) geometries[geomID];
+        assert(geom);
+        const ze_rtas_triangle_indices_uint32_exp_t tri = getPrimitive(geom,primID);
+        return Vec3<uint32_t>(tri.v0,tri.v1,tri.v2);
+      };
+
+      /* query memory requirements from builder */
+      size_t expectedBytes = 0;
+      size_t worstCaseBytes = 0;
+      size_t scratchBytes = 0;
+      QBVH6BuilderSAH::estimateSize(numGeometries, getSize, getType, getTriangleIndices, args->rtasFormat, args->buildQuality, args->buildFlags, quadify,
+                                    expectedBytes, worstCaseBytes, scratchBytes);
+
+      /* optionally bound the scratch buffer, larger scenes then get built in chunks */
+      const ze_rtas_builder_build_op_streaming_exp_desc_t* streaming_ext = (const ze_rtas_builder_build_op_streaming_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STREAMING_EXP_DESC);
+
+      /* the primrefs may get placed at the end of the acceleration structure buffer, with a scratch
+       * budget the chunks that do not fit behind the worst case BVH data get built inside the scratch
+       * buffer, without scratch budget the worst case has to leave room for all primrefs */
+      if (args->buildFlags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SCRATCH_IN_RTAS_BUFFER)
+      {
+        expectedBytes += scratchBytes;
+        if (!streaming_ext) {
+          worstCaseBytes += scratchBytes;
+          scratchBytes = 0;
+        }
+      }
+
+      if (streaming_ext)
+        scratchBytes = std::min(scratchBytes, streaming_ext->scratchBudgetBytes);
+
+      /* optionally hash the build inputs, such that the application can look up a previous build before allocating buffers */
+      ze_rtas_builder_build_op_hash_exp_desc_t* hash_ext = (ze_rtas_builder_build_op_hash_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_HASH_EXP_DESC);
+      if (hash_ext)
+        hash_ext->hash = hashBuildInputs(args);
+
+      /* fill return struct */
+      pProp->flags = 0;
+      pProp->rtasBufferSizeBytesExpected = expectedBytes;
+      pProp->rtasBufferSizeBytesMaxRequired = worstCaseBytes;
+      pProp->scratchBufferSizeBytes = scratchBytes;
+      return ZE_RESULT_SUCCESS;
+    }
+    catch (std::exception& e) {
+      return ZE_RESULT_ERROR_UNKNOWN;
+    }
+
+    ze_result_t zeRTASBuilderBuildExpBody(const ze_rtas_builder_build_op_exp_desc_t* args,
+                                              void *pScratchBuffer, size_t scratchBufferSizeBytes,
+                                              void *pRtasBuffer, size_t rtasBufferSizeBytes,
+                                              void *pBuildUserPtr, ze_rtas_aabb_exp_t *pBounds, size_t *pRtasBufferSizeBytes) try
+    {
+      const ze_rtas_builder_geometry_info_exp_t** geometries = args->ppGeometries;
+      const uint32_t numGeometries = args->numGeometries;
+
+      /* verify input descriptors */
+      parallel_for(numGeometries,[&](uint32_t geomID) {
+        const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
+        if (geom == nullptr) return;
+
+        switch (geom->geometryType) {
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES  : verifyGeometryDesc((ze_rtas_builder_triangles_geometry_info_exp_t*)geom); break;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS      : verifyGeometryDesc((ze_rtas_builder_quads_geometry_info_exp_t*    )geom); break;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL : verifyGeometryDesc((ze_rtas_builder_procedural_geometry_info_exp_t*)geom); break;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE   : verifyGeometryDesc((ze_rtas_builder_instance_geometry_info_exp_t* )geom); break;
+        default: throw std::runtime_error("invalid geometry type");
+        };
+      });
+
+      auto getSize = [&](uint32_t geomID) -> size_t {
+        const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
+        if (geom == nullptr) return 0;
+        return getNumPrimitives(geom);
+      };
+
+      auto getType = [&](unsigned int geomID)
+      {
+        const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
+        assert(geom);
+        switch (geom->geometryType) {
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES : return QBVH6BuilderSAH::TRIANGLE;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS: return QBVH6BuilderSAH::QUAD;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: return QBVH6BuilderSAH::PROCEDURAL;
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: return QBVH6BuilderSAH::INSTANCE;
+        default: throw std::runtime_error("invalid geometry type");
+        };
+      };
+
+      auto createPrimRefArray = [&] (evector<PrimRef>& prims, BBox1f time_range, const range<size_t>& r, size_t k, unsigned int geomID, const QuadifierType* quadification) -> PrimInfo
+      {
+        const ze_rtas_builder_geometry_info_exp_t* geom = geometries[geomID];
+        assert(geom);
+
+        switch (geom->geometryType) {
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES  : assert(quadification); return createTrianglePairPrimRefArray((ze_rtas_builder_triangles_geometry_info_exp_t*)geom,quadification,prims,r,k,geomID);
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_QUADS      : return createGeometryPrimRefArray((ze_rtas_builder_quads_geometry_info_exp_t*    )geom,pBuildUserPtr,prims,r,k,geomID);
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL: return createGeometryPrimRefArray((ze_rtas_builder_procedural_geometry_info_exp_t*)geom,pBuildUserPtr,prims,r,k,geomID);
+        case ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE: return createGeometryPrimRefArray((ze_rtas_builder_instance_geometry_info_exp_t* )geom,pBuildUserPtr,prims,r,k,geomID);
+        default: throw std::runtime_error("invalid geometry type");
+        };
+      };
+
+      auto convertGeometryFlags = [&] (ze_rtas_builder_packed_geometry_exp_flags_t flags) -> GeometryFlags {
+        return (flags & ZE_RTAS_BUILDER_GEOMETRY_EXP_FLAG_NON_OPAQUE) ? GeometryFlags::NONE : GeometryFlags::OPAQUE;
+      };
+
+      auto getTriangle = [&](unsigned int geomID, unsigned int primID)
+      {
+        const ze_rtas_builder_triangles_geometry_info_exp_t* geom = (const ze_rtas_builder_triangles_geometry_info_exp_t*) geometries[geomID];
+        assert(geom);
+
+        const ze_rtas_triangle_indices_uint32_exp_t tri = getPrimitive(geom,primID);
+        if (unlikely(tri.v0 >= geom->vertexCount)) return QBVH6BuilderSAH::Triangle();
+        if (unlikely(tri.v1 >= geom->vertexCount)) return QBVH6BuilderSAH::Triangle();
+        if (unlikely(tri.v2 >= geom->vertexCount)) return QBVH6BuilderSAH::Triangle();
+
+        const Vec3f p0 = getVertex(geom,tri.v0);
+        const Vec3f p1 = getVertex(geom,tri.v1);
+        const Vec3f p2 = getVertex(geom,tri.v2);
+        if (unlikely(!isvalid(p0))) return QBVH6BuilderSAH::Triangle();
+        if (unlikely(!isvalid(p1))) return QBVH6BuilderSAH::Triangle();
+        if (unlikely(!isvalid(p2))) return QBVH6BuilderSAH::Triangle();
+
+        const GeometryFlags gflags = convertGeometryFlags(geom->geometryFlags);
+        return QBVH6BuilderSAH::Triangle(tri.v0,tri.v1,tri.v2,p0,p1,p2,gflags,geom->geometryMask);
+      };
+
+      auto getTriangleIndices = [&] (uint32_t geomID, uint32_t primID) {
+        const ze_rtas_builder_triangles_geometry_info_exp_t* geom = (const ze_rtas_builder_triangles_geometry_info_exp_t*) geometries[geomID];
+        assert(geom);
+        const ze_rtas_triangle_indices_uint32_exp_t tri = getPrimitive(geom,primID);
+        return Vec3<uint32_t>(tri.v0,tri.v1,tri.v2);
+      };
+
+      auto getQuad = [&](unsigned int geomID, unsigned int primID)
+      {
+        const ze_rtas_builder_quads_geometry_info_exp_t* geom = (const ze_rtas_builder_quads_geometry_info_exp_t*) geometries[geomID];
+        assert(geom);
+
+        const ze_rtas_quad_indices_uint32_exp_t quad = getPrimitive(geom,primID);
+        const Vec3f p0 = getVertex(geom,quad.v0);
+        const Vec3f p1 = getVertex(geom,quad.v1);
+        const Vec3f p2 = getVertex(geom,quad.v2);
+        const Vec3f p3 = getVertex(geom,quad.v3);
+
+        const GeometryFlags gflags = convertGeometryFlags(geom->geometryFlags);
+        return QBVH6BuilderSAH::Quad(p0,p1,p2,p3,gflags,geom->geometryMask);
+      };
+
+      auto getProcedural = [&](unsigned int geomID, unsigned int primID) {
+        const ze_rtas_builder_procedural_geometry_info_exp_t* geom = (const ze_rtas_builder_procedural_geometry_info_exp_t*) geometries[geomID];
+        assert(geom);
+        return QBVH6BuilderSAH::Procedural(geom->geometryMask); // FIXME: pass gflags
+      };
+
+      auto getInstance = [&](unsigned int geomID, unsigned int primID)
+      {
+        assert(geometries[geomID]);
+        assert(geometries[geomID]->geometryType == ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE);
+        const ze_rtas_builder_instance_geometry_info_exp_t* geom = (const ze_rtas_builder_instance_geometry_info_exp_t*) geometries[geomID];
+        void* accel = geom->pAccelerationStructure;
+        const AffineSpace3fa local2world = getTransform(geom);
+        return QBVH6BuilderSAH::Instance(local2world,accel,geom->geometryMask,geom->instanceUserID); // FIXME: pass instance flags
+      };
+
+      /* dispatch globals ptr for debugging purposes */
+      void* dispatchGlobalsPtr = nullptr;
+  #if defined(EMBREE_SYCL_ALLOC_DISPATCH_GLOBALS)
+      const ze_rtas_builder_build_op_debug_exp_desc_t* debug_ext = (const ze_rtas_builder_build_op_debug_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_DEBUG_EXP_DESC);
+      if (debug_ext)
+        dispatchGlobalsPtr = debug_ext->dispatchGlobalsPtr;
+  #endif
+
+      /* optional ray distribution to order children of internal nodes */
+      std::unique_ptr<QBVH6BuilderSAH::RayDistribution> rayDistribution;
+      const ze_rtas_builder_build_op_ray_distribution_exp_desc_t* ray_ext = (const ze_rtas_builder_build_op_ray_distribution_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_RAY_DISTRIBUTION_EXP_DESC);
+      if (ray_ext)
+      {
+        rayDistribution.reset(new QBVH6BuilderSAH::RayDistribution((QBVH6BuilderSAH::RayDistribution::Order) ray_ext->childOrder));
+        for (uint32_t i=0; i<ray_ext->numDirections; i++) {
+          const ze_rtas_float3_exp_t& dir = ray_ext->pDirections[i];
+          rayDistribution->add(Vec3fa(dir.x,dir.y,dir.z), ray_ext->pWeights ? ray_ext->pWeights[i] : 1.0f);
+        }
+      }
+
+      /* optional output of build statistics, gathering them is disabled otherwise */
+      ze_rtas_builder_build_op_statistics_exp_desc_t* stats_ext = (ze_rtas_builder_build_op_statistics_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STATISTICS_EXP_DESC);
+      QBVH6BuilderSAH::BuildStatistics statistics;
+
+      /* optional tracing of build phases and tasks, enabled through the environment or an extension */
+      const ze_rtas_builder_build_op_trace_exp_desc_t* trace_ext = (const ze_rtas_builder_build_op_trace_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_TRACE_EXP_DESC);
+      const char* traceFile = (trace_ext && trace_ext->pTraceFile) ? trace_ext->pTraceFile : BuildTracer::environmentFile();
+      std::unique_ptr<BuildTracer> tracer;
+      if (traceFile) tracer.reset(new BuildTracer());
+
+      /* optional capture of the build inputs for replaying the build without the application */
+      const ze_rtas_builder_build_op_capture_exp_desc_t* capture_ext = (const ze_rtas_builder_build_op_capture_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_CAPTURE_EXP_DESC);
+      const std::string captureFile = (capture_ext && capture_ext->pCaptureFile) ? std::string(capture_ext->pCaptureFile) : BuildCapture::nextEnvironmentFile();
+      if (!captureFile.empty())
+        BuildCapture::write(captureFile.c_str(), args, pBuildUserPtr);
+
+      /* optionally load the acceleration structure from the build cache, builds that
+       * report statistics or traces always run */
+      BuildCache* cache = (stats_ext || tracer) ? nullptr : BuildCache::get();
+
+      /* the build inputs get hashed once for the application and the build cache */
+      ze_rtas_builder_build_op_hash_exp_desc_t* hash_ext = (ze_rtas_builder_build_op_hash_exp_desc_t*)
+        findDescInChain(args->pNext, ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_HASH_EXP_DESC);
+      const uint64_t inputHash = (hash_ext || cache) ? hashBuildInputs(args) : 0;
+      if (hash_ext)
+        hash_ext->hash = inputHash;
+
+      const uint64_t cacheKey = cache ? BuildCache::key(args,inputHash) : 0;
+      if (cacheKey && cache->load(cacheKey, dispatchGlobalsPtr, pRtasBuffer, rtasBufferSizeBytes, pBounds, pRtasBufferSizeBytes))
+        return ZE_RESULT_SUCCESS;
+
+      /* optionally pair the triangles of identical index buffers only once */
+      std::vector<uint32_t> pairingGeomIDs;
+      if (args->buildFlags & ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SHARE_DUPLICATE_INDICES)
+        pairingGeomIDs = findDuplicateIndexBuffers(args);
+
+      bool verbose = false;
+      bool success = QBVH6BuilderSAH::build(numGeometries, nullptr, 
+                             getSize, getType, 
+                             createPrimRefArray, getTriangle, getTriangleIndices, getQuad, getProcedural, getInstance,
+                             (char*)pRtasBuffer, rtasBufferSizeBytes,
+                             pScratchBuffer, scratchBufferSizeBytes,
+                             (BBox3f*) pBounds, pRtasBufferSizeBytes,
+                             args->rtasFormat, args->buildQuality, args->buildFlags, rayDistribution.get(),
+                             pairingGeomIDs.empty() ? nullptr : pairingGeomIDs.data(), verbose,
+                             stats_ext ? &statistics : nullptr, tracer.get(), dispatchGlobalsPtr);
+
+      if (tracer)
+      {
+        if (trace_ext && trace_ext->pTraceFile) tracer->write(trace_ext->pTraceFile);
+        else                                    tracer->append(traceFile);
+      }
+
+      if (stats_ext)
+      {
+        stats_ext->setupSeconds = statistics.setupSeconds;
+        stats_ext->quadifySeconds = statistics.quadifySeconds;
+        stats_ext->primRefSeconds = statistics.primRefSeconds;
+        stats_ext->filterSeconds = statistics.filterSeconds;
+        stats_ext->presplitSeconds = statistics.presplitSeconds;
+        stats_ext->hierarchySeconds = statistics.hierarchySeconds;
+        stats_ext->finalizeSeconds = statistics.finalizeSeconds;
+        stats_ext->totalSeconds = statistics.totalSeconds;
+        stats_ext->numInputPrimitives = statistics.numInputPrimitives;
+        stats_ext->numInputTriangles = statistics.numInputTriangles;
+        stats_ext->numTrianglePairs = statistics.numTrianglePairs;
+        stats_ext->quadPairingRate = statistics.numInputTriangles ? float(2*statistics.numTrianglePairs)/float(statistics.numInputTriangles) : 0.0f;
+        stats_ext->numPrimitives = statistics.numPrimitives;
+        stats_ext->numValidPrimitives = statistics.numValidPrimitives;
+        stats_ext->numBuildPrimitives = statistics.numBuildPrimitives;
+        stats_ext->numInternalNodes = statistics.numInternalNodes;
+        stats_ext->numQuadLeaves = statistics.numQuadLeaves;
+        stats_ext->numProceduralLeaves = statistics.numProceduralLeaves;
+        stats_ext->numInstanceLeaves = statistics.numInstanceLeaves;
+        stats_ext->rtasBytesUsed = statistics.accelBytesUsed;
+        stats_ext->rtasBytesProvided = statistics.accelBytesProvided;
+        stats_ext->retry = !success;
+      }
+
+      if (!success) {
+        return ZE_RESULT_EXP_RTAS_BUILD_RETRY;
+      }
+
+      if (cacheKey)
+        cache->store(cacheKey, pRtasBuffer);
+
+      return ZE_RESULT_SUCCESS;
+    }
+    catch (std::exception& e) {
+      //std::cerr << "caught exception during BVH build: " << e.what() << std::endl;
+      return ZE_RESULT_ERROR_UNKNOWN;
+    }
+  }
+}
@@ -0,0 +1,43 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "rtbuild.h"
+#include "sys/sysinfo.h"
+
+/*
+
+  The builder bodies are compiled once for the baseline ISA of the
+  build and once for each ISA enabled through the ZE_RAYTRACING_TARGET_*
+  definitions, each version lives in the namespace of its ISA. The API
+  entry points select the version of the best ISA the CPU supports at
+  runtime.
+
+ */
+
+#define DECLARE_BUILDER_BODIES                                          \
+  ze_result_t zeRTASBuilderGetBuildPropertiesExpBody(const ze_rtas_builder_build_op_exp_desc_t* args, \
+                                                     ze_rtas_builder_exp_properties_t* pProp); \
+                                                                        \
+  ze_result_t zeRTASBuilderBuildExpBody(const ze_rtas_builder_build_op_exp_desc_t* args, \
+                                        void *pScratchBuffer, size_t scratchBufferSizeBytes, \
+                                        void *pRtasBuffer, size_t rtasBufferSizeBytes, \
+                                        void *pBuildUserPtr, ze_rtas_aabb_exp_t *pBounds, size_t *pRtasBufferSizeBytes);
+
+namespace embree
+{
+  /* returns the first extension structure of the specified type in a checked pNext chain, or nullptr */
+  const void* findDescInChain(const void* pNext, ze_structure_type_t stype);
+
+  namespace isa { DECLARE_BUILDER_BODIES }
+#if defined(ZE_RAYTRACING_TARGET_SSE42)
+  namespace sse42 { DECLARE_BUILDER_BODIES }
+#endif
+#if defined(ZE_RAYTRACING_TARGET_AVX2)
+  namespace avx2 { DECLARE_BUILDER_BODIES }
+#endif
+#if defined(ZE_RAYTRACING_TARGET_AVX512)
+  namespace avx512 { DECLARE_BUILDER_BODIES }
+#endif
+}
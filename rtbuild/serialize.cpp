@@ -0,0 +1,217 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "serialize.h"
+#include "qbvh6.h"
+#include "algorithms/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <cstring>
+
+namespace embree
+{
+  /* acceleration structure data gets copied in blocks of this size in parallel */
+  static const size_t COPY_BLOCK_SIZE = 1 << 20;
+
+  static void parallelCopy(void* dst, const void* src, size_t bytes)
+  {
+    const size_t numBlocks = (bytes + COPY_BLOCK_SIZE - 1) / COPY_BLOCK_SIZE;
+    parallel_for(numBlocks, [&](size_t block) {
+      const size_t begin = block * COPY_BLOCK_SIZE;
+      const size_t end = std::min(bytes, begin + COPY_BLOCK_SIZE);
+      memcpy((char*)dst + begin, (const char*)src + begin, end - begin);
+    });
+  }
+
+  static size_t relocationTableEnd(uint32_t numRelocations) {
+    return sizeof(SerializedHeader) + size_t(numRelocations) * sizeof(SerializedRelocation);
+  }
+
+  /* relocations get gathered in parallel for the subtrees below this depth */
+  static const uint32_t RELOCATION_BLOCK_DEPTH = 3;
+  static const size_t MAX_RELOCATION_BLOCKS = QBVH6::InternalNode6::NUM_CHILDREN * QBVH6::InternalNode6::NUM_CHILDREN * QBVH6::InternalNode6::NUM_CHILDREN;
+
+  /* collects the roots of the subtrees below the block depth in depth first order */
+  static void collectRelocationBlocks(QBVH6::Node node, uint32_t depth, QBVH6::Node* blocks, size_t& numBlocks)
+  {
+    if (node.type != NODE_TYPE_INTERNAL || depth == RELOCATION_BLOCK_DEPTH) {
+      blocks[numBlocks++] = node;
+      return;
+    }
+
+    QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+    for (uint32_t i = 0; i < QBVH6::InternalNode6::NUM_CHILDREN; i++)
+      if (inner->valid(i)) collectRelocationBlocks(inner->child(i),depth+1,blocks,numBlocks);
+  }
+
+  /* visits the instance leaves of a subtree in depth first order */
+  template<typename Func>
+  static void forEachInstanceLeafInBlock(QBVH6::Node node, const Func& func)
+  {
+    if (node.type == NODE_TYPE_INSTANCE)
+      func((const InstanceLeaf*)node.leafNodeInstance());
+
+    if (node.type != NODE_TYPE_INTERNAL)
+      return;
+
+    QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+    for (uint32_t i = 0; i < QBVH6::InternalNode6::NUM_CHILDREN; i++)
+      if (inner->valid(i)) forEachInstanceLeafInBlock(inner->child(i),func);
+  }
+
+  ze_result_t serializeRTAS(const void* pRtasBuffer, uint32_t numAccels, const void** ppAccels,
+                            void* pSerializedBuffer, size_t serializedBufferSizeBytes, size_t* pSerializedBufferSizeBytes)
+  {
+    const QBVH6* qbvh = (const QBVH6*) pRtasBuffer;
+    if (!qbvh->hasValidTotalBytes())
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    const size_t rtasBytes = qbvh->getTotalBytes();
+
+    /* instanced acceleration structures sorted by address to find the one containing a start node */
+    std::vector<std::pair<uint64_t,uint32_t>> accels(numAccels);
+    for (uint32_t i=0; i<numAccels; i++)
+      accels[i] = std::make_pair((uint64_t)ppAccels[i],i);
+    std::sort(accels.begin(),accels.end());
+
+    /* the subtrees below the top levels are the blocks in which relocations get counted and written in parallel */
+    QBVH6::Node blocks[MAX_RELOCATION_BLOCKS];
+    size_t numBlocks = 0;
+    if (!qbvh->empty())
+      collectRelocationBlocks(qbvh->root(),0,blocks,numBlocks);
+
+    /* the prefix sum over the instance leaf counts of the blocks gives the first relocation of each block */
+    std::vector<uint32_t> blockOffsets(numBlocks+1,0);
+    parallel_for(numBlocks, [&](size_t block) {
+      uint32_t count = 0;
+      forEachInstanceLeafInBlock(blocks[block],[&](const InstanceLeaf*) { count++; });
+      blockOffsets[block+1] = count;
+    });
+    for (size_t block=0; block<numBlocks; block++)
+      blockOffsets[block+1] += blockOffsets[block];
+
+    /* blocks and their instance leaves are in depth first order, thus the output is deterministic */
+    const uint32_t numRelocations = blockOffsets[numBlocks];
+    std::vector<SerializedRelocation> relocations(numRelocations);
+    std::atomic<bool> missingAccel(false);
+
+    parallel_for(numBlocks, [&](size_t block)
+    {
+      uint32_t index = blockOffsets[block];
+      forEachInstanceLeafInBlock(blocks[block],[&](const InstanceLeaf* leaf)
+      {
+        const uint64_t startNodePtr = leaf->part0.startNodePtr;
+        auto accel = std::upper_bound(accels.begin(), accels.end(), std::make_pair(startNodePtr,uint32_t(-1)));
+
+        SerializedRelocation& relocation = relocations[index++];
+        relocation.leafOffset = (uint64_t)leaf - (uint64_t)qbvh;
+        relocation.nodeOffset = accel == accels.begin() ? 0 : startNodePtr - (accel-1)->first;
+        relocation.accelIndex = accel == accels.begin() ? 0 : (accel-1)->second;
+        relocation.reserved = 0;
+        const QBVH6* instanced = accel == accels.begin() ? nullptr : (const QBVH6*)ppAccels[relocation.accelIndex];
+        const bool found = instanced && instanced->hasValidTotalBytes() && relocation.nodeOffset < instanced->getTotalBytes();
+        if (!found) missingAccel = true;
+      });
+    });
+
+    if (missingAccel)
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    const size_t rtasOffset = (relocationTableEnd(numRelocations) + SERIALIZED_ALIGNMENT - 1) & ~(SERIALIZED_ALIGNMENT - 1);
+    const size_t serializedBytes = rtasOffset + rtasBytes;
+    if (pSerializedBufferSizeBytes) *pSerializedBufferSizeBytes = serializedBytes;
+
+    /* without buffer only the required size is returned */
+    if (pSerializedBuffer == nullptr)
+      return ZE_RESULT_SUCCESS;
+
+    if (serializedBufferSizeBytes < serializedBytes)
+      return ZE_RESULT_ERROR_INVALID_SIZE;
+
+    SerializedHeader header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,SERIALIZED_MAGIC,sizeof(header.magic));
+    header.version = SERIALIZED_VERSION;
+    header.rtasFormat = qbvh->rtas_format;
+    header.rtasOffset = rtasOffset;
+    header.rtasBytes = rtasBytes;
+    header.numRelocations = numRelocations;
+    header.numAccels = numAccels;
+
+    char* out = (char*) pSerializedBuffer;
+    memcpy(out,&header,sizeof(header));
+    memcpy(out + sizeof(header),relocations.data(),numRelocations*sizeof(SerializedRelocation));
+    memset(out + relocationTableEnd(numRelocations),0,rtasOffset - relocationTableEnd(numRelocations));
+    parallelCopy(out + rtasOffset,qbvh,rtasBytes);
+
+    /* absolute pointers get cleared, such that the serialized data does not depend on the memory location */
+    QBVH6* copy = (QBVH6*) (out + rtasOffset);
+    copy->dispatchGlobalsPtr = 0;
+    for (const SerializedRelocation& relocation : relocations)
+      ((InstanceLeaf*)((char*)copy + relocation.leafOffset))->part0.startNodePtr = 0;
+
+    return ZE_RESULT_SUCCESS;
+  }
+
+  ze_result_t readSerializedHeader(const void* pSerializedBuffer, size_t serializedBufferSizeBytes, SerializedHeader& header)
+  {
+    if (serializedBufferSizeBytes < sizeof(SerializedHeader))
+      return ZE_RESULT_ERROR_INVALID_SIZE;
+
+    memcpy(&header,pSerializedBuffer,sizeof(header));
+    if (memcmp(header.magic,SERIALIZED_MAGIC,sizeof(header.magic)) != 0 || header.version != SERIALIZED_VERSION)
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    /* the sizes are untrusted, thus the checks are ordered such that no sum can wrap around */
+    if (header.numRelocations > (serializedBufferSizeBytes - sizeof(SerializedHeader)) / sizeof(SerializedRelocation))
+      return ZE_RESULT_ERROR_INVALID_SIZE;
+
+    if (header.rtasOffset < relocationTableEnd(header.numRelocations) || header.rtasBytes < sizeof(QBVH6))
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    if (header.rtasOffset > serializedBufferSizeBytes || header.rtasBytes > serializedBufferSizeBytes - header.rtasOffset)
+      return ZE_RESULT_ERROR_INVALID_SIZE;
+
+    /* the stored acceleration structure header has to describe the stored size */
+    alignas(QBVH6) char data[sizeof(QBVH6)];
+    memcpy(data,(const char*)pSerializedBuffer + header.rtasOffset,sizeof(QBVH6));
+    const QBVH6* qbvh = (const QBVH6*) data;
+    if (!qbvh->hasValidTotalBytes() || qbvh->getTotalBytes() != header.rtasBytes)
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    return ZE_RESULT_SUCCESS;
+  }
+
+  ze_result_t deserializeRTAS(const void* pSerializedBuffer, const SerializedHeader& header, uint32_t numAccels, const void** ppAccels,
+                              void* dispatchGlobalsPtr, void* pRtasBuffer)
+  {
+    const SerializedRelocation* relocations = (const SerializedRelocation*) ((const char*)pSerializedBuffer + sizeof(SerializedHeader));
+
+    /* validate all relocations before writing anything */
+    if (header.numRelocations && numAccels < header.numAccels)
+      return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+
+    for (uint32_t i=0; i<header.numRelocations; i++)
+    {
+      if (relocations[i].accelIndex >= header.numAccels || ppAccels[relocations[i].accelIndex] == nullptr)
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+      if (relocations[i].leafOffset > header.rtasBytes - sizeof(InstanceLeaf))
+        return ZE_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+
+    parallelCopy(pRtasBuffer,(const char*)pSerializedBuffer + header.rtasOffset,header.rtasBytes);
+
+    QBVH6* qbvh = (QBVH6*) pRtasBuffer;
+    qbvh->dispatchGlobalsPtr = (uint64_t) dispatchGlobalsPtr;
+
+    parallel_for(size_t(0), size_t(header.numRelocations), size_t(4096), [&](const range<size_t>& r) {
+      for (size_t i=r.begin(); i<r.end(); i++) {
+        InstanceLeaf* leaf = (InstanceLeaf*) ((char*)qbvh + relocations[i].leafOffset);
+        leaf->part0.startNodePtr = (uint64_t) ppAccels[relocations[i].accelIndex] + relocations[i].nodeOffset;
+      }
+    });
+
+    return ZE_RESULT_SUCCESS;
+  }
+}
@@ -0,0 +1,75 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "rtbuild.h"
+
+namespace embree
+{
+  /*
+
+    Serialized acceleration structure, such that a structure built
+    offline can get loaded with a single read and a pointer fixup
+    pass. All values are stored in host byte order in the following
+    sequence:
+
+      SerializedHeader
+      numRelocations x SerializedRelocation
+      padding to SERIALIZED_ALIGNMENT bytes
+      rtasBytes of acceleration structure data
+
+    The acceleration structure data is the QBVH6 header followed by
+    all node, leaf, procedural and back pointer sections. References
+    between nodes and leaves are relative to the acceleration
+    structure, thus only the start node pointers of instance leaves
+    need relocation. Each relocation stores the instance leaf and the
+    offset of its start node inside an instanced acceleration
+    structure, which is identified by its index in the array passed
+    when serializing and loading. The dispatch globals pointer is not
+    stored.
+
+   */
+
+  struct SerializedHeader
+  {
+    char magic[8];            // "RTASSER"
+    uint32_t version;         // SERIALIZED_VERSION
+    uint32_t rtasFormat;      // ze_rtas_format_exp_t of the acceleration structure
+    uint64_t rtasOffset;      // offset of the acceleration structure data
+    uint64_t rtasBytes;       // size of the acceleration structure data
+    uint32_t numRelocations;  // number of instance leaf relocations
+    uint32_t numAccels;       // number of instanced acceleration structures
+    uint64_t reserved;
+  };
+
+  static_assert(sizeof(SerializedHeader) == 48, "SerializedHeader must be 48 bytes large");
+
+  struct SerializedRelocation
+  {
+    uint64_t leafOffset;   // offset of the instance leaf inside the acceleration structure
+    uint64_t nodeOffset;   // offset of the start node inside the instanced acceleration structure
+    uint32_t accelIndex;   // index of the instanced acceleration structure
+    uint32_t reserved;
+  };
+
+  static_assert(sizeof(SerializedRelocation) == 24, "SerializedRelocation must be 24 bytes large");
+
+  static const char SERIALIZED_MAGIC[8] = "RTASSER";
+  static const uint32_t SERIALIZED_VERSION = 1;
+  static const size_t SERIALIZED_ALIGNMENT = 128;
+
+  /* Serializes the acceleration structure into the buffer, or only
+   * returns the required size if no buffer is provided. Fails if
+   * some instance references an acceleration structure not
+   * contained in ppAccels. */
+  ze_result_t serializeRTAS(const void* pRtasBuffer, uint32_t numAccels, const void** ppAccels,
+                            void* pSerializedBuffer, size_t serializedBufferSizeBytes, size_t* pSerializedBufferSizeBytes);
+
+  /* validates the serialized buffer and returns its header */
+  ze_result_t readSerializedHeader(const void* pSerializedBuffer, size_t serializedBufferSizeBytes, SerializedHeader& header);
+
+  /* copies the serialized acceleration structure into the buffer and relocates its instances */
+  ze_result_t deserializeRTAS(const void* pSerializedBuffer, const SerializedHeader& header, uint32_t numAccels, const void** ppAccels,
+                              void* dispatchGlobalsPtr, void* pRtasBuffer);
+}
@@ -0,0 +1,23 @@
+// Copyright 2009-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "sse.h"
+
+#if defined(__AVX512VL__)
+#include "vboolf8_avx512.h"
+#else
+#include "vboolf8_avx.h"
+#endif
+
+#if defined(__AVX2__)
+#include "vint8_avx2.h"
+#else
+#error "the 8-wide integer types require AVX2"
+#endif
+#include "vfloat8_avx.h"
+
+#if defined(__AVX512F__)
+#include "avx512.h"
+#endif
@@ -0,0 +1,10 @@
+// Copyright 2009-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "avx.h"
+
+#include "vboolf16_avx512.h"
+#include "vint16_avx512.h"
+#include "vfloat16_avx512.h"
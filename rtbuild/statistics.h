@@ -107,6 +107,19 @@ namespace embree
     void print    (std::ostream& cout) const;
     void print_raw(std::ostream& cout) const;
 
+    friend BVHStatistics operator+ (const BVHStatistics& a, const BVHStatistics& b)
+    {
+      BVHStatistics stats;
+      stats.numScenePrimitives = a.numScenePrimitives + b.numScenePrimitives;
+      stats.numBuildPrimitives = a.numBuildPrimitives + b.numBuildPrimitives;
+      stats.numBuildPrimitivesPostSplit = a.numBuildPrimitivesPostSplit + b.numBuildPrimitivesPostSplit;
+      stats.internalNode = a.internalNode + b.internalNode;
+      stats.quadLeaf = a.quadLeaf + b.quadLeaf;
+      stats.proceduralLeaf = a.proceduralLeaf + b.proceduralLeaf;
+      stats.instanceLeaf = a.instanceLeaf + b.instanceLeaf;
+      return stats;
+    }
+
     size_t numScenePrimitives;
     size_t numBuildPrimitives;
     size_t numBuildPrimitivesPostSplit;
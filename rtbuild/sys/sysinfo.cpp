@@ -509,6 +509,10 @@ namespace embree
     return (double)val.QuadPart / (double)freq.QuadPart;
   }
 
+  unsigned int getProcessID() {
+    return (unsigned int) GetCurrentProcessId();
+  }
+
   void sleepSeconds(double t) {
     Sleep(DWORD(1000.0*t));
   }
@@ -694,6 +698,10 @@ namespace embree
     return double(tp.tv_sec) + double(tp.tv_usec)/1E6;
   }
 
+  unsigned int getProcessID() {
+    return (unsigned int) getpid();
+  }
+
   void sleepSeconds(double t) {
     usleep(1000000.0*t);
   }
@@ -184,6 +184,9 @@ namespace embree
   /*! returns performance counter in seconds */
   double getSeconds();
 
+  /*! returns the identifier of the process */
+  unsigned int getProcessID();
+
   /*! sleeps the specified number of seconds */
   void sleepSeconds(double t);
 
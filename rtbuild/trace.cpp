@@ -0,0 +1,79 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "trace.h"
+
+#include <atomic>
+#include <mutex>
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+
+namespace embree
+{
+  const char* BuildTracer::ENVIRONMENT_VARIABLE = "ZE_RAYTRACING_BUILD_TRACE";
+
+  static std::atomic<uint32_t> g_nextBuildID(1);
+
+  /* state of the trace file shared by all builds traced through the environment */
+  static std::mutex g_appendMutex;
+  static bool g_appendStarted = false;
+
+  BuildTracer::BuildTracer ()
+    : buildID(g_nextBuildID++) {}
+
+  const char* BuildTracer::environmentFile()
+  {
+    static const char* fileName = getenv(ENVIRONMENT_VARIABLE);
+    return (fileName && *fileName) ? fileName : nullptr;
+  }
+
+  void BuildTracer::record(const char* name, double begin, double end, size_t numPrims)
+  {
+    const int thread = tbb::this_task_arena::current_thread_index();
+    events.local().push_back({ name, begin, end, uint32_t(thread < 0 ? 0 : thread), numPrims });
+  }
+
+  void BuildTracer::write(const char* fileName) const
+  {
+    std::ofstream out(fileName, std::ios::trunc);
+    if (!out) return; // tracing never lets a build fail
+    out << "[" << std::endl;
+    writeEvents(out,true);
+    out << std::endl << "]" << std::endl;
+  }
+
+  void BuildTracer::append(const char* fileName) const
+  {
+    std::lock_guard<std::mutex> lock(g_appendMutex);
+
+    /* the closing bracket of the JSON array is optional in the trace event format, thus we can keep appending */
+    const bool first = !g_appendStarted;
+    std::ofstream out(fileName, first ? std::ios::trunc : std::ios::app);
+    if (!out) return;
+    if (first) out << "[" << std::endl;
+    writeEvents(out,first);
+    out << std::flush;
+    g_appendStarted = true;
+  }
+
+  void BuildTracer::writeEvents(std::ostream& out, bool first) const
+  {
+    out << std::fixed << std::setprecision(3);
+    if (!first) out << "," << std::endl;
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << buildID << ",\"args\":{\"name\":\"RTAS build " << buildID << "\"}}";
+
+    for (const std::vector<Event>& threadEvents : events)
+    {
+      for (const Event& e : threadEvents)
+      {
+        out << "," << std::endl;
+        out << "{\"name\":\"" << e.name << "\",\"cat\":\"rtbuild\",\"ph\":\"X\"";
+        out << ",\"pid\":" << buildID << ",\"tid\":" << e.thread;
+        out << ",\"ts\":" << e.begin*1E6 << ",\"dur\":" << (e.end-e.begin)*1E6;
+        if (e.numPrims) out << ",\"args\":{\"prims\":" << e.numPrims << "}";
+        out << "}";
+      }
+    }
+  }
+}
@@ -0,0 +1,83 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "algorithms/parallel_for.h"
+#include "sys/sysinfo.h"
+
+#include <vector>
+
+namespace embree
+{
+  /*
+
+    Records the begin and end of build phases and large build tasks
+    and writes them as Chrome trace events, which can be inspected
+    with chrome://tracing or Perfetto. Each thread appends to its own
+    event buffer, thus recording takes no locks. Every traced build
+    shows up as its own process in the trace, the thread IDs are the
+    slots of the builder task arena.
+
+   */
+
+  class BuildTracer
+  {
+  public:
+
+    /* environment variable that enables tracing of all builds into the specified file */
+    static const char* ENVIRONMENT_VARIABLE;
+
+    struct Event
+    {
+      const char* name;   // static string naming the phase or task
+      double begin;       // begin time in seconds
+      double end;         // end time in seconds
+      uint32_t thread;    // slot of the recording thread in the task arena
+      uint64_t numPrims;  // number of primitives processed, 0 if not applicable
+    };
+
+    BuildTracer ();
+
+    /* returns the trace file specified through the environment, or nullptr */
+    static const char* environmentFile();
+
+    static double now() {
+      return getSeconds();
+    }
+
+    /* records an event into the buffer of the calling thread */
+    void record(const char* name, double begin, double end, size_t numPrims = 0);
+
+    /* writes the events of this build as a complete trace file */
+    void write(const char* fileName) const;
+
+    /* appends the events of this build to a trace file shared by all builds of the process */
+    void append(const char* fileName) const;
+
+  private:
+    void writeEvents(std::ostream& out, bool first) const;
+
+  private:
+    uint32_t buildID;
+    tbb::enumerable_thread_specific<std::vector<Event>> events;
+  };
+
+  /* records an event covering the lifetime of the scope, does nothing without tracer */
+  class TraceScope
+  {
+  public:
+    TraceScope (BuildTracer* tracer, const char* name, size_t numPrims = 0)
+      : tracer(tracer), name(name), numPrims(numPrims), begin(tracer ? BuildTracer::now() : 0.0) {}
+
+    __forceinline ~TraceScope() {
+      if (tracer) tracer->record(name,begin,BuildTracer::now(),numPrims);
+    }
+
+  private:
+    BuildTracer* tracer;
+    const char* name;
+    size_t numPrims;
+    double begin;
+  };
+}
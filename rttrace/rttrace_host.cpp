@@ -0,0 +1,156 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+/* the traversal has to get included first, as the headers of the rt_validation API rename the leaf types */
+#if !defined(__SYCL_DEVICE_ONLY__)
+#include "rtbuild/qbvh6_traversal.h"
+#endif
+
+#include "rttrace_validation.h"
+
+#include <optional>
+#include <stdexcept>
+
+#if !defined(EMBREE_SYCL_RT_SIMULATION)
+#error "the host implementation of the ray tracing hardware interface requires EMBREE_SYCL_RT_SIMULATION"
+#endif
+
+/*
+
+  Host implementation of the ray tracing hardware interface used by
+  the rt_validation API. Each thread owns an RTStack in host memory
+  and a ray query of the host traversal of the QBVH6 format.
+  intel_dispatch_trace_ray_query executes the
+  TRACE_RAY_INITIAL/INSTANCE/COMMIT/CONTINUE state machine of the
+  hardware by proceeding with that query, and stores the hits in the
+  RTStack the way the hardware does. The query stops at non-opaque
+  triangles and procedurals, and the next dispatch continues where the
+  previous one stopped. This allows to run ray query kernels on CPU
+  threads.
+
+ */
+
+#if !defined(__SYCL_DEVICE_ONLY__)
+
+namespace
+{
+  thread_local RTStack g_rtStack;
+  thread_local std::optional<embree::QBVH6RayQuery> g_rayQuery;
+
+  char g_dispatchGlobals[64];
+
+  /* the ray flags of the host traversal match the ray flags of the hardware */
+  embree::TraversalRay getRay(const MemRay& ray)
+  {
+    return embree::TraversalRay(embree::Vec3f(ray.org[0],ray.org[1],ray.org[2]),
+                                embree::Vec3f(ray.dir[0],ray.dir[1],ray.dir[2]),
+                                ray.tnear, ray.tfar, ray.rayMask, ray.rayFlags);
+  }
+
+  /* stores a hit of the host traversal the way the hardware reports it */
+  void setHit(MemHit& memHit, const embree::TraversalHit& hit, bool valid)
+  {
+    memHit.clear(false,valid);
+    memHit.setT(hit.t);
+    memHit.setU(hit.u);
+    memHit.setV(hit.v);
+    memHit.hitGroupRecPtr0 = 0;
+    memHit.hitGroupRecPtr1 = 0;
+    memHit.primLeafPtr = uint64_t(hit.primLeafPtr) / 64;
+    memHit.instLeafPtr = uint64_t(hit.instLeafPtr) / 64;
+    if (!hit.primLeafPtr) return;
+
+    /* the front face bit passes the opaque flag to the intersection shader of procedurals */
+    const bool triangle = hit.candidate == embree::TRAVERSAL_CANDIDATE_TRIANGLE;
+    memHit.leafType = triangle ? NODE_TYPE_QUAD : NODE_TYPE_PROCEDURAL;
+    memHit.primIndexDelta = triangle ? hit.primID - ((const QuadLeaf*) hit.primLeafPtr)->primIndex0 : 0;
+    memHit.primLeafIndex = hit.primLeafIndex;
+    memHit.bvhLevel = hit.bvhLevel;
+    memHit.frontFace = triangle ? hit.frontFace : hit.opaque;
+  }
+
+  /* the ray of a hardware instance is stored in the RTStack when traversal stops inside of it */
+  void setInstanceRay(RTStack& rtStack, const embree::QBVH6RayQuery& query, const embree::TraversalHit& hit)
+  {
+    if (!hit.instLeafPtr) return;
+
+    const embree::TraversalRay& ray = query.ray(hit.bvhLevel);
+    MemRay& memRay = rtStack.ray[hit.bvhLevel];
+    memRay = rtStack.ray[0];
+    memRay.org[0] = ray.org.x; memRay.org[1] = ray.org.y; memRay.org[2] = ray.org.z;
+    memRay.dir[0] = ray.dir.x; memRay.dir[1] = ray.dir.y; memRay.dir[2] = ray.dir.z;
+    memRay.rootNodePtr = hit.instLeafPtr->part0.startNodePtr;
+    memRay.instLeafPtr = (uint64_t) hit.instLeafPtr;
+  }
+}
+
+__attribute__((opencl_global)) void* intel_get_implicit_dispatch_globals() {
+  return (__attribute__((opencl_global)) void*) g_dispatchGlobals;
+}
+
+void* intel_get_rt_stack(rtglobals_t rt_dispatch_globals) {
+  return &g_rtStack;
+}
+
+void* intel_get_thread_btd_stack(rtglobals_t rt_dispatch_globals) {
+  return nullptr;
+}
+
+void* intel_get_global_btd_stack(rtglobals_t rt_dispatch_globals) {
+  return nullptr;
+}
+
+rtfence_t intel_dispatch_trace_ray_query(rtglobals_t rt_dispatch_globals, unsigned int bvh_level, unsigned int traceRayCtrl)
+{
+  RTStack& rtStack = g_rtStack;
+  std::optional<embree::QBVH6RayQuery>& query = g_rayQuery;
+
+  switch (traceRayCtrl)
+  {
+  case TRACE_RAY_INITIAL:
+  {
+    const embree::TraversalRay ray = getRay(rtStack.ray[0]);
+    query.emplace(ray);
+    query->push(embree::QBVH6::Node(rtStack.ray[0].rootNodePtr), ray.tnear);
+    break;
+  }
+  case TRACE_RAY_INSTANCE:
+  {
+    const MemRay& ray = rtStack.ray[bvh_level];
+    query->forward(bvh_level, embree::QBVH6::Node(ray.rootNodePtr), getRay(ray));
+    break;
+  }
+  case TRACE_RAY_COMMIT:
+  {
+    /* the intersection shader may have set distance and barycentrics of the potential hit */
+    embree::TraversalHit& potentialHit = query->potentialHit();
+    potentialHit.t = rtStack.potentialHit.getT();
+    potentialHit.u = rtStack.potentialHit.getU();
+    potentialHit.v = rtStack.potentialHit.getV();
+    query->commit();
+    break;
+  }
+  case TRACE_RAY_CONTINUE:
+    break;
+
+  default:
+    throw std::runtime_error("invalid trace ray control");
+  }
+
+  const bool stopped = query->proceed();
+  setHit(rtStack.committedHit, query->committedHit(), query->committedHit().valid);
+
+  if (stopped) {
+    setHit(rtStack.potentialHit, query->potentialHit(), true);
+    setInstanceRay(rtStack, *query, query->potentialHit());
+  }
+  else
+    rtStack.potentialHit.clear(true,true);
+
+  return nullptr;
+}
+
+void intel_rt_sync(rtfence_t fence) {
+}
+
+#endif
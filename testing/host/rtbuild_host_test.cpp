@@ -0,0 +1,2337 @@
+// Copyright 2009-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../../rtbuild/rtbuild.h"
+#include "../../rtbuild/qbvh6_traversal.h"
+#include "../../rtbuild/capture.h"
+#include "../../rtbuild/serialize.h"
+#include "../../rtbuild/sys/alloc.h"
+
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <memory>
+#include <random>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cstring>
+#include <cmath>
+
+/*
+
+  Host only tests of the RTAS builder. The tests build synthetic scenes
+  through the builder API and check the properties of the results,
+  they need neither SYCL nor a GPU. The hits of the host side QBVH6
+  traversal get checked against intersecting all primitives.
+  Acceleration structures that are expected to be equivalent get
+  compared by the hits of a fixed set of rays, not by their bytes, as
+  for instance the builds of different ISAs or chunked builds may
+  legally order nodes and primitives differently.
+
+ */
+
+using namespace embree;
+namespace fs = std::filesystem;
+
+/* number of rays traced to compare acceleration structures */
+static const size_t NUM_RAYS = 4096;
+
+/* maximal number of errors printed per test */
+static const uint32_t MAX_PRINTED_ERRORS = 16;
+
+enum class SceneType
+{
+  TRIANGLE_GRID,   // regular grid of displaced triangles
+  TRIANGLE_SOUP,   // random small triangles inside the unit cube
+  BOXES,           // random procedural boxes inside the unit cube
+  INSTANCES,       // instances of two triangle meshes
+  MIXED,           // random triangles mixed with procedural boxes
+  OUTLIER_GRID,    // triangle grid with one triangle far away from it
+};
+
+static const char* sceneName(SceneType type)
+{
+  switch (type) {
+  case SceneType::TRIANGLE_GRID: return "grid";
+  case SceneType::TRIANGLE_SOUP: return "soup";
+  case SceneType::BOXES        : return "boxes";
+  case SceneType::INSTANCES    : return "instances";
+  case SceneType::MIXED        : return "mixed";
+  case SceneType::OUTLIER_GRID : return "outlier";
+  }
+  return "unknown";
+}
+
+static const char* qualityName(ze_rtas_builder_build_quality_hint_exp_t quality)
+{
+  switch (quality) {
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW   : return "low";
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM: return "medium";
+  case ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH  : return "high";
+  default: return "unknown";
+  }
+}
+
+static const ze_rtas_builder_build_quality_hint_exp_t ALL_QUALITIES[] = {
+  ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH
+};
+
+/* buffer with the alignment the builder requires for acceleration structures */
+struct AlignedBuffer
+{
+  AlignedBuffer (size_t bytes = 0)
+    : ptr(bytes ? alignedMalloc(bytes,128) : nullptr), bytes(bytes) {}
+
+  ~AlignedBuffer() {
+    if (ptr) alignedFree(ptr);
+  }
+
+  AlignedBuffer(const AlignedBuffer&) = delete;
+  AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+public:
+  void* ptr;
+  size_t bytes;
+};
+
+/* triangle mesh in the layout passed to the builder */
+struct TriangleMesh
+{
+  ze_rtas_builder_triangles_geometry_info_exp_t geometryInfo() const
+  {
+    ze_rtas_builder_triangles_geometry_info_exp_t info;
+    memset(&info,0,sizeof(info));
+    info.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_TRIANGLES;
+    info.geometryFlags = 0;
+    info.geometryMask = 0xFF;
+    info.triangleFormat = ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_TRIANGLE_INDICES_UINT32;
+    info.vertexFormat = ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3;
+    info.triangleCount = (uint32_t) triangles.size();
+    info.triangleStride = sizeof(ze_rtas_triangle_indices_uint32_exp_t);
+    info.pTriangleBuffer = (void*) triangles.data();
+    info.vertexCount = (uint32_t) vertices.size();
+    info.vertexStride = sizeof(ze_rtas_float3_exp_t);
+    info.pVertexBuffer = (void*) vertices.data();
+    return info;
+  }
+
+public:
+  std::vector<ze_rtas_float3_exp_t> vertices;
+  std::vector<ze_rtas_triangle_indices_uint32_exp_t> triangles;
+};
+
+/* procedural boxes, the bounds get returned through the bounds callback */
+struct ProceduralBoxes
+{
+  static void getBounds(ze_rtas_geometry_aabbs_exp_cb_params_t* params)
+  {
+    const ProceduralBoxes* boxes = (const ProceduralBoxes*) params->pGeomUserPtr;
+    for (uint32_t i=0; i<params->primIDCount; i++)
+      params->pBoundsOut[i] = boxes->bounds[params->primID+i];
+  }
+
+  ze_rtas_builder_procedural_geometry_info_exp_t geometryInfo() const
+  {
+    ze_rtas_builder_procedural_geometry_info_exp_t info;
+    memset(&info,0,sizeof(info));
+    info.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_PROCEDURAL;
+    info.geometryFlags = 0;
+    info.geometryMask = 0xFF;
+    info.primCount = (uint32_t) bounds.size();
+    info.pfnGetBoundsCb = getBounds;
+    info.pGeomUserPtr = (void*) this;
+    return info;
+  }
+
+public:
+  std::vector<ze_rtas_aabb_exp_t> bounds;
+};
+
+/* all geometry of a test scene */
+struct Scene
+{
+  Scene (SceneType type, size_t numPrimitives)
+    : type(type), numPrimitives(numPrimitives), rayBounds({ { 0.0f, 0.0f, 0.0f }, { -1.0f, -1.0f, -1.0f } }) {}
+
+public:
+  SceneType type;
+  size_t numPrimitives;
+  ze_rtas_aabb_exp_t rayBounds;  // region the rays get traced into if not empty, otherwise the scene bounds
+  std::vector<TriangleMesh> meshes;
+  std::vector<ProceduralBoxes> procedurals;
+  std::vector<ze_rtas_transform_float3x4_column_major_exp_t> transforms;
+  std::vector<TriangleMesh> instancedMeshes;
+  std::vector<ze_rtas_aabb_exp_t> instancedBounds;
+  std::vector<std::shared_ptr<AlignedBuffer>> instancedAccels;
+
+  std::vector<ze_rtas_builder_triangles_geometry_info_exp_t> triangleInfos;
+  std::vector<ze_rtas_builder_procedural_geometry_info_exp_t> proceduralInfos;
+  std::vector<ze_rtas_builder_instance_geometry_info_exp_t> instanceInfos;
+  std::vector<const ze_rtas_builder_geometry_info_exp_t*> geometries;
+};
+
+static void addGrid(TriangleMesh& mesh, size_t numTriangles, std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> displace(0.0f,0.1f);
+  const size_t numQuads = (numTriangles+1)/2;
+  const size_t width = std::max(size_t(1),(size_t) std::ceil(std::sqrt(double(numQuads))));
+  const size_t height = (numQuads+width-1)/width;
+
+  const uint32_t base = (uint32_t) mesh.vertices.size();
+  for (size_t y=0; y<=height; y++)
+    for (size_t x=0; x<=width; x++)
+      mesh.vertices.push_back({ float(x), float(y), displace(rng) });
+
+  for (size_t i=0; i<numTriangles; i++)
+  {
+    const size_t x = (i/2) % width;
+    const size_t y = (i/2) / width;
+    const uint32_t v00 = base + uint32_t(y*(width+1)+x);
+    const uint32_t v01 = v00+1;
+    const uint32_t v10 = v00+uint32_t(width+1);
+    const uint32_t v11 = v10+1;
+    if (i%2 == 0) mesh.triangles.push_back({ v00, v01, v10 });
+    else          mesh.triangles.push_back({ v11, v10, v01 });
+  }
+}
+
+static void addSoup(TriangleMesh& mesh, size_t numTriangles, std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> uniform(0.0f,1.0f);
+  const float size = 2.0f / std::cbrt(float(std::max(size_t(1),numTriangles)));
+
+  for (size_t i=0; i<numTriangles; i++)
+  {
+    const float px = uniform(rng), py = uniform(rng), pz = uniform(rng);
+    const uint32_t base = (uint32_t) mesh.vertices.size();
+    for (size_t j=0; j<3; j++)
+      mesh.vertices.push_back({ px + size*uniform(rng), py + size*uniform(rng), pz + size*uniform(rng) });
+    mesh.triangles.push_back({ base, base+1, base+2 });
+  }
+}
+
+static void addBoxes(ProceduralBoxes& boxes, size_t numBoxes, std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> uniform(0.0f,1.0f);
+  const float size = 2.0f / std::cbrt(float(std::max(size_t(1),numBoxes)));
+
+  for (size_t i=0; i<numBoxes; i++)
+  {
+    const float px = uniform(rng), py = uniform(rng), pz = uniform(rng);
+    boxes.bounds.push_back({ { px, py, pz }, { px + size*uniform(rng), py + size*uniform(rng), pz + size*uniform(rng) } });
+  }
+}
+/* build configuration, the extension descriptors get chained when requested */
+struct BuildConfig
+{
+  BuildConfig (ze_rtas_builder_build_quality_hint_exp_t quality = ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,
+               ze_rtas_builder_build_op_exp_flags_t flags = 0)
+    : quality(quality), flags(flags), quadify(false), scratchBudgetBytes(0), rayDistribution(nullptr), statistics(nullptr), traceFile(nullptr), captureFile(nullptr), hash(nullptr) {}
+
+public:
+  ze_rtas_builder_build_quality_hint_exp_t quality;
+  ze_rtas_builder_build_op_exp_flags_t flags;
+  bool quadify;                // pairs the triangles to estimate the buffer sizes
+  size_t scratchBudgetBytes;   // limits the scratch buffer size if not zero
+  const ze_rtas_builder_build_op_ray_distribution_exp_desc_t* rayDistribution;  // orders the children if not null
+  ze_rtas_builder_build_op_statistics_exp_desc_t* statistics;                    // receives the build statistics if not null
+  const char* traceFile;                                                         // receives a trace of the build if not null
+  const char* captureFile;                                                       // receives a capture of the build if not null
+  ze_rtas_builder_build_op_hash_exp_desc_t* hash;                                // receives the hash of the build inputs if not null
+};
+
+/* build operation descriptor of a scene, with the extension descriptors it points to */
+struct BuildOp
+{
+  BuildOp (const Scene& scene, const BuildConfig& config)
+  {
+    const void* next = nullptr;
+
+    memset(&estimate,0,sizeof(estimate));
+    estimate.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_ESTIMATE_EXP_DESC;
+    estimate.flags = ZE_RTAS_BUILDER_BUILD_OP_ESTIMATE_EXP_FLAG_QUADIFY;
+    if (config.quadify) {
+      estimate.pNext = next;
+      next = &estimate;
+    }
+
+    memset(&streaming,0,sizeof(streaming));
+    if (config.scratchBudgetBytes) {
+      streaming.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STREAMING_EXP_DESC;
+      streaming.pNext = next;
+      streaming.scratchBudgetBytes = config.scratchBudgetBytes;
+      next = &streaming;
+    }
+
+    memset(&rayDistribution,0,sizeof(rayDistribution));
+    if (config.rayDistribution) {
+      rayDistribution = *config.rayDistribution;
+      rayDistribution.pNext = next;
+      next = &rayDistribution;
+    }
+
+    if (config.statistics) {
+      config.statistics->stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_STATISTICS_EXP_DESC;
+      config.statistics->pNext = next;
+      next = config.statistics;
+    }
+
+    memset(&trace,0,sizeof(trace));
+    if (config.traceFile) {
+      trace.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_TRACE_EXP_DESC;
+      trace.pNext = next;
+      trace.pTraceFile = config.traceFile;
+      next = &trace;
+    }
+
+    memset(&capture,0,sizeof(capture));
+    if (config.captureFile) {
+      capture.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_CAPTURE_EXP_DESC;
+      capture.pNext = next;
+      capture.pCaptureFile = config.captureFile;
+      next = &capture;
+    }
+
+    if (config.hash) {
+      config.hash->stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_HASH_EXP_DESC;
+      config.hash->pNext = next;
+      next = config.hash;
+    }
+
+    memset(&args,0,sizeof(args));
+    args.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_EXP_DESC;
+    args.pNext = next;
+    args.rtasFormat = (ze_rtas_format_exp_t) ZE_RTAS_DEVICE_FORMAT_EXP_VERSION_1;
+    args.buildQuality = config.quality;
+    args.buildFlags = config.flags;
+    args.ppGeometries = (const ze_rtas_builder_geometry_info_exp_t**) scene.geometries.data();
+    args.numGeometries = (uint32_t) scene.geometries.size();
+  }
+
+  BuildOp(const BuildOp&) = delete;
+  BuildOp& operator=(const BuildOp&) = delete;
+
+public:
+  ze_rtas_builder_build_op_estimate_exp_desc_t estimate;
+  ze_rtas_builder_build_op_streaming_exp_desc_t streaming;
+  ze_rtas_builder_build_op_ray_distribution_exp_desc_t rayDistribution;
+  ze_rtas_builder_build_op_trace_exp_desc_t trace;
+  ze_rtas_builder_build_op_capture_exp_desc_t capture;
+  ze_rtas_builder_build_op_exp_desc_t args;
+};
+
+static ze_rtas_builder_exp_properties_t getBuildProperties(ze_rtas_builder_exp_handle_t hBuilder, const Scene& scene, const BuildConfig& config)
+{
+  BuildOp op(scene,config);
+  ze_rtas_builder_exp_properties_t props;
+  memset(&props,0,sizeof(props));
+  props.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_EXP_PROPERTIES;
+  if (zeRTASBuilderGetBuildPropertiesExpImpl(hBuilder,&op.args,&props) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("get build properties failed");
+  return props;
+}
+
+/* builds the scene into the provided buffer, a scratch buffer of size zero gets passed as null pointer */
+static ze_result_t buildInto(ze_rtas_builder_exp_handle_t hBuilder, const Scene& scene, const BuildConfig& config,
+                             AlignedBuffer& scratch, AlignedBuffer& accel, ze_rtas_aabb_exp_t* boundsOut, size_t* rtasBytesOut)
+{
+  BuildOp op(scene,config);
+  ze_rtas_aabb_exp_t bounds;
+  size_t rtasBytes = 0;
+  ze_result_t err = zeRTASBuilderBuildExpImpl(hBuilder,&op.args,scratch.ptr,scratch.bytes,accel.ptr,accel.bytes,
+                                              nullptr,nullptr,&bounds,&rtasBytes);
+  if (boundsOut) *boundsOut = bounds;
+  if (rtasBytesOut) *rtasBytesOut = rtasBytes;
+  return err;
+}
+
+/* builds the scene into a buffer of the worst case size */
+static std::shared_ptr<AlignedBuffer> build(ze_rtas_builder_exp_handle_t hBuilder, const Scene& scene, const BuildConfig& config,
+                                            ze_rtas_aabb_exp_t* boundsOut = nullptr)
+{
+  const ze_rtas_builder_exp_properties_t props = getBuildProperties(hBuilder,scene,config);
+  AlignedBuffer scratch(props.scratchBufferSizeBytes);
+  std::shared_ptr<AlignedBuffer> accel = std::make_shared<AlignedBuffer>(props.rtasBufferSizeBytesMaxRequired);
+  if (buildInto(hBuilder,scene,config,scratch,*accel,boundsOut,nullptr) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("build failed");
+  return accel;
+}
+
+static std::unique_ptr<Scene> createScene(ze_rtas_builder_exp_handle_t hBuilder, SceneType type, size_t numPrimitives)
+{
+  std::unique_ptr<Scene> scene(new Scene(type,numPrimitives));
+  std::mt19937 rng(0x56FE238A);
+
+  switch (type)
+  {
+  case SceneType::TRIANGLE_GRID:
+    scene->meshes.resize(1);
+    addGrid(scene->meshes[0],numPrimitives,rng);
+    break;
+
+  case SceneType::TRIANGLE_SOUP:
+    scene->meshes.resize(1);
+    addSoup(scene->meshes[0],numPrimitives,rng);
+    break;
+
+  case SceneType::OUTLIER_GRID:
+  {
+    /* the outlier squeezes all other primitives into few cells of a uniform grid over the centroids */
+    scene->meshes.resize(1);
+    TriangleMesh& mesh = scene->meshes[0];
+    addGrid(mesh,numPrimitives-1,rng);
+    scene->rayBounds = { { 0.0f, 0.0f, 0.0f }, { mesh.vertices.back().x, mesh.vertices.back().y, 0.1f } };
+    const uint32_t base = (uint32_t) mesh.vertices.size();
+    mesh.vertices.push_back({ 1E6f, 1E6f, 1E6f });
+    mesh.vertices.push_back({ 1E6f+1.0f, 1E6f, 1E6f });
+    mesh.vertices.push_back({ 1E6f, 1E6f+1.0f, 1E6f });
+    mesh.triangles.push_back({ base, base+1, base+2 });
+    break;
+  }
+
+  case SceneType::BOXES:
+    scene->procedurals.resize(1);
+    addBoxes(scene->procedurals[0],numPrimitives,rng);
+    break;
+
+  case SceneType::MIXED:
+    scene->meshes.resize(1);
+    scene->procedurals.resize(1);
+    addSoup(scene->meshes[0],numPrimitives-numPrimitives/2,rng);
+    addBoxes(scene->procedurals[0],numPrimitives/2,rng);
+    break;
+
+  case SceneType::INSTANCES:
+  {
+    /* two different meshes, such that relocation has to distinguish the instanced acceleration structures */
+    scene->instancedMeshes.resize(2);
+    addSoup(scene->instancedMeshes[0],1000,rng);
+    addGrid(scene->instancedMeshes[1],512,rng);
+    for (const TriangleMesh& mesh : scene->instancedMeshes)
+    {
+      ze_rtas_builder_triangles_geometry_info_exp_t info = mesh.geometryInfo();
+      Scene blas(SceneType::TRIANGLE_SOUP,info.triangleCount);
+      blas.geometries.push_back((const ze_rtas_builder_geometry_info_exp_t*) &info);
+      ze_rtas_aabb_exp_t bounds;
+      scene->instancedAccels.push_back(build(hBuilder,blas,BuildConfig(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH),&bounds));
+      scene->instancedBounds.push_back(bounds);
+    }
+
+    /* instances are placed on a jittered grid with random rotation around the y axis and random scale */
+    std::uniform_real_distribution<float> uniform(0.0f,1.0f);
+    const size_t width = std::max(size_t(1),(size_t) std::ceil(std::sqrt(double(numPrimitives))));
+    for (size_t i=0; i<numPrimitives; i++)
+    {
+      const float angle = 2.0f*float(M_PI)*uniform(rng);
+      const float scale = 0.5f + 0.5f*uniform(rng);
+      const float c = scale*std::cos(angle), s = scale*std::sin(angle);
+      const float px = float(i%width) + 0.5f*uniform(rng);
+      const float pz = float(i/width) + 0.5f*uniform(rng);
+      ze_rtas_transform_float3x4_column_major_exp_t xfm = {
+        c, 0.0f, -s,
+        0.0f, scale, 0.0f,
+        s, 0.0f, c,
+        px, 0.0f, pz
+      };
+      scene->transforms.push_back(xfm);
+    }
+    break;
+  }
+  }
+
+  for (auto& mesh : scene->meshes)
+    scene->triangleInfos.push_back(mesh.geometryInfo());
+
+  for (auto& boxes : scene->procedurals)
+    scene->proceduralInfos.push_back(boxes.geometryInfo());
+
+  for (auto& xfm : scene->transforms)
+  {
+    const size_t accelID = scene->instanceInfos.size() % scene->instancedAccels.size();
+    ze_rtas_builder_instance_geometry_info_exp_t info;
+    memset(&info,0,sizeof(info));
+    info.geometryType = ZE_RTAS_BUILDER_GEOMETRY_TYPE_EXP_INSTANCE;
+    info.instanceFlags = 0;
+    info.geometryMask = 0xFF;
+    info.transformFormat = ZE_RTAS_BUILDER_INPUT_DATA_FORMAT_EXP_FLOAT3X4_COLUMN_MAJOR;
+    info.instanceUserID = (uint32_t) scene->instanceInfos.size();
+    info.pTransform = (float*) &xfm;
+    info.pBounds = &scene->instancedBounds[accelID];
+    info.pAccelerationStructure = scene->instancedAccels[accelID]->ptr;
+    scene->instanceInfos.push_back(info);
+  }
+
+  for (auto& info : scene->triangleInfos)
+    scene->geometries.push_back((const ze_rtas_builder_geometry_info_exp_t*) &info);
+  for (auto& info : scene->proceduralInfos)
+    scene->geometries.push_back((const ze_rtas_builder_geometry_info_exp_t*) &info);
+  for (auto& info : scene->instanceInfos)
+    scene->geometries.push_back((const ze_rtas_builder_geometry_info_exp_t*) &info);
+
+  return scene;
+}
+
+/* intersects the procedural boxes of the scene, the geometry descriptor leads to the boxes of the hit geometry */
+static bool intersectProcedural(void* userPtr, const TraversalRay& ray, TraversalHit& potentialHit)
+{
+  const Scene* scene = (const Scene*) userPtr;
+  const ze_rtas_builder_procedural_geometry_info_exp_t* info = (const ze_rtas_builder_procedural_geometry_info_exp_t*) scene->geometries[potentialHit.geomID];
+  const ze_rtas_aabb_exp_t& box = ((const ProceduralBoxes*) info->pGeomUserPtr)->bounds[potentialHit.primID];
+
+  const Vec3f lower(box.lower.x,box.lower.y,box.lower.z);
+  const Vec3f upper(box.upper.x,box.upper.y,box.upper.z);
+  const Vec3f rdir = rcp_safe(ray.dir);
+  const Vec3f t0 = (lower-ray.org)*rdir;
+  const Vec3f t1 = (upper-ray.org)*rdir;
+  const float tnear = max(ray.tnear,reduce_max(min(t0,t1)));
+  const float tfar = min(ray.tfar,reduce_min(max(t0,t1)));
+  if (tnear > tfar) return false;
+
+  potentialHit.t = tnear;
+  potentialHit.u = potentialHit.v = 0.0f;
+  return true;
+}
+
+/* rays from a sphere around the scene towards random points inside the scene bounds, or inside the ray bounds of the scene if set */
+static std::vector<TraversalRay> createRays(const Scene& scene, const ze_rtas_aabb_exp_t& sceneBounds, size_t numRays)
+{
+  std::mt19937 rng(0x1234567);
+  std::uniform_real_distribution<float> uniform(0.0f,1.0f);
+  const ze_rtas_aabb_exp_t& bounds = scene.rayBounds.lower.x <= scene.rayBounds.upper.x ? scene.rayBounds : sceneBounds;
+  const Vec3f lower(bounds.lower.x,bounds.lower.y,bounds.lower.z);
+  const Vec3f upper(bounds.upper.x,bounds.upper.y,bounds.upper.z);
+  const Vec3f center = 0.5f*(lower+upper);
+  const float radius = length(upper-lower);
+
+  std::vector<TraversalRay> rays;
+  for (size_t i=0; i<numRays; i++)
+  {
+    const float phi = 2.0f*float(M_PI)*uniform(rng);
+    const float cosTheta = 2.0f*uniform(rng)-1.0f;
+    const float sinTheta = std::sqrt(1.0f-cosTheta*cosTheta);
+    const Vec3f org = center + radius*Vec3f(sinTheta*std::cos(phi),sinTheta*std::sin(phi),cosTheta);
+    const Vec3f target = lower + Vec3f(uniform(rng),uniform(rng),uniform(rng))*(upper-lower);
+    rays.push_back(TraversalRay(org,target-org));
+  }
+  return rays;
+}
+
+static std::vector<TraversalHit> traceRays(const void* accel, const Scene& scene, const std::vector<TraversalRay>& rays)
+{
+  QBVH6Traversal traversal((const QBVH6*) accel,nullptr,intersectProcedural,(void*) &scene);
+  std::vector<TraversalHit> hits(rays.size());
+  for (size_t i=0; i<rays.size(); i++)
+    traversal.intersect(rays[i],hits[i]);
+  return hits;
+}
+
+/* compares the closest hit distances, where several primitives share the closest hit equivalent
+ * acceleration structures may report different ones */
+static uint32_t compareHits(const std::string& name, const std::vector<TraversalHit>& test, const std::vector<TraversalHit>& expected)
+{
+  uint32_t numErrors = 0;
+  for (size_t i=0; i<expected.size(); i++)
+  {
+    const bool valid = i < test.size() && test[i].valid == expected[i].valid;
+    if (valid && (!expected[i].valid || std::fabs(test[i].t-expected[i].t) <= 1E-5f*std::max(1.0f,expected[i].t)))
+      continue;
+
+    if (numErrors < MAX_PRINTED_ERRORS) {
+      std::cout << name << ": ray " << i << " mismatch: ";
+      if (i < test.size()) std::cout << "output (" << test[i].valid << ", " << test[i].t << ")";
+      else                 std::cout << "output missing";
+      std::cout << " != expected (" << expected[i].valid << ", " << expected[i].t << ")" << std::endl;
+    }
+    numErrors++;
+  }
+  return numErrors;
+}
+
+
+static uint32_t check(const std::string& name, bool condition, const std::string& message)
+{
+  if (condition) return 0;
+  std::cout << name << ": " << message << std::endl;
+  return 1;
+}
+
+static ze_rtas_builder_exp_handle_t createBuilder()
+{
+  ze_rtas_builder_exp_desc_t builderDesc;
+  memset(&builderDesc,0,sizeof(builderDesc));
+  builderDesc.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_EXP_DESC;
+  builderDesc.builderVersion = ZE_RTAS_BUILDER_EXP_VERSION_CURRENT;
+
+  /* the internal builder does not use the driver handle */
+  ze_rtas_builder_exp_handle_t hBuilder = nullptr;
+  if (zeRTASBuilderCreateExpImpl((ze_driver_handle_t)1,&builderDesc,&hBuilder) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("ze_rtas_builder creation failed");
+  return hBuilder;
+}
+
+static void destroyBuilder(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  if (zeRTASBuilderDestroyExpImpl(hBuilder) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("ze_rtas_builder destruction failed");
+}
+
+/* the worst case size always has to suffice, builds starting with the expected size have to
+ * succeed by retrying with the reported sizes */
+static uint32_t testEstimate(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,10000);
+    for (auto quality : ALL_QUALITIES)
+    {
+      for (bool quadify : { false, true })
+      {
+        for (ze_rtas_builder_build_op_exp_flags_t flags : { 0, (int) ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS })
+        {
+          BuildConfig config(quality,flags);
+          config.quadify = quadify;
+          const std::string name = std::string("estimate ") + sceneName(type) + " " + qualityName(quality) +
+            (quadify ? " quadify" : "") + (flags ? " back pointers" : "");
+
+          const ze_rtas_builder_exp_properties_t props = getBuildProperties(hBuilder,*scene,config);
+          numErrors += check(name,props.rtasBufferSizeBytesExpected <= props.rtasBufferSizeBytesMaxRequired,
+                             "expected size " + std::to_string(props.rtasBufferSizeBytesExpected) + " exceeds worst case size " + std::to_string(props.rtasBufferSizeBytesMaxRequired));
+
+          AlignedBuffer scratch(props.scratchBufferSizeBytes);
+          AlignedBuffer worstCase(props.rtasBufferSizeBytesMaxRequired);
+          size_t rtasBytes = 0;
+          ze_result_t err = buildInto(hBuilder,*scene,config,scratch,worstCase,nullptr,&rtasBytes);
+          numErrors += check(name,err == ZE_RESULT_SUCCESS,"build into worst case size failed with error " + std::to_string(err));
+          numErrors += check(name,rtasBytes <= props.rtasBufferSizeBytesMaxRequired,
+                             "used size " + std::to_string(rtasBytes) + " exceeds worst case size " + std::to_string(props.rtasBufferSizeBytesMaxRequired));
+          if (err != ZE_RESULT_SUCCESS) continue;
+
+          /* each retry has to grow the buffer without exceeding the worst case size */
+          size_t bytes = props.rtasBufferSizeBytesExpected;
+          err = ZE_RESULT_EXP_RTAS_BUILD_RETRY;
+          while (err == ZE_RESULT_EXP_RTAS_BUILD_RETRY)
+          {
+            AlignedBuffer accel(bytes);
+            err = buildInto(hBuilder,*scene,config,scratch,accel,nullptr,&bytes);
+            if (err == ZE_RESULT_EXP_RTAS_BUILD_RETRY && (bytes <= accel.bytes || bytes > props.rtasBufferSizeBytesMaxRequired)) {
+              numErrors += check(name,false,"retry size " + std::to_string(bytes) + " does not grow the buffer of " + std::to_string(accel.bytes) + " bytes within the worst case size");
+              break;
+            }
+          }
+          if (err != ZE_RESULT_EXP_RTAS_BUILD_RETRY)
+            numErrors += check(name,err == ZE_RESULT_SUCCESS,"build into expected size failed with error " + std::to_string(err));
+        }
+      }
+    }
+  }
+  return numErrors;
+}
+
+/* each internal node stores the index of its parent above bit 6 and its number of children in bits 3 to 5,
+ * the index of a node is its 64 byte block relative to the node data, all other entries stay zero */
+static uint32_t checkBackPointers(const std::string& name, const QBVH6* bvh)
+{
+  if (!bvh->hasBackPointers())
+    return check(name,false,"no back pointers");
+
+  const uint32_t* backPointers = (const uint32_t*)((const char*)bvh + 64*(size_t)bvh->backPointerDataStart);
+  const size_t numBackPointers = 16*(size_t)(bvh->backPointerDataEnd - bvh->backPointerDataStart);
+  std::vector<bool> visited(numBackPointers,false);
+
+  uint32_t numErrors = 0;
+  std::vector<std::pair<QBVH6::Node,uint32_t>> stack;
+  stack.push_back(std::make_pair(bvh->root(),0x03FFFFFFu));
+  while (!stack.empty())
+  {
+    const QBVH6::Node node = stack.back().first;
+    const uint32_t parentID = stack.back().second;
+    stack.pop_back();
+    if (node.type != NODE_TYPE_INTERNAL) continue;
+
+    const QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+    const uint32_t nodeID = uint32_t(((const char*)inner - (const char*)bvh)/64) - bvh->nodeDataStart;
+    uint32_t numChildren = 0;
+    for (uint32_t i=0; i<6; i++)
+      numChildren += inner->valid(i);
+
+    if (nodeID >= numBackPointers) {
+      numErrors += check(name,false,"node " + std::to_string(nodeID) + " outside of the back pointer array");
+      continue;
+    }
+    visited[nodeID] = true;
+
+    const uint32_t entry = backPointers[nodeID];
+    if ((entry >> 6) != parentID || ((entry >> 3) & 7) != numChildren)
+    {
+      if (numErrors < MAX_PRINTED_ERRORS)
+        std::cout << name << ": node " << nodeID << " back pointer " << std::hex << entry << std::dec
+                  << " != expected parent " << parentID << " with " << numChildren << " children" << std::endl;
+      numErrors++;
+    }
+
+    for (uint32_t i=0; i<6; i++)
+      if (inner->valid(i)) stack.push_back(std::make_pair(inner->child(i),nodeID));
+  }
+
+  size_t numStale = 0;
+  for (size_t i=0; i<numBackPointers; i++)
+    numStale += !visited[i] && backPointers[i] != 0;
+  numErrors += check(name,numStale == 0,std::to_string(numStale) + " back pointers of blocks that are no internal nodes are not zero");
+  return numErrors;
+}
+
+static uint32_t testBackPointers(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,20000);
+    ze_rtas_aabb_exp_t bounds;
+    std::shared_ptr<AlignedBuffer> reference = build(hBuilder,*scene,BuildConfig(),&bounds);
+    const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+    const std::vector<TraversalHit> expected = traceRays(reference->ptr,*scene,rays);
+    const size_t scratchBytes = getBuildProperties(hBuilder,*scene,BuildConfig()).scratchBufferSizeBytes;
+
+    for (auto quality : ALL_QUALITIES)
+    {
+      for (int mode=0; mode<3; mode++)
+      {
+        BuildConfig config(quality,ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS);
+        if (mode == 1) config.flags |= ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SCRATCH_IN_RTAS_BUFFER;
+        if (mode == 2) config.scratchBudgetBytes = scratchBytes/8;
+        const char* modeNames[] = { "", " tail", " streaming" };
+        const std::string name = std::string("back pointers ") + sceneName(type) + " " + qualityName(quality) + modeNames[mode];
+
+        std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,config);
+        numErrors += checkBackPointers(name,(const QBVH6*) accel->ptr);
+        numErrors += compareHits(name,traceRays(accel->ptr,*scene,rays),expected);
+      }
+    }
+  }
+  return numErrors;
+}
+
+/* priority of a box for a single ray direction as the builder computes it, children with higher priority come first */
+static float childPriority(const BBox3f& box, const Vec3f& dir, ze_rtas_builder_child_order_exp_t order)
+{
+  const Vec3f size = box.size();
+  if (order == ZE_RTAS_BUILDER_CHILD_ORDER_EXP_HIT_PROBABILITY)
+    return std::fabs(dir.x)*size.y*size.z + std::fabs(dir.y)*size.x*size.z + std::fabs(dir.z)*size.x*size.y;
+
+  const Vec3f nearPlane(dir.x >= 0.0f ? box.lower.x : box.upper.x, dir.y >= 0.0f ? box.lower.y : box.upper.y, dir.z >= 0.0f ? box.lower.z : box.upper.z);
+  return -dot(nearPlane,dir);
+}
+
+/* the builder sorts the children by their exact bounds, whereas the nodes store the bounds rounded outwards
+ * to the quantization grid, thus the order gets checked with the exact bounds of the second child shrunk
+ * and moved by up to one grid step where that lowers its priority */
+static uint32_t checkChildOrder(const std::string& name, const QBVH6* bvh, const Vec3f& dir, ze_rtas_builder_child_order_exp_t order)
+{
+  uint32_t numErrors = 0;
+  size_t numOrdered = 0;
+  std::vector<QBVH6::Node> stack(1,bvh->root());
+  while (!stack.empty())
+  {
+    const QBVH6::Node node = stack.back();
+    stack.pop_back();
+    if (node.type != NODE_TYPE_INTERNAL) continue;
+
+    const QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+    const Vec3f step = 1.5f*Vec3f(ldexpf(1.0f,inner->exp_x-8),ldexpf(1.0f,inner->exp_y-8),ldexpf(1.0f,inner->exp_z-8));
+    for (uint32_t i=0; i+1<6 && inner->valid(i+1); i++)
+    {
+      const BBox3f first = inner->bounds(i);
+      const BBox3f second = inner->bounds(i+1);
+      const Vec3f shift(dir.x >= 0.0f ? step.x : -step.x, dir.y >= 0.0f ? step.y : -step.y, dir.z >= 0.0f ? step.z : -step.z);
+      const BBox3f lowest = order == ZE_RTAS_BUILDER_CHILD_ORDER_EXP_HIT_PROBABILITY
+        ? BBox3f(second.lower, max(second.lower,second.upper-2.0f*step))
+        : BBox3f(second.lower+shift, second.upper+shift);
+
+      if (childPriority(first,dir,order) >= childPriority(lowest,dir,order)) {
+        numOrdered++;
+        continue;
+      }
+      if (numErrors < MAX_PRINTED_ERRORS)
+        std::cout << name << ": child " << i << " " << first << " stored before child " << i+1 << " " << second << std::endl;
+      numErrors++;
+    }
+
+    for (uint32_t i=0; i<6; i++)
+      if (inner->valid(i)) stack.push_back(inner->child(i));
+  }
+  numErrors += check(name,numOrdered > 0,"no children to order");
+  return numErrors;
+}
+
+/* the children of all internal nodes have to follow the order of the provided ray distribution */
+static uint32_t testChildOrder(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,20000);
+    for (auto order : { ZE_RTAS_BUILDER_CHILD_ORDER_EXP_HIT_PROBABILITY, ZE_RTAS_BUILDER_CHILD_ORDER_EXP_DISTANCE })
+    {
+      /* the weights make the second direction dominate, thus the order has to differ from the one of the first direction alone */
+      const ze_rtas_float3_exp_t directions[] = { { 1.0f, 0.0f, 0.0f }, { 0.3f, -1.0f, 0.5f } };
+      const float weights[] = { 1.0f, 1000.0f };
+      ze_rtas_builder_build_op_ray_distribution_exp_desc_t rayDistribution;
+      memset(&rayDistribution,0,sizeof(rayDistribution));
+      rayDistribution.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_RAY_DISTRIBUTION_EXP_DESC;
+      rayDistribution.childOrder = order;
+      rayDistribution.numDirections = 2;
+      rayDistribution.pDirections = directions;
+      rayDistribution.pWeights = weights;
+
+      BuildConfig config;
+      config.rayDistribution = &rayDistribution;
+      const std::string name = std::string("child order ") + sceneName(type) + (order == ZE_RTAS_BUILDER_CHILD_ORDER_EXP_DISTANCE ? " distance" : " hit probability");
+      std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,config);
+      numErrors += checkChildOrder(name,(const QBVH6*) accel->ptr,normalize(Vec3f(0.3f,-1.0f,0.5f)),order);
+    }
+  }
+
+  /* an invalid child order and a missing direction array have to get rejected by the validation */
+  std::unique_ptr<Scene> scene = createScene(hBuilder,SceneType::TRIANGLE_SOUP,100);
+  const ze_rtas_float3_exp_t direction = { 1.0f, 0.0f, 0.0f };
+  for (int invalid=0; invalid<2; invalid++)
+  {
+    ze_rtas_builder_build_op_ray_distribution_exp_desc_t rayDistribution;
+    memset(&rayDistribution,0,sizeof(rayDistribution));
+    rayDistribution.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_BUILD_OP_RAY_DISTRIBUTION_EXP_DESC;
+    rayDistribution.childOrder = invalid == 0 ? (ze_rtas_builder_child_order_exp_t) 0x7F : ZE_RTAS_BUILDER_CHILD_ORDER_EXP_DISTANCE;
+    rayDistribution.numDirections = 1;
+    rayDistribution.pDirections = invalid == 0 ? &direction : nullptr;
+
+    BuildConfig config;
+    config.rayDistribution = &rayDistribution;
+    BuildOp op(*scene,config);
+    ze_rtas_builder_exp_properties_t props;
+    memset(&props,0,sizeof(props));
+    props.stype = ZE_STRUCTURE_TYPE_RTAS_BUILDER_EXP_PROPERTIES;
+    const ze_result_t err = zeRTASBuilderGetBuildPropertiesExpImpl(hBuilder,&op.args,&props);
+    if (invalid == 0) numErrors += check("child order",err == ZE_RESULT_ERROR_INVALID_ENUMERATION,"invalid child order accepted");
+    else              numErrors += check("child order",err == ZE_RESULT_ERROR_INVALID_NULL_POINTER,"missing directions accepted");
+  }
+  return numErrors;
+}
+
+/* SAH cost with unit costs for internal nodes and leaves, computed from the bounds as stored in
+ * the nodes, thus from the quantized bounds the hardware sees */
+static double quantizedSAH(const QBVH6* bvh)
+{
+  double sah = 0.0;
+  std::vector<std::pair<QBVH6::Node,float>> stack;
+  stack.push_back(std::make_pair(bvh->root(),0.0f));
+  float rootArea = 0.0f;
+  while (!stack.empty())
+  {
+    const QBVH6::Node node = stack.back().first;
+    const float nodeArea = stack.back().second;
+    stack.pop_back();
+    if (node.type != NODE_TYPE_INTERNAL) {
+      sah += nodeArea;
+      continue;
+    }
+
+    const QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+    if (rootArea == 0.0f) rootArea = halfArea(inner->bounds());
+    sah += nodeArea;
+    for (uint32_t i=0; i<6; i++)
+      if (inner->valid(i)) stack.push_back(std::make_pair(inner->child(i),halfArea(inner->bounds(i))));
+  }
+  return sah/rootArea;
+}
+
+/* the quantized SAH evaluates the child bounds as the nodes store them, building with it must not
+ * increase the SAH cost of the stored bounds, which varies in both directions by a fraction of a percent */
+static uint32_t testQuantizedSAH(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+
+  /* the bounds the SAH gets evaluated on have to be the stored bounds */
+  std::mt19937 rng(0x2A4F91);
+  std::uniform_real_distribution<float> uniform(0.0f,1.0f);
+  for (size_t i=0; i<10000; i++)
+  {
+    const Vec3f lower(100.0f*uniform(rng)-50.0f,100.0f*uniform(rng)-50.0f,100.0f*uniform(rng)-50.0f);
+    const Vec3f size = Vec3f(uniform(rng),uniform(rng),uniform(rng))*std::pow(10.0f,4.0f*uniform(rng)-2.0f);
+    const BBox3f nodeBounds(lower,lower+size);
+    const Vec3f a = lower + Vec3f(uniform(rng),uniform(rng),uniform(rng))*size;
+    const Vec3f b = lower + Vec3f(uniform(rng),uniform(rng),uniform(rng))*size;
+    const BBox3f childBounds(min(a,b),max(a,b));
+
+    QBVH6::InternalNode6 node(nodeBounds);
+    node.setChildBounds(0,childBounds);
+    const BBox3f stored = node.bounds(0);
+    const BBox3f quantized = node.quantized_bounds(childBounds);
+    if (stored.lower == quantized.lower && stored.upper == quantized.upper && subset(childBounds,stored))
+      continue;
+    if (numErrors < MAX_PRINTED_ERRORS)
+      std::cout << "quantized sah: child " << childBounds << " of node " << nodeBounds << " stored as " << stored << " evaluated as " << quantized << std::endl;
+    numErrors++;
+  }
+
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,50000);
+    for (auto quality : ALL_QUALITIES)
+    {
+      const std::string name = std::string("quantized sah ") + sceneName(type) + " " + qualityName(quality);
+      std::shared_ptr<AlignedBuffer> reference = build(hBuilder,*scene,BuildConfig(quality));
+      std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig(quality,ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_QUANTIZED_SAH));
+      const double referenceSAH = quantizedSAH((const QBVH6*) reference->ptr);
+      const double sah = quantizedSAH((const QBVH6*) accel->ptr);
+      numErrors += check(name,sah != referenceSAH,"flag does not change the BVH");
+      numErrors += check(name,sah <= 1.01*referenceSAH,"SAH cost " + std::to_string(sah) + " exceeds the cost " + std::to_string(referenceSAH) + " of the normal build");
+    }
+  }
+  return numErrors;
+}
+
+/* walks the procedural leaf lists of all procedural children, counts how often each primitive of the
+ * procedural geometry gets referenced and the number of distinct procedural leaf blocks */
+static uint32_t checkProceduralLeaves(const std::string& name, const QBVH6* bvh, uint32_t geomID, size_t numPrimitives, size_t& numBlocks)
+{
+  uint32_t numErrors = 0;
+  std::vector<uint32_t> numReferences(numPrimitives,0);
+  std::vector<const ProceduralLeaf*> blocks;
+  std::vector<QBVH6::Node> stack(1,bvh->root());
+  while (!stack.empty())
+  {
+    QBVH6::Node node = stack.back();
+    stack.pop_back();
+
+    if (node.type == NODE_TYPE_INTERNAL)
+    {
+      const QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+      for (uint32_t i=0; i<6; i++)
+        if (inner->valid(i)) stack.push_back(inner->child(i));
+    }
+    else if (node.type == NODE_TYPE_PROCEDURAL)
+    {
+      /* the list continues in the next block when it reaches the end of a block */
+      uint32_t slot = node.cur_prim;
+      for (bool last=false; !last; )
+      {
+        const ProceduralLeaf* leaf = node.leafNodeProcedural();
+        blocks.push_back(leaf);
+        last = leaf->isLast(slot);
+        if (leaf->leafDesc.geomIndex != geomID || leaf->primIndex(slot) >= numPrimitives) {
+          numErrors += check(name,false,"invalid procedural primitive " + std::to_string(leaf->primIndex(slot)) + " of geometry " + std::to_string(leaf->leafDesc.geomIndex));
+          break;
+        }
+        numReferences[leaf->primIndex(slot)]++;
+        if (++slot >= leaf->size()) {
+          slot = 0;
+          node.node += sizeof(ProceduralLeaf);
+        }
+      }
+    }
+  }
+
+  size_t numWrong = 0;
+  for (uint32_t n : numReferences)
+    numWrong += n != 1;
+  numErrors += check(name,numWrong == 0,std::to_string(numWrong) + " procedural primitives not referenced exactly once");
+
+  std::sort(blocks.begin(),blocks.end());
+  numBlocks = std::unique(blocks.begin(),blocks.end()) - blocks.begin();
+  return numErrors;
+}
+
+/* packed procedural leaves have to reference each primitive once and need fewer blocks, close to
+ * the minimum of one block per ProceduralLeaf::N primitives when all procedurals share one geometry */
+static uint32_t testPackProcedurals(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::BOXES, SceneType::MIXED })
+  {
+    for (size_t numPrimitives : { 100, 10000, 100000 })
+    {
+      std::unique_ptr<Scene> scene = createScene(hBuilder,type,numPrimitives);
+      const uint32_t geomID = (uint32_t) scene->meshes.size();
+      const size_t numProcedurals = scene->procedurals[0].bounds.size();
+      const size_t minBlocks = (numProcedurals+ProceduralLeaf::N-1)/ProceduralLeaf::N;
+      for (auto quality : ALL_QUALITIES)
+      {
+        const std::string name = std::string("pack procedurals ") + sceneName(type) + " " + std::to_string(numPrimitives) + " " + qualityName(quality);
+        size_t numBlocks = 0, numPackedBlocks = 0;
+        std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig(quality));
+        numErrors += checkProceduralLeaves(name,(const QBVH6*) accel->ptr,geomID,numProcedurals,numBlocks);
+        accel = build(hBuilder,*scene,BuildConfig(quality,ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_PACK_PROCEDURALS));
+        numErrors += checkProceduralLeaves(name + " packed",(const QBVH6*) accel->ptr,geomID,numProcedurals,numPackedBlocks);
+        numErrors += check(name,numPackedBlocks < numBlocks,"packing does not reduce the " + std::to_string(numBlocks) + " procedural leaf blocks");
+        if (type == SceneType::BOXES)
+          numErrors += check(name,numPackedBlocks <= minBlocks + minBlocks/5,
+                             std::to_string(numPackedBlocks) + " packed procedural leaf blocks exceed the minimum " + std::to_string(minBlocks) + " by more than 20%");
+      }
+    }
+  }
+  return numErrors;
+}
+
+static void intersectTriangles(const TriangleMesh& mesh, uint32_t geomID, const TraversalRay& ray, TraversalHit& hit)
+{
+  for (uint32_t primID=0; primID<mesh.triangles.size(); primID++)
+  {
+    const ze_rtas_triangle_indices_uint32_exp_t& tri = mesh.triangles[primID];
+    const Vec3f v0(mesh.vertices[tri.v0].x,mesh.vertices[tri.v0].y,mesh.vertices[tri.v0].z);
+    const Vec3f v1(mesh.vertices[tri.v1].x,mesh.vertices[tri.v1].y,mesh.vertices[tri.v1].z);
+    const Vec3f v2(mesh.vertices[tri.v2].x,mesh.vertices[tri.v2].y,mesh.vertices[tri.v2].z);
+    const Vec3f e1 = v1-v0, e2 = v2-v0;
+    const Vec3f p = cross(ray.dir,e2);
+    const float det = dot(e1,p);
+    if (det == 0.0f) continue;
+    const Vec3f o = ray.org-v0;
+    const float u = dot(o,p)/det;
+    const Vec3f q = cross(o,e1);
+    const float v = dot(ray.dir,q)/det;
+    const float t = dot(e2,q)/det;
+    if (u < 0.0f || v < 0.0f || u+v > 1.0f || !(ray.tnear <= t && t < hit.t)) continue;
+    hit.valid = true;
+    hit.t = t;
+    hit.geomID = geomID;
+    hit.primID = primID;
+  }
+}
+
+/* closest hits found by intersecting each ray with all primitives of the scene */
+static std::vector<TraversalHit> intersectAll(const Scene& scene, const std::vector<TraversalRay>& rays)
+{
+  std::vector<TraversalHit> hits(rays.size());
+  for (size_t i=0; i<rays.size(); i++)
+  {
+    const TraversalRay& ray = rays[i];
+    TraversalHit& hit = hits[i];
+    uint32_t geomID = 0;
+    for (const TriangleMesh& mesh : scene.meshes)
+      intersectTriangles(mesh,geomID++,ray,hit);
+
+    for (const ProceduralBoxes& boxes : scene.procedurals)
+    {
+      for (uint32_t primID=0; primID<boxes.bounds.size(); primID++)
+      {
+        TraversalHit potentialHit;
+        potentialHit.candidate = TRAVERSAL_CANDIDATE_PROCEDURAL;
+        potentialHit.geomID = geomID;
+        potentialHit.primID = primID;
+        TraversalRay localRay = ray;
+        localRay.tfar = hit.t;
+        if (intersectProcedural((void*) &scene,localRay,potentialHit) && potentialHit.t < hit.t) {
+          hit = potentialHit;
+          hit.valid = true;
+        }
+      }
+      geomID++;
+    }
+
+    /* the direction gets transformed without normalization, thus the hit distances of both spaces agree */
+    for (const ze_rtas_builder_instance_geometry_info_exp_t& info : scene.instanceInfos)
+    {
+      const float* m = (const float*) info.pTransform;
+      const AffineSpace3f local2world(LinearSpace3f(Vec3f(m[0],m[1],m[2]),Vec3f(m[3],m[4],m[5]),Vec3f(m[6],m[7],m[8])),Vec3f(m[9],m[10],m[11]));
+      const AffineSpace3f world2local = rcp(local2world);
+      const TraversalRay localRay(xfmPoint(world2local,ray.org),xfmVector(world2local,ray.dir),ray.tnear,ray.tfar);
+      const size_t accelID = info.instanceUserID % scene.instancedMeshes.size();
+      intersectTriangles(scene.instancedMeshes[accelID],0,localRay,hit);
+    }
+  }
+  return hits;
+}
+
+/* the traversal has to find the closest hits of intersecting all primitives */
+static uint32_t testTraversal(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::BOXES, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,type == SceneType::INSTANCES ? 20 : 2000);
+    for (auto quality : ALL_QUALITIES)
+    {
+      const std::string name = std::string("traversal ") + sceneName(type) + " " + qualityName(quality);
+      ze_rtas_aabb_exp_t bounds;
+      std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig(quality),&bounds);
+      const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+      const std::vector<TraversalHit> hits = traceRays(accel->ptr,*scene,rays);
+      numErrors += compareHits(name,hits,intersectAll(*scene,rays));
+
+      size_t numHits = 0;
+      for (const TraversalHit& hit : hits) numHits += hit.valid;
+      numErrors += check(name,numHits > NUM_RAYS/4,"only " + std::to_string(numHits) + " rays hit the scene");
+    }
+  }
+  return numErrors;
+}
+
+/* the SIMD node test and the ray streams have to find the same hits as the scalar traversal */
+static uint32_t testTraversalModes(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,20000);
+    ze_rtas_aabb_exp_t bounds;
+    std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig(),&bounds);
+    const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+    const std::string name = std::string("traversal modes ") + sceneName(type);
+
+    QBVH6Traversal traversal((const QBVH6*) accel->ptr,nullptr,intersectProcedural,(void*) scene.get());
+    traversal.mode = TRAVERSAL_MODE_SCALAR;
+    std::vector<TraversalHit> expected(rays.size()), expectedOccluded(rays.size());
+    for (size_t i=0; i<rays.size(); i++) {
+      traversal.intersect(rays[i],expected[i]);
+      traversal.occluded(rays[i],expectedOccluded[i]);
+    }
+
+    traversal.mode = TRAVERSAL_MODE_SIMD;
+    std::vector<TraversalHit> hits(rays.size()), occluded(rays.size());
+    for (size_t i=0; i<rays.size(); i++) {
+      traversal.intersect(rays[i],hits[i]);
+      traversal.occluded(rays[i],occluded[i]);
+    }
+    numErrors += compareHits(name + " simd",hits,expected);
+
+    /* any hit may get reported, thus only the validity has to agree */
+    size_t numOccludedErrors = 0;
+    for (size_t i=0; i<rays.size(); i++)
+      numOccludedErrors += occluded[i].valid != expectedOccluded[i].valid || occluded[i].valid != expected[i].valid;
+    numErrors += check(name + " simd",numOccludedErrors == 0,std::to_string(numOccludedErrors) + " occlusion mismatches");
+
+    /* streams of the maximal size, a partial stream, and single rays */
+    for (size_t streamSize : { QBVH6Traversal::MAX_STREAM_SIZE, size_t(13), size_t(1) })
+    {
+      const std::string streamName = name + " stream " + std::to_string(streamSize);
+      std::vector<TraversalHit> streamHits(rays.size()), streamOccluded(rays.size());
+      for (size_t i=0; i<rays.size(); i+=streamSize) {
+        const size_t n = std::min(streamSize,rays.size()-i);
+        traversal.intersectStream(&rays[i],&streamHits[i],n);
+        traversal.occludedStream(&rays[i],&streamOccluded[i],n);
+      }
+      numErrors += compareHits(streamName,streamHits,expected);
+
+      size_t numStreamOccludedErrors = 0;
+      for (size_t i=0; i<rays.size(); i++)
+        numStreamOccludedErrors += streamOccluded[i].valid != expected[i].valid;
+      numErrors += check(streamName,numStreamOccludedErrors == 0,std::to_string(numStreamOccludedErrors) + " occlusion mismatches");
+    }
+  }
+  return numErrors;
+}
+
+/* Traces a ray with a ray query the way a ray query kernel does. The decision function gets invoked at
+ * each stop of the traversal and returns if the potential hit gets committed. */
+template<typename Decide>
+static TraversalHit traceRayQuery(const void* accel, const TraversalRay& ray, const Decide& decide)
+{
+  QBVH6RayQuery query(ray);
+  query.push(((const QBVH6*) accel)->root(),ray.tnear);
+  while (query.proceed()) {
+    if (decide(query)) query.commit();
+  }
+  return query.committedHit();
+}
+
+/* intersects the procedural at a stop of a ray query */
+static bool intersectProcedural(const Scene& scene, QBVH6RayQuery& query)
+{
+  TraversalHit& potentialHit = query.potentialHit();
+  TraversalRay ray = query.ray(potentialHit.bvhLevel);
+  ray.tfar = query.committedHit().t;
+  return intersectProcedural((void*) &scene,ray,potentialHit) && ray.tnear <= potentialHit.t && potentialHit.t <= ray.tfar;
+}
+
+/* ray queries that stop at every triangle and procedural, commit or ignore them, and forward rays to software instances */
+static uint32_t testRayQuery(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_SOUP, SceneType::BOXES, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,type == SceneType::INSTANCES ? 20 : 2000);
+    ze_rtas_aabb_exp_t bounds;
+    std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig(),&bounds);
+    std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+    const std::vector<TraversalHit> expected = intersectAll(*scene,rays);
+    const std::string name = std::string("ray query ") + sceneName(type);
+
+    /* forcing all triangles to be non-opaque stops traversal at each of them, committing all finds the closest hits */
+    for (TraversalRay& ray : rays) ray.flags = RAY_FLAGS_FORCE_NON_OPAQUE;
+    size_t numTriangleStops = 0;
+    std::vector<TraversalHit> hits(rays.size()), rejected(rays.size()), first(rays.size());
+    for (size_t i=0; i<rays.size(); i++)
+    {
+      hits[i] = traceRayQuery(accel->ptr,rays[i],[&] (QBVH6RayQuery& query) {
+        if (query.potentialHit().candidate == TRAVERSAL_CANDIDATE_PROCEDURAL)
+          return intersectProcedural(*scene,query);
+        numTriangleStops++;
+        return true;
+      });
+
+      /* ignoring all triangles leaves only the procedurals */
+      rejected[i] = traceRayQuery(accel->ptr,rays[i],[&] (QBVH6RayQuery& query) {
+        return query.potentialHit().candidate == TRAVERSAL_CANDIDATE_PROCEDURAL && intersectProcedural(*scene,query);
+      });
+
+      /* the first committed hit terminates traversal */
+      TraversalRay ray = rays[i];
+      ray.flags |= RAY_FLAGS_ACCEPT_FIRST_HIT_AND_END_SEARCH;
+      first[i] = traceRayQuery(accel->ptr,ray,[&] (QBVH6RayQuery& query) {
+        return query.potentialHit().candidate == TRAVERSAL_CANDIDATE_TRIANGLE || intersectProcedural(*scene,query);
+      });
+    }
+    numErrors += compareHits(name,hits,expected);
+    numErrors += check(name,scene->procedurals.size() || numTriangleStops >= NUM_RAYS/4,"only " + std::to_string(numTriangleStops) + " stops at triangles");
+
+    size_t numRejectErrors = 0, numFirstErrors = 0;
+    for (size_t i=0; i<rays.size(); i++) {
+      numRejectErrors += rejected[i].valid && rejected[i].candidate != TRAVERSAL_CANDIDATE_PROCEDURAL;
+      numRejectErrors += expected[i].valid && expected[i].candidate == TRAVERSAL_CANDIDATE_PROCEDURAL && !rejected[i].valid;
+      numFirstErrors += first[i].valid != expected[i].valid;
+    }
+    numErrors += check(name + " reject",numRejectErrors == 0,std::to_string(numRejectErrors) + " wrong hits");
+    numErrors += check(name + " first hit",numFirstErrors == 0,std::to_string(numFirstErrors) + " occlusion mismatches");
+  }
+
+  /* The boxes act as software instances of a triangle soup, the intersection of a box forwards the ray
+   * to the soup. The closest hit of the soup has to get found at the second BVH level for all rays
+   * that hit any box. */
+  {
+    std::unique_ptr<Scene> boxes = createScene(hBuilder,SceneType::BOXES,200);
+    std::unique_ptr<Scene> soup = createScene(hBuilder,SceneType::TRIANGLE_SOUP,2000);
+    ze_rtas_aabb_exp_t bounds;
+    std::shared_ptr<AlignedBuffer> boxesAccel = build(hBuilder,*boxes,BuildConfig(),&bounds);
+    std::shared_ptr<AlignedBuffer> soupAccel = build(hBuilder,*soup,BuildConfig());
+    const std::vector<TraversalRay> rays = createRays(*boxes,bounds,NUM_RAYS);
+    const std::vector<TraversalHit> expectedBoxes = intersectAll(*boxes,rays);
+    const std::vector<TraversalHit> expectedSoup = intersectAll(*soup,rays);
+
+    size_t numWrong = 0, numForwarded = 0;
+    for (size_t i=0; i<rays.size(); i++)
+    {
+      bool forwarded = false;
+      const TraversalHit hit = traceRayQuery(boxesAccel->ptr,rays[i],[&] (QBVH6RayQuery& query) {
+        if (!forwarded && query.potentialHit().bvhLevel == 0 && intersectProcedural(*boxes,query)) {
+          query.forward(1,((const QBVH6*) soupAccel->ptr)->root(),query.ray(0));
+          forwarded = true;
+          return false;
+        }
+        return query.potentialHit().bvhLevel == 1;
+      });
+      numForwarded += forwarded;
+
+      const bool valid = expectedBoxes[i].valid && expectedSoup[i].valid;
+      if (hit.valid != valid || (valid && (hit.bvhLevel != 1 || std::fabs(hit.t-expectedSoup[i].t) > 1E-5f*std::max(1.0f,hit.t))))
+        numWrong++;
+    }
+    numErrors += check("ray query forward",numWrong == 0,std::to_string(numWrong) + " wrong hits");
+    numErrors += check("ray query forward",numForwarded >= NUM_RAYS/4,"only " + std::to_string(numForwarded) + " rays got forwarded");
+  }
+  return numErrors;
+}
+
+/* counts the internal nodes, the leaves of each type, and the quad leaves holding a triangle pair, and sums up
+ * the areas of the internal nodes relative to the root as the SAH of the internal nodes */
+struct NodeCounts
+{
+  NodeCounts (const QBVH6* bvh)
+    : numInternalNodes(0), numQuadLeaves(0), numProceduralLeaves(0), numInstanceLeaves(0), numTrianglePairs(0), internalNodeSAH(0.0)
+  {
+    const float rootArea = area(bvh->bounds);
+    std::vector<std::pair<QBVH6::Node,float>> stack(1,std::make_pair(bvh->root(),rootArea));
+    while (!stack.empty())
+    {
+      QBVH6::Node node = stack.back().first;
+      const float nodeArea = stack.back().second;
+      stack.pop_back();
+
+      if (node.type == NODE_TYPE_INTERNAL)
+      {
+        numInternalNodes++;
+        internalNodeSAH += nodeArea/rootArea;
+        const QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+        for (uint32_t i=0; i<6; i++)
+          if (inner->valid(i)) stack.push_back(std::make_pair(inner->child(i),area(inner->bounds(i))));
+      }
+      else if (node.type == NODE_TYPE_QUAD)
+      {
+        numQuadLeaves++;
+        for (bool last=false; !last; node.node += sizeof(QuadLeaf)) {
+          last = node.leafNodeQuad()->isLast();
+          numTrianglePairs += node.leafNodeQuad()->size() == 2;
+        }
+      }
+      else if (node.type == NODE_TYPE_PROCEDURAL) numProceduralLeaves++;
+      else if (node.type == NODE_TYPE_INSTANCE) numInstanceLeaves++;
+    }
+  }
+
+public:
+  size_t numInternalNodes;
+  size_t numQuadLeaves;
+  size_t numProceduralLeaves;
+  size_t numInstanceLeaves;
+  size_t numTrianglePairs;
+  double internalNodeSAH;
+};
+
+/* the counters of the build statistics have to match the input and the built nodes, the phase times have to add up
+ * to at most the total time, and a build that runs out of memory has to report the retry without node counts */
+static uint32_t testBuildStatistics(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,20000);
+    size_t numTriangles = 0;
+    for (const TriangleMesh& mesh : scene->meshes) numTriangles += mesh.triangles.size();
+    const size_t numInputPrimitives = numTriangles + (scene->procedurals.empty() ? 0 : scene->procedurals[0].bounds.size()) + scene->instanceInfos.size();
+
+    for (auto quality : ALL_QUALITIES)
+    {
+      const std::string name = std::string("build statistics ") + sceneName(type) + " " + qualityName(quality);
+      ze_rtas_builder_build_op_statistics_exp_desc_t stats;
+      memset(&stats,0,sizeof(stats));
+      BuildConfig config(quality);
+      config.statistics = &stats;
+
+      const ze_rtas_builder_exp_properties_t props = getBuildProperties(hBuilder,*scene,config);
+      AlignedBuffer scratch(props.scratchBufferSizeBytes), accel(props.rtasBufferSizeBytesMaxRequired);
+      size_t rtasBytes = 0;
+      if (buildInto(hBuilder,*scene,config,scratch,accel,nullptr,&rtasBytes) != ZE_RESULT_SUCCESS)
+        throw std::runtime_error("build failed");
+
+      const NodeCounts counts((const QBVH6*) accel.ptr);
+      const bool presplit = quality == ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH;
+      numErrors += check(name,stats.numInputPrimitives == numInputPrimitives,"wrong number of input primitives " + std::to_string(stats.numInputPrimitives));
+      numErrors += check(name,stats.numInputTriangles == numTriangles,"wrong number of input triangles " + std::to_string(stats.numInputTriangles));
+      numErrors += check(name,stats.numPrimitives + stats.numTrianglePairs == numInputPrimitives,"triangle pairs " + std::to_string(stats.numTrianglePairs) + " and primitives " + std::to_string(stats.numPrimitives) + " do not add up");
+      numErrors += check(name,std::fabs(stats.quadPairingRate*numTriangles - 2.0f*stats.numTrianglePairs) <= 1E-3f*numTriangles,"wrong pairing rate " + std::to_string(stats.quadPairingRate));
+      numErrors += check(name,stats.numValidPrimitives == stats.numPrimitives,"valid primitives got filtered out");
+      numErrors += check(name,presplit ? stats.numBuildPrimitives >= stats.numValidPrimitives : stats.numBuildPrimitives == stats.numValidPrimitives,
+                         "wrong number of build primitives " + std::to_string(stats.numBuildPrimitives));
+      if (!presplit)
+        numErrors += check(name,counts.numTrianglePairs == stats.numTrianglePairs,std::to_string(counts.numTrianglePairs) + " triangle pairs stored");
+
+      numErrors += check(name,stats.numInternalNodes == counts.numInternalNodes,"wrong number of internal nodes " + std::to_string(stats.numInternalNodes) + " != " + std::to_string(counts.numInternalNodes));
+      numErrors += check(name,stats.numQuadLeaves == counts.numQuadLeaves,"wrong number of quad leaves " + std::to_string(stats.numQuadLeaves) + " != " + std::to_string(counts.numQuadLeaves));
+      numErrors += check(name,stats.numProceduralLeaves == counts.numProceduralLeaves,"wrong number of procedural leaves " + std::to_string(stats.numProceduralLeaves) + " != " + std::to_string(counts.numProceduralLeaves));
+      numErrors += check(name,stats.numInstanceLeaves == counts.numInstanceLeaves,"wrong number of instance leaves " + std::to_string(stats.numInstanceLeaves) + " != " + std::to_string(counts.numInstanceLeaves));
+      numErrors += check(name,stats.rtasBytesUsed == rtasBytes && stats.rtasBytesProvided == accel.bytes && !stats.retry,"wrong buffer sizes or retry reported");
+
+      const double phases[] = { stats.setupSeconds, stats.quadifySeconds, stats.primRefSeconds, stats.filterSeconds, stats.presplitSeconds, stats.hierarchySeconds, stats.finalizeSeconds };
+      double sum = 0.0;
+      for (double t : phases) {
+        numErrors += check(name,t >= 0.0,"negative phase time");
+        sum += t;
+      }
+      numErrors += check(name,stats.totalSeconds > 0.0 && sum <= stats.totalSeconds*(1.0+1E-6),"phase times " + std::to_string(sum) + " exceed total time " + std::to_string(stats.totalSeconds));
+
+      /* a too small buffer reports the retry, the required bytes exceed the provided ones */
+      memset(&stats,0,sizeof(stats));
+      AlignedBuffer small(props.rtasBufferSizeBytesExpected/4);
+      numErrors += check(name,buildInto(hBuilder,*scene,config,scratch,small,nullptr,nullptr) == ZE_RESULT_EXP_RTAS_BUILD_RETRY,"build into small buffer did not fail");
+      numErrors += check(name,stats.retry && stats.rtasBytesProvided == small.bytes && stats.rtasBytesUsed > small.bytes && stats.numInternalNodes == 0,"retry not reported");
+    }
+  }
+  return numErrors;
+}
+
+/* returns the value of a numeric field of a trace event, or -1 if the event has no such field */
+static double traceField(const std::string& event, const std::string& field)
+{
+  const size_t pos = event.find("\"" + field + "\":");
+  if (pos == std::string::npos) return -1.0;
+  return atof(event.c_str() + pos + field.size() + 3);
+}
+
+/* the trace of a build has to be a complete JSON array with an event for each phase, the serial splits at the
+ * top of the tree, and the subtrees built by single threads, which together cover all primitives */
+static uint32_t testBuildTrace(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  const std::string traceFile = (fs::temp_directory_path() / ("rtbuild_host_test_trace_" + std::to_string(std::random_device()()) + ".json")).string();
+  std::unique_ptr<Scene> scene = createScene(hBuilder,SceneType::TRIANGLE_SOUP,100000);
+
+  for (auto quality : ALL_QUALITIES)
+  {
+    const std::string name = std::string("build trace ") + qualityName(quality);
+    BuildConfig config(quality);
+    config.traceFile = traceFile.c_str();
+    build(hBuilder,*scene,config);
+
+    std::ifstream in(traceFile);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(text,line); )
+      lines.push_back(line);
+
+    if (lines.size() < 3 || lines.front() != "[" || lines.back() != "]") {
+      numErrors += check(name,false,"trace is not a JSON array");
+      continue;
+    }
+
+    std::vector<std::string> phases;
+    size_t subtreePrims = 0;
+    size_t numSplits = 0;
+    for (size_t i=1; i+1<lines.size(); i++)
+    {
+      const std::string event = lines[i].substr(0,lines[i].find_last_not_of(',')+1);
+      numErrors += check(name,event.front() == '{' && event.back() == '}',"malformed event " + event);
+      if (event.find("\"ph\":\"X\"") == std::string::npos) continue;
+
+      const size_t nameBegin = event.find("\"name\":\"") + 8;
+      const std::string eventName = event.substr(nameBegin,event.find('"',nameBegin)-nameBegin);
+      numErrors += check(name,traceField(event,"dur") >= 0.0 && traceField(event,"ts") >= 0.0,"wrong time of event " + event);
+
+      if (eventName == "subtree") {
+        numErrors += check(name,traceField(event,"prims") <= 1024,"subtree event above the single thread threshold");
+        subtreePrims += (size_t) traceField(event,"prims");
+      }
+      else if (eventName == "SAHSplit") {
+        numErrors += check(name,traceField(event,"prims") > 1024,"split event below the single thread threshold");
+        numSplits++;
+      }
+      else
+        phases.push_back(eventName);
+    }
+
+    std::vector<std::string> expected = { "quadification", "primrefgen", "bvh_build", "scene_size", "finalize" };
+    if (quality == ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH) expected.insert(expected.begin()+2,"presplit");
+    std::sort(phases.begin(),phases.end());
+    std::sort(expected.begin(),expected.end());
+    numErrors += check(name,phases == expected,"wrong phase events");
+    numErrors += check(name,numSplits > 0,"no split events");
+    numErrors += check(name,subtreePrims >= scene->numPrimitives/2,"subtree events cover only " + std::to_string(subtreePrims) + " primitives");
+  }
+
+  fs::remove(traceFile);
+  return numErrors;
+}
+
+/* the statistics query has to match a walk over the built nodes and the build statistics, and has to reject
+ * invalid arguments */
+static uint32_t testRtasStatistics(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::BOXES, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,20000);
+    size_t numTriangles = 0;
+    for (const TriangleMesh& mesh : scene->meshes) numTriangles += mesh.triangles.size();
+    const size_t numProcedurals = scene->procedurals.empty() ? 0 : scene->procedurals[0].bounds.size();
+
+    for (auto quality : ALL_QUALITIES)
+    {
+      const std::string name = std::string("rtas statistics ") + sceneName(type) + " " + qualityName(quality);
+      ze_rtas_builder_build_op_statistics_exp_desc_t buildStats;
+      memset(&buildStats,0,sizeof(buildStats));
+      BuildConfig config(quality);
+      config.statistics = &buildStats;
+      ze_rtas_aabb_exp_t bounds;
+      std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,config,&bounds);
+
+      ze_rtas_statistics_exp_t stats;
+      memset(&stats,0,sizeof(stats));
+      stats.stype = ZE_STRUCTURE_TYPE_RTAS_STATISTICS_EXP;
+      if (zeRTASGetStatisticsExpImpl(accel->ptr,&stats) != ZE_RESULT_SUCCESS) {
+        numErrors += check(name,false,"query failed");
+        continue;
+      }
+
+      const NodeCounts counts((const QBVH6*) accel->ptr);
+      numErrors += check(name,stats.internalNodes.numNodes == counts.numInternalNodes && stats.internalNodes.numNodes == buildStats.numInternalNodes,
+                         "wrong number of internal nodes " + std::to_string(stats.internalNodes.numNodes));
+      numErrors += check(name,stats.internalNodes.numBytes == 64*counts.numInternalNodes,"wrong size of internal nodes");
+      numErrors += check(name,std::fabs(stats.internalNodes.sah - counts.internalNodeSAH) <= 1E-5*counts.internalNodeSAH,
+                         "internal node SAH " + std::to_string(stats.internalNodes.sah) + " != " + std::to_string(counts.internalNodeSAH));
+      numErrors += check(name,stats.quadLeaves.numLeaves == counts.numQuadLeaves && stats.proceduralLeaves.numLeaves == counts.numProceduralLeaves &&
+                         stats.instanceLeaves.numLeaves == counts.numInstanceLeaves,"wrong number of leaves");
+      if (quality != ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH)
+        numErrors += check(name,stats.quadLeaves.numPrimsUsed == numTriangles,"wrong number of stored triangles " + std::to_string(stats.quadLeaves.numPrimsUsed));
+      numErrors += check(name,stats.proceduralLeaves.numPrimsUsed == numProcedurals,"wrong number of stored procedurals");
+      numErrors += check(name,stats.instanceLeaves.numPrimsUsed == scene->instanceInfos.size(),"wrong number of stored instances");
+
+      const double sah = stats.internalNodes.sah + stats.quadLeaves.sah + stats.proceduralLeaves.sah + stats.instanceLeaves.sah;
+      const uint64_t numBytes = stats.internalNodes.numBytes + stats.quadLeaves.numBytesTotal + stats.proceduralLeaves.numBytesTotal + stats.instanceLeaves.numBytesTotal;
+      numErrors += check(name,stats.sah == sah && stats.sah > 1.0,"wrong total SAH " + std::to_string(stats.sah));
+      numErrors += check(name,stats.numBytes == numBytes && numBytes <= buildStats.rtasBytesUsed,"wrong total size " + std::to_string(stats.numBytes));
+      numErrors += check(name,memcmp(&stats.bounds,&bounds,sizeof(bounds)) == 0,"bounds differ from the build bounds");
+    }
+  }
+
+  ze_rtas_statistics_exp_t stats;
+  memset(&stats,0,sizeof(stats));
+  numErrors += check("rtas statistics",zeRTASGetStatisticsExpImpl(nullptr,&stats) != ZE_RESULT_SUCCESS,"null buffer accepted");
+  std::unique_ptr<Scene> scene = createScene(hBuilder,SceneType::TRIANGLE_SOUP,100);
+  std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig());
+  numErrors += check("rtas statistics",zeRTASGetStatisticsExpImpl(accel->ptr,&stats) == ZE_RESULT_ERROR_INVALID_ENUMERATION,"wrong structure type accepted");
+  return numErrors;
+}
+
+/* captures the build of each scene to <prefix><scene>.rtcap and stores the built acceleration structure as
+ * <prefix><scene>.rtas, which rtas_replay compares its replayed build against */
+static uint32_t testCapture(ze_rtas_builder_exp_handle_t hBuilder, const std::string& prefix)
+{
+  uint32_t numErrors = 0;
+  const std::pair<SceneType,ze_rtas_builder_build_quality_hint_exp_t> builds[] = {
+    { SceneType::TRIANGLE_GRID, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW },
+    { SceneType::BOXES, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM },
+    { SceneType::INSTANCES, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH },
+    { SceneType::MIXED, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH }
+  };
+
+  for (const auto& b : builds)
+  {
+    const std::string name = std::string("capture ") + sceneName(b.first);
+    const std::string captureFile = prefix + sceneName(b.first) + ".rtcap";
+    std::unique_ptr<Scene> scene = createScene(hBuilder,b.first,10000);
+    BuildConfig config(b.second,ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS);
+    config.captureFile = captureFile.c_str();
+
+    const ze_rtas_builder_exp_properties_t props = getBuildProperties(hBuilder,*scene,config);
+    AlignedBuffer scratch(props.scratchBufferSizeBytes), accel(props.rtasBufferSizeBytesMaxRequired);
+    size_t rtasBytes = 0;
+    if (buildInto(hBuilder,*scene,config,scratch,accel,nullptr,&rtasBytes) != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("build failed");
+
+    std::ofstream out(prefix + sceneName(b.first) + ".rtas", std::ios::binary | std::ios::trunc);
+    out.write((const char*)accel.ptr,rtasBytes);
+    numErrors += check(name,bool(out),"acceleration structure not written");
+
+    std::ifstream in(captureFile, std::ios::binary);
+    CaptureHeader header;
+    if (!in.read((char*)&header,sizeof(header))) {
+      numErrors += check(name,false,"capture not written");
+      continue;
+    }
+    numErrors += check(name,memcmp(header.magic,CAPTURE_MAGIC,sizeof(header.magic)) == 0 && header.version == CAPTURE_VERSION,"wrong capture header");
+    numErrors += check(name,header.buildQuality == (uint32_t) b.second && header.buildFlags == (uint32_t) config.flags,"wrong build descriptor");
+    numErrors += check(name,header.numGeometries == scene->geometries.size(),"wrong number of geometries");
+    numErrors += check(name,header.numAccels == scene->instancedMeshes.size(),"wrong number of instanced acceleration structures");
+  }
+  return numErrors;
+}
+
+/* the builder ISA gets selected when the library gets loaded through the ZE_RAYTRACING_BUILDER_ISA
+ * environment variable, thus each ISA runs in its own process and the hits get compared through a file */
+static uint32_t testISA(ze_rtas_builder_exp_handle_t hBuilder, const std::string& fileName, bool writeReference)
+{
+  std::ofstream out;
+  std::ifstream in;
+  if (writeReference) out.open(fileName);
+  else                in.open(fileName);
+  if (writeReference ? !out : !in)
+    throw std::runtime_error("cannot open " + fileName);
+
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,50000);
+    for (auto quality : ALL_QUALITIES)
+    {
+      for (ze_rtas_builder_build_op_exp_flags_t flags : { 0, (int) ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_QUANTIZED_SAH })
+      {
+        const std::string name = std::string("isa ") + sceneName(type) + " " + qualityName(quality) + (flags ? " quantized sah" : "");
+        ze_rtas_aabb_exp_t bounds;
+        std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig(quality,flags),&bounds);
+
+        /* the rays are generated from the bounds of the reference build, as the bounds may differ in the last bits */
+        if (writeReference) out.write((const char*) &bounds,sizeof(bounds));
+        else                in.read((char*) &bounds,sizeof(bounds));
+        const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+        const std::vector<TraversalHit> hits = traceRays(accel->ptr,*scene,rays);
+
+        std::vector<TraversalHit> expected(hits.size());
+        for (size_t i=0; i<hits.size(); i++)
+        {
+          if (writeReference) {
+            out.write((const char*) &hits[i].valid,sizeof(hits[i].valid));
+            out.write((const char*) &hits[i].t,sizeof(hits[i].t));
+          } else {
+            in.read((char*) &expected[i].valid,sizeof(expected[i].valid));
+            in.read((char*) &expected[i].t,sizeof(expected[i].t));
+          }
+        }
+        if (!writeReference)
+        {
+          if (!in) throw std::runtime_error("cannot read " + fileName);
+          numErrors += compareHits(name,hits,expected);
+        }
+      }
+    }
+  }
+  return numErrors;
+}
+
+/* returns the exact bounds of the primitives below a node and checks that the stored bounds of each child
+ * contain the exact bounds of its primitives and exceed them by at most one step of the quantization grid */
+static BBox3f checkChildBounds(const Scene& scene, QBVH6::Node node, size_t& numWrong, size_t& numLoose)
+{
+  BBox3f bounds = empty;
+  if (node.type == NODE_TYPE_INTERNAL)
+  {
+    const QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+    const Vec3f step(std::ldexp(1.0f,inner->exp_x-8),std::ldexp(1.0f,inner->exp_y-8),std::ldexp(1.0f,inner->exp_z-8));
+    for (uint32_t i=0; i<6; i++)
+    {
+      if (!inner->valid(i)) continue;
+      const BBox3f exact = checkChildBounds(scene,inner->child(i),numWrong,numLoose);
+      const BBox3f stored = inner->bounds(i);
+      numWrong += !subset(exact,stored);
+
+      /* the conservative enlargement of the bounds adds a few ulps before the quantization */
+      const Vec3f maxabs = max(abs(exact.lower),abs(exact.upper));
+      const float err = 4.0f*std::numeric_limits<float>::epsilon()*reduce_max(maxabs);
+      numLoose += reduce_max(max(exact.lower-stored.lower,stored.upper-exact.upper) - step) > err;
+      bounds.extend(exact);
+    }
+  }
+  else if (node.type == NODE_TYPE_QUAD)
+  {
+    for (bool last=false; !last; node.node += sizeof(QuadLeaf))
+    {
+      const QuadLeaf* quad = node.leafNodeQuad();
+      last = quad->isLast();
+      for (size_t v=0; v<(quad->size() == 2 ? 4 : 3); v++)
+        bounds.extend(quad->vertex(v));
+    }
+  }
+  else if (node.type == NODE_TYPE_PROCEDURAL)
+  {
+    uint32_t slot = node.cur_prim;
+    for (bool last=false; !last; )
+    {
+      const ProceduralLeaf* leaf = node.leafNodeProcedural();
+      last = leaf->isLast(slot);
+      const ze_rtas_aabb_exp_t& box = scene.procedurals[0].bounds[leaf->primIndex(slot)];
+      bounds.extend(BBox3f(Vec3f(box.lower.x,box.lower.y,box.lower.z),Vec3f(box.upper.x,box.upper.y,box.upper.z)));
+      if (++slot >= leaf->size()) {
+        slot = 0;
+        node.node += sizeof(ProceduralLeaf);
+      }
+    }
+  }
+  return bounds;
+}
+
+/* all children of a node get quantized together, which has to keep the stored child bounds conservative
+ * and tight, the presplits of high quality builds clip the primitive bounds and are thus not checked */
+static uint32_t testChildBounds(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::BOXES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,50000);
+    for (auto quality : { ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_LOW, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM })
+    {
+      for (ze_rtas_builder_build_op_exp_flags_t flags : { 0, (int) ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_PACK_PROCEDURALS })
+      {
+        const std::string name = std::string("child bounds ") + sceneName(type) + " " + qualityName(quality) + (flags ? " packed" : "");
+        ze_rtas_aabb_exp_t rootBounds;
+        std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig(quality,flags),&rootBounds);
+
+        size_t numWrong = 0, numLoose = 0;
+        const BBox3f exact = checkChildBounds(*scene,((const QBVH6*) accel->ptr)->root(),numWrong,numLoose);
+        numErrors += check(name,numWrong == 0,std::to_string(numWrong) + " child bounds do not contain their primitives");
+        numErrors += check(name,numLoose == 0,std::to_string(numLoose) + " child bounds exceed their primitives by more than a grid step");
+        numErrors += check(name,exact.lower.x == rootBounds.lower.x && exact.upper.z == rootBounds.upper.z,"wrong root bounds");
+      }
+    }
+  }
+  return numErrors;
+}
+
+/* transforms a point in double precision, such that the reference is not affected by float rounding */
+static void xfmPointExact(const AffineSpace3f& xfm, const Vec3f& p, double out[3])
+{
+  for (int d=0; d<3; d++)
+    out[d] = double(p.x)*xfm.l.vx[d] + double(p.y)*xfm.l.vy[d] + double(p.z)*xfm.l.vz[d] + double(xfm.p[d]);
+}
+
+/* checks that the stored bounds of an instance child contain the transformed vertices of the instanced subtree,
+ * and, if the whole acceleration structure is instanced, exceed its transformed corners by at most a grid step */
+static void checkInstanceBounds(const Scene& scene, const QBVH6::InternalNode6* inner, uint32_t i, size_t& numWrong, size_t& numLoose, size_t& numTransformed)
+{
+  const InstanceLeaf* leaf = inner->child(i).leafNodeInstance();
+  const AffineSpace3f xfm = leaf->Obj2World();
+  const BBox3f stored = inner->bounds(i);
+  const float err = 4.0f*std::numeric_limits<float>::epsilon()*reduce_max(max(abs(stored.lower),abs(stored.upper)));
+
+  bool contained = true;
+  std::vector<QBVH6::Node> stack(1,QBVH6::Node(leaf->part0.startNodePtr));
+  while (!stack.empty())
+  {
+    QBVH6::Node node = stack.back();
+    stack.pop_back();
+    if (node.type == NODE_TYPE_INTERNAL) {
+      const QBVH6::InternalNode6* child = node.innerNode<QBVH6::InternalNode6>();
+      for (uint32_t j=0; j<6; j++)
+        if (child->valid(j)) stack.push_back(child->child(j));
+      continue;
+    }
+    for (bool last=false; !last; node.node += sizeof(QuadLeaf))
+    {
+      const QuadLeaf* quad = node.leafNodeQuad();
+      last = quad->isLast();
+      for (size_t v=0; v<(quad->size() == 2 ? 4 : 3); v++) {
+        double p[3]; xfmPointExact(xfm,quad->vertex(v),p);
+        for (int d=0; d<3; d++)
+          contained &= p[d] >= double(stored.lower[d])-err && p[d] <= double(stored.upper[d])+err;
+      }
+    }
+  }
+  numWrong += !contained;
+
+  /* the bounds of instances that are not opened are the transformed bounds of the instanced acceleration structure */
+  const ze_rtas_builder_instance_geometry_info_exp_t& info = scene.instanceInfos[leaf->part1.instanceIndex];
+  const QBVH6* blas = (const QBVH6*) info.pAccelerationStructure;
+  if (leaf->part0.startNodePtr != (uint64_t) (size_t) blas->root().node) return;
+  numTransformed++;
+  double lower[3] = { INFINITY, INFINITY, INFINITY }, upper[3] = { -INFINITY, -INFINITY, -INFINITY };
+  for (int c=0; c<8; c++)
+  {
+    const Vec3f corner(c&1 ? info.pBounds->upper.x : info.pBounds->lower.x,
+                       c&2 ? info.pBounds->upper.y : info.pBounds->lower.y,
+                       c&4 ? info.pBounds->upper.z : info.pBounds->lower.z);
+    double p[3]; xfmPointExact(xfm,corner,p);
+    for (int d=0; d<3; d++) {
+      lower[d] = std::min(lower[d],p[d]);
+      upper[d] = std::max(upper[d],p[d]);
+    }
+  }
+  const int exp[3] = { inner->exp_x, inner->exp_y, inner->exp_z };
+  for (int d=0; d<3; d++)
+  {
+    const double step = std::ldexp(1.0,exp[d]-8);
+    numLoose += lower[d]-double(stored.lower[d]) > step+err || double(stored.upper[d])-upper[d] > step+err ||
+      double(stored.lower[d]) > lower[d]+err || double(stored.upper[d]) < upper[d]-err;
+  }
+}
+
+/* the bounds of transformed boxes have to be the same as the ones of the 24 madd reference, and the instance
+ * bounds of the built acceleration structures have to match the transformed instanced geometry */
+static uint32_t testInstanceBounds(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  std::mt19937 rng(0x7B3A15);
+  std::uniform_real_distribution<float> uniform(-1.0f,1.0f);
+  size_t numDifferent = 0;
+  for (size_t i=0; i<100000; i++)
+  {
+    const float scale = std::pow(10.0f,3.0f*uniform(rng));
+    const AffineSpace3fa xfm(Vec3fa(uniform(rng),uniform(rng),uniform(rng))*scale,Vec3fa(uniform(rng),uniform(rng),uniform(rng))*scale,
+                             Vec3fa(uniform(rng),uniform(rng),uniform(rng))*scale,Vec3fa(uniform(rng),uniform(rng),uniform(rng))*100.0f);
+    const Vec3fa a = Vec3fa(uniform(rng),uniform(rng),uniform(rng))*scale, b = Vec3fa(uniform(rng),uniform(rng),uniform(rng))*scale;
+    const BBox3fa box(min(a,b),max(a,b));
+    const BBox3fa expected = xfmBounds(xfm,box);
+    const BBox3fa bounds = xfmBoundsFinite(xfm,box);
+    numDifferent += memcmp(&expected.lower,&bounds.lower,12) != 0 || memcmp(&expected.upper,&bounds.upper,12) != 0;
+  }
+  numErrors += check("instance bounds",numDifferent == 0,std::to_string(numDifferent) + " transformed boxes differ from xfmBounds");
+
+  std::unique_ptr<Scene> scene = createScene(hBuilder,SceneType::INSTANCES,2000);
+  for (auto quality : ALL_QUALITIES)
+  {
+    const std::string name = std::string("instance bounds ") + qualityName(quality);
+    std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,BuildConfig(quality));
+
+    size_t numInstances = 0, numWrong = 0, numLoose = 0, numTransformed = 0;
+    std::vector<QBVH6::Node> stack(1,((const QBVH6*) accel->ptr)->root());
+    while (!stack.empty())
+    {
+      const QBVH6::Node node = stack.back();
+      stack.pop_back();
+      if (node.type != NODE_TYPE_INTERNAL) continue;
+      const QBVH6::InternalNode6* inner = node.innerNode<QBVH6::InternalNode6>();
+      for (uint32_t i=0; i<6; i++)
+      {
+        if (!inner->valid(i)) continue;
+        const QBVH6::Node child = inner->child(i);
+        if (child.type == NODE_TYPE_INSTANCE) {
+          checkInstanceBounds(*scene,inner,i,numWrong,numLoose,numTransformed);
+          numInstances++;
+        }
+        else stack.push_back(child);
+      }
+    }
+    numErrors += check(name,numInstances >= scene->instanceInfos.size(),"only " + std::to_string(numInstances) + " instance leaves");
+    numErrors += check(name,quality == ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH || numTransformed == numInstances,"instances got opened");
+    numErrors += check(name,numWrong == 0,std::to_string(numWrong) + " instance bounds do not contain the transformed geometry");
+    numErrors += check(name,numLoose == 0,std::to_string(numLoose) + " instance bounds differ from the transformed bounds by more than a grid step");
+  }
+  return numErrors;
+}
+
+/* first touch of the scratch buffer only places its pages, thus the build has to stay byte identical */
+static uint32_t testFirstTouch(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::BOXES, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,100000);
+    for (auto quality : ALL_QUALITIES)
+    {
+      const std::string name = std::string("first touch ") + sceneName(type) + " " + qualityName(quality);
+      const BuildConfig config(quality), firstTouch(quality,ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_FIRST_TOUCH_SCRATCH);
+
+      const ze_rtas_builder_exp_properties_t props = getBuildProperties(hBuilder,*scene,config);
+      AlignedBuffer scratch(props.scratchBufferSizeBytes), expected(props.rtasBufferSizeBytesMaxRequired), accel(props.rtasBufferSizeBytesMaxRequired);
+      size_t expectedBytes = 0, rtasBytes = 0;
+
+      /* the builder does not write unused bytes of leaves, thus both buffers get cleared */
+      memset(expected.ptr,0,expected.bytes);
+      memset(accel.ptr,0,accel.bytes);
+      if (buildInto(hBuilder,*scene,config,scratch,expected,nullptr,&expectedBytes) != ZE_RESULT_SUCCESS)
+        throw std::runtime_error("build failed");
+
+      /* a fresh scratch buffer has untouched pages */
+      AlignedBuffer untouched(props.scratchBufferSizeBytes);
+      if (buildInto(hBuilder,*scene,firstTouch,untouched,accel,nullptr,&rtasBytes) != ZE_RESULT_SUCCESS)
+        throw std::runtime_error("build failed");
+      numErrors += check(name,rtasBytes == expectedBytes && memcmp(expected.ptr,accel.ptr,rtasBytes) == 0,"build differs from the build without first touch");
+    }
+  }
+  return numErrors;
+}
+
+/* SAH cost of a built acceleration structure as the statistics query reports it */
+static double rtasSAH(const void* accel)
+{
+  ze_rtas_statistics_exp_t stats;
+  memset(&stats,0,sizeof(stats));
+  stats.stype = ZE_STRUCTURE_TYPE_RTAS_STATISTICS_EXP;
+  if (zeRTASGetStatisticsExpImpl(accel,&stats) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("statistics query failed");
+  return stats.sah;
+}
+
+/* builds with scratch budgets that split the primitives into several chunks have to produce the same hits as the
+ * build with the full scratch buffer. The chunk boundaries constrain the splits of the subtrees, the SAH cost this
+ * adds over the normal build gets reported and has to stay below MAX_STREAMING_SAH_RATIO */
+static const double MAX_STREAMING_SAH_RATIO = 1.3;
+
+static uint32_t testStreaming(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::TRIANGLE_SOUP, SceneType::OUTLIER_GRID, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,100000);
+    for (auto quality : { ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM, ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH })
+    {
+      ze_rtas_aabb_exp_t bounds;
+      std::shared_ptr<AlignedBuffer> reference = build(hBuilder,*scene,BuildConfig(quality),&bounds);
+      const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+      const std::vector<TraversalHit> expected = traceRays(reference->ptr,*scene,rays);
+      const size_t scratchBytes = getBuildProperties(hBuilder,*scene,BuildConfig(quality)).scratchBufferSizeBytes;
+      const double referenceSAH = rtasSAH(reference->ptr);
+
+      for (size_t divisor : { 4, 16, 64 })
+      {
+        BuildConfig config(quality);
+        config.scratchBudgetBytes = scratchBytes/divisor;
+        const std::string name = std::string("streaming ") + sceneName(type) + " " + qualityName(quality) + " budget 1/" + std::to_string(divisor);
+
+        const ze_rtas_builder_exp_properties_t props = getBuildProperties(hBuilder,*scene,config);
+        numErrors += check(name,props.scratchBufferSizeBytes <= config.scratchBudgetBytes,
+                           "scratch size " + std::to_string(props.scratchBufferSizeBytes) + " exceeds budget " + std::to_string(config.scratchBudgetBytes));
+        std::shared_ptr<AlignedBuffer> accel = build(hBuilder,*scene,config);
+        numErrors += compareHits(name,traceRays(accel->ptr,*scene,rays),expected);
+
+        const double ratio = rtasSAH(accel->ptr)/referenceSAH;
+        std::cout << name << ": SAH " << ratio << "x of the normal build" << std::endl;
+        numErrors += check(name,ratio <= MAX_STREAMING_SAH_RATIO,"SAH cost exceeds the normal build by more than the allowed ratio");
+      }
+    }
+  }
+  return numErrors;
+}
+
+/* the hash of the build inputs has to be stable and has to change with the geometry data, quality and flags */
+static uint32_t testHash(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::BOXES, SceneType::INSTANCES, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,10000);
+    const std::string name = std::string("hash ") + sceneName(type);
+
+    auto hashOf = [&] (ze_rtas_builder_build_quality_hint_exp_t quality, ze_rtas_builder_build_op_exp_flags_t flags) -> uint64_t
+    {
+      ze_rtas_builder_build_op_hash_exp_desc_t hash;
+      memset(&hash,0,sizeof(hash));
+      BuildConfig config(quality,flags);
+      config.hash = &hash;
+      getBuildProperties(hBuilder,*scene,config);
+      const uint64_t queried = hash.hash;
+      build(hBuilder,*scene,config);
+      numErrors += check(name,hash.hash == queried,"build and build properties query report different hashes");
+      return hash.hash;
+    };
+
+    const uint64_t hash = hashOf(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,0);
+    numErrors += check(name,hashOf(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,0) == hash,"hash differs for equal inputs");
+    numErrors += check(name,hashOf(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_HIGH,0) != hash,"hash does not depend on the build quality");
+    numErrors += check(name,hashOf(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_BACK_POINTERS) != hash,"hash does not depend on the build flags");
+
+    /* change the data of one primitive, restoring it has to restore the hash */
+    if (!scene->meshes.empty()) {
+      float& x = scene->meshes[0].vertices[scene->meshes[0].vertices.size()/2].x;
+      const float original = x;
+      x += 0.5f;
+      numErrors += check(name,hashOf(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,0) != hash,"hash does not depend on the vertices");
+      x = original;
+    }
+    else if (!scene->procedurals.empty()) {
+      scene->proceduralInfos[0].geometryMask = 0x0F;
+      numErrors += check(name,hashOf(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,0) != hash,"hash does not depend on the geometry mask");
+      scene->proceduralInfos[0].geometryMask = 0xFF;
+    }
+    else {
+      const float original = scene->transforms[0].p_x;
+      scene->transforms[0].p_x += 0.5f;
+      numErrors += check(name,hashOf(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,0) != hash,"hash does not depend on the transformations");
+      scene->transforms[0].p_x = original;
+    }
+    numErrors += check(name,hashOf(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,0) == hash,"hash differs after restoring the inputs");
+  }
+  return numErrors;
+}
+
+/* meshes with equal index buffers share their triangle pairing, the pairing depends only on the indices,
+ * thus the build has to stay byte identical to the build that pairs each mesh */
+static uint32_t testShareIndices(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  std::mt19937 rng(0x1A3B5C7D);
+  Scene scene(SceneType::TRIANGLE_GRID,0);
+  scene.meshes.resize(5);
+  for (size_t i=0; i<scene.meshes.size(); i++)
+  {
+    /* the last mesh gets different indices */
+    TriangleMesh& mesh = scene.meshes[i];
+    if (i+1 < scene.meshes.size()) addGrid(mesh,20000,rng);
+    else                           addSoup(mesh,20000,rng);
+    for (auto& v : mesh.vertices) v.z += 2.0f*float(i);
+    scene.numPrimitives += mesh.triangles.size();
+  }
+  for (auto& mesh : scene.meshes)
+    scene.triangleInfos.push_back(mesh.geometryInfo());
+  for (auto& info : scene.triangleInfos)
+    scene.geometries.push_back((const ze_rtas_builder_geometry_info_exp_t*) &info);
+
+  uint32_t numErrors = 0;
+  for (auto quality : ALL_QUALITIES)
+  {
+    const std::string name = std::string("share indices ") + qualityName(quality);
+    const BuildConfig config(quality), share(quality,ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SHARE_DUPLICATE_INDICES);
+
+    const ze_rtas_builder_exp_properties_t props = getBuildProperties(hBuilder,scene,config);
+    AlignedBuffer scratch(props.scratchBufferSizeBytes), expected(props.rtasBufferSizeBytesMaxRequired), accel(props.rtasBufferSizeBytesMaxRequired);
+    size_t expectedBytes = 0, rtasBytes = 0;
+
+    /* the builder does not write unused bytes of leaves, thus both buffers get cleared */
+    memset(expected.ptr,0,expected.bytes);
+    memset(accel.ptr,0,accel.bytes);
+    if (buildInto(hBuilder,scene,config,scratch,expected,nullptr,&expectedBytes) != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("build failed");
+    if (buildInto(hBuilder,scene,share,scratch,accel,nullptr,&rtasBytes) != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("build failed");
+    numErrors += check(name,rtasBytes == expectedBytes && memcmp(expected.ptr,accel.ptr,rtasBytes) == 0,"build differs from the build without shared pairing");
+  }
+  return numErrors;
+}
+
+/* queries the copy size and copies the acceleration structure, a too small destination has to get rejected */
+static std::shared_ptr<AlignedBuffer> copyAccel(const void* src, const ze_rtas_copy_exp_desc_t* desc, size_t& bytes, uint32_t& numErrors)
+{
+  bytes = 0;
+  if (zeRTASCopyExpImpl(src,nullptr,0,nullptr,&bytes) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("copy size query failed");
+
+  std::shared_ptr<AlignedBuffer> dst = std::make_shared<AlignedBuffer>(bytes);
+  numErrors += check("copy",zeRTASCopyExpImpl(src,dst->ptr,bytes-64,desc,nullptr) == ZE_RESULT_ERROR_INVALID_SIZE,"too small destination accepted");
+  if (zeRTASCopyExpImpl(src,dst->ptr,bytes,desc,nullptr) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("copy failed");
+  return dst;
+}
+
+/* copies the instanced acceleration structures and the top level one with remapped instances,
+ * the copies have to produce the same hits after the originals got overwritten */
+static uint32_t testCopy(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  std::unique_ptr<Scene> scene = createScene(hBuilder,SceneType::INSTANCES,2000);
+  ze_rtas_aabb_exp_t bounds;
+  std::shared_ptr<AlignedBuffer> tlas = build(hBuilder,*scene,BuildConfig(),&bounds);
+  const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+  const std::vector<TraversalHit> expected = traceRays(tlas->ptr,*scene,rays);
+
+  std::vector<ze_rtas_remap_entry_exp_t> remap;
+  std::vector<std::shared_ptr<AlignedBuffer>> blasCopies;
+  for (auto& blas : scene->instancedAccels)
+  {
+    size_t bytes = 0;
+    blasCopies.push_back(copyAccel(blas->ptr,nullptr,bytes,numErrors));
+    remap.push_back({ blas->ptr, bytes, blasCopies.back()->ptr });
+  }
+
+  void* dispatchGlobalsPtr = (void*) 0x12345680;
+  ze_rtas_copy_exp_desc_t desc;
+  memset(&desc,0,sizeof(desc));
+  desc.stype = ZE_STRUCTURE_TYPE_RTAS_COPY_EXP_DESC;
+  desc.dispatchGlobalsPtr = dispatchGlobalsPtr;
+  desc.numRemapEntries = (uint32_t) remap.size();
+  desc.pRemapEntries = remap.data();
+  size_t bytes = 0;
+  std::shared_ptr<AlignedBuffer> tlasCopy = copyAccel(tlas->ptr,&desc,bytes,numErrors);
+
+  for (auto& blas : scene->instancedAccels)
+    memset(blas->ptr,0xCD,blas->bytes);
+  memset(tlas->ptr,0xCD,tlas->bytes);
+
+  numErrors += compareHits("copy",traceRays(tlasCopy->ptr,*scene,rays),expected);
+  numErrors += check("copy",((const QBVH6*) tlasCopy->ptr)->dispatchGlobalsPtr == (uint64_t) dispatchGlobalsPtr,"dispatch globals pointer not stored");
+
+  /* a header whose sections do not determine the size cannot get copied */
+  AlignedBuffer invalid(128);
+  memset(invalid.ptr,0,invalid.bytes);
+  numErrors += check("copy",zeRTASCopyExpImpl(invalid.ptr,nullptr,0,nullptr,&bytes) == ZE_RESULT_ERROR_INVALID_ARGUMENT,"source of undetermined size accepted");
+  return numErrors;
+}
+
+static std::vector<char> serialize(const void* accel, const std::vector<const void*>& accels)
+{
+  ze_rtas_serialize_exp_desc_t desc;
+  memset(&desc,0,sizeof(desc));
+  desc.stype = ZE_STRUCTURE_TYPE_RTAS_SERIALIZE_EXP_DESC;
+  desc.numAccels = (uint32_t) accels.size();
+  desc.ppAccels = (const void**) accels.data();
+
+  size_t bytes = 0;
+  if (zeRTASSerializeExpImpl(accel,&desc,nullptr,0,&bytes) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("serialized size query failed");
+  std::vector<char> blob(bytes);
+  if (zeRTASSerializeExpImpl(accel,&desc,blob.data(),blob.size(),nullptr) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("serialization failed");
+  return blob;
+}
+
+static ze_result_t deserialize(const std::vector<char>& blob, const std::vector<const void*>& accels, ze_rtas_format_exp_t format,
+                               std::shared_ptr<AlignedBuffer>& accel)
+{
+  ze_rtas_deserialize_exp_desc_t desc;
+  memset(&desc,0,sizeof(desc));
+  desc.stype = ZE_STRUCTURE_TYPE_RTAS_DESERIALIZE_EXP_DESC;
+  desc.rtasFormat = format;
+  desc.numAccels = (uint32_t) accels.size();
+  desc.ppAccels = (const void**) accels.data();
+
+  size_t bytes = 0;
+  ze_result_t err = zeRTASDeserializeExpImpl((ze_driver_handle_t)1,blob.data(),blob.size(),&desc,nullptr,0,&bytes);
+  if (err != ZE_RESULT_SUCCESS) return err;
+  accel = std::make_shared<AlignedBuffer>(bytes);
+  return zeRTASDeserializeExpImpl((ze_driver_handle_t)1,blob.data(),blob.size(),&desc,accel->ptr,accel->bytes,nullptr);
+}
+
+/* serializes the instanced and the top level acceleration structures and loads them at new addresses,
+ * the loaded structures have to produce the same hits after the originals got overwritten */
+static uint32_t testSerialize(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  const ze_rtas_format_exp_t format = (ze_rtas_format_exp_t) ZE_RTAS_DEVICE_FORMAT_EXP_VERSION_1;
+  uint32_t numErrors = 0;
+  std::unique_ptr<Scene> scene = createScene(hBuilder,SceneType::INSTANCES,2000);
+  ze_rtas_aabb_exp_t bounds;
+  std::shared_ptr<AlignedBuffer> tlas = build(hBuilder,*scene,BuildConfig(),&bounds);
+  const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+  const std::vector<TraversalHit> expected = traceRays(tlas->ptr,*scene,rays);
+
+  /* the instanced structures get passed in reverse order to test the index mapping */
+  std::vector<const void*> accels;
+  std::vector<std::vector<char>> blasBlobs;
+  for (auto& blas : scene->instancedAccels) {
+    accels.insert(accels.begin(),blas->ptr);
+    blasBlobs.push_back(serialize(blas->ptr,{}));
+  }
+  const std::vector<char> tlasBlob = serialize(tlas->ptr,accels);
+
+  std::vector<const void*> missing(accels.begin(),accels.end()-1);
+  size_t bytes = 0;
+  ze_rtas_serialize_exp_desc_t desc;
+  memset(&desc,0,sizeof(desc));
+  desc.stype = ZE_STRUCTURE_TYPE_RTAS_SERIALIZE_EXP_DESC;
+  desc.numAccels = (uint32_t) missing.size();
+  desc.ppAccels = missing.data();
+  numErrors += check("serialize",zeRTASSerializeExpImpl(tlas->ptr,&desc,nullptr,0,&bytes) != ZE_RESULT_SUCCESS,"missing instanced structure accepted");
+
+  for (auto& blas : scene->instancedAccels)
+    memset(blas->ptr,0xCD,blas->bytes);
+  memset(tlas->ptr,0xCD,tlas->bytes);
+
+  std::vector<std::shared_ptr<AlignedBuffer>> loaded(blasBlobs.size());
+  std::vector<const void*> loadedAccels;
+  for (size_t i=0; i<blasBlobs.size(); i++) {
+    if (deserialize(blasBlobs[i],{},format,loaded[i]) != ZE_RESULT_SUCCESS)
+      throw std::runtime_error("loading instanced structure failed");
+    loadedAccels.insert(loadedAccels.begin(),loaded[i]->ptr);
+  }
+
+  std::shared_ptr<AlignedBuffer> loadedTlas;
+  if (deserialize(tlasBlob,loadedAccels,format,loadedTlas) != ZE_RESULT_SUCCESS)
+    throw std::runtime_error("loading top level structure failed");
+  numErrors += compareHits("serialize",traceRays(loadedTlas->ptr,*scene,rays),expected);
+
+  /* incompatible formats, truncated data, and missing instanced structures have to get rejected */
+  std::shared_ptr<AlignedBuffer> rejected;
+  numErrors += check("serialize",deserialize(tlasBlob,loadedAccels,(ze_rtas_format_exp_t) ZE_RTAS_DEVICE_FORMAT_EXP_VERSION_2,rejected) == ZE_RESULT_EXP_ERROR_OPERANDS_INCOMPATIBLE,
+                     "incompatible format accepted");
+  for (size_t truncate : { size_t(1), size_t(64), tlasBlob.size()/2, tlasBlob.size()-1 }) {
+    const std::vector<char> truncated(tlasBlob.begin(),tlasBlob.end()-truncate);
+    numErrors += check("serialize",deserialize(truncated,loadedAccels,format,rejected) != ZE_RESULT_SUCCESS,"data truncated by " + std::to_string(truncate) + " bytes accepted");
+  }
+  const std::vector<const void*> missingLoaded(loadedAccels.begin(),loadedAccels.end()-1);
+  numErrors += check("serialize",deserialize(tlasBlob,missingLoaded,format,rejected) != ZE_RESULT_SUCCESS,"missing instanced structure accepted when loading");
+
+  /* sizes of a corrupted header whose sums wrap around have to get rejected */
+  for (int field=0; field<2; field++)
+  {
+    std::vector<char> corrupted = tlasBlob;
+    SerializedHeader* header = (SerializedHeader*) corrupted.data();
+    if (field == 0) header->rtasBytes = ~header->rtasOffset + 1 + 64;
+    else            header->numRelocations = 0xFFFFFFFF;
+    numErrors += check("serialize",deserialize(corrupted,loadedAccels,format,rejected) != ZE_RESULT_SUCCESS,
+                       field == 0 ? "wrapping acceleration structure size accepted" : "wrapping relocation count accepted");
+  }
+  return numErrors;
+}
+
+/* the second build of a scene gets loaded from the cache directory and has to produce the same hits as the
+ * first build, a corrupted cache file has to get rebuilt, requires the cache to be enabled through the
+ * ZE_RAYTRACING_BUILD_CACHE environment variable */
+static uint32_t testCache()
+{
+  const char* directory = getenv("ZE_RAYTRACING_BUILD_CACHE");
+  if (!directory || !*directory)
+    throw std::runtime_error("the cache test requires the ZE_RAYTRACING_BUILD_CACHE environment variable");
+
+  fs::create_directories(directory);
+  for (const auto& entry : fs::directory_iterator(directory))
+    fs::remove_all(entry.path());
+
+  /* destroying the builder writes the pending cache files */
+  ze_rtas_builder_exp_handle_t hBuilder = createBuilder();
+  std::unique_ptr<Scene> scene = createScene(hBuilder,SceneType::TRIANGLE_SOUP,50000);
+  ze_rtas_aabb_exp_t bounds;
+  std::shared_ptr<AlignedBuffer> fresh = build(hBuilder,*scene,BuildConfig(),&bounds);
+  destroyBuilder(hBuilder);
+
+  const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+  const std::vector<TraversalHit> expected = traceRays(fresh->ptr,*scene,rays);
+
+  std::vector<fs::path> files;
+  for (const auto& entry : fs::directory_iterator(directory))
+    if (entry.path().extension() == ".rtser") files.push_back(entry.path());
+  if (files.size() != 1)
+    return check("cache",false,std::to_string(files.size()) + " cache files written instead of one");
+  const fs::path file = files[0];
+
+  hBuilder = createBuilder();
+  std::shared_ptr<AlignedBuffer> cached = build(hBuilder,*scene,BuildConfig());
+  uint32_t numErrors = compareHits("cache hit",traceRays(cached->ptr,*scene,rays),expected);
+
+  /* a hit returns whatever the file of the key holds, thus the file of another scene proves that the file gets loaded */
+  std::unique_ptr<Scene> other = createScene(hBuilder,SceneType::TRIANGLE_GRID,1000);
+  ze_rtas_aabb_exp_t otherBounds;
+  std::shared_ptr<AlignedBuffer> otherAccel = build(hBuilder,*other,BuildConfig(),&otherBounds);
+  const std::vector<char> otherBlob = serialize(otherAccel->ptr,{});
+  destroyBuilder(hBuilder);
+
+  std::ofstream(file,std::ios::binary | std::ios::trunc).write(otherBlob.data(),otherBlob.size());
+  hBuilder = createBuilder();
+  ze_rtas_aabb_exp_t loadedBounds;
+  build(hBuilder,*scene,BuildConfig(),&loadedBounds);
+  destroyBuilder(hBuilder);
+  numErrors += check("cache",memcmp(&loadedBounds,&otherBounds,sizeof(otherBounds)) == 0,"build did not load the cache file");
+
+  /* a truncated file has to get rebuilt */
+  std::ofstream(file,std::ios::binary | std::ios::trunc).write(otherBlob.data(),otherBlob.size()/2);
+  hBuilder = createBuilder();
+  std::shared_ptr<AlignedBuffer> rebuilt = build(hBuilder,*scene,BuildConfig());
+  numErrors += compareHits("cache corrupted",traceRays(rebuilt->ptr,*scene,rays),expected);
+  destroyBuilder(hBuilder);
+  return numErrors;
+}
+
+/* builds with the primrefs at the end of the acceleration structure buffer have to produce the same
+ * hits as the normal build, whether all primrefs fit behind the BVH data or get finished in chunks */
+static uint32_t testTail(ze_rtas_builder_exp_handle_t hBuilder)
+{
+  uint32_t numErrors = 0;
+  for (SceneType type : { SceneType::TRIANGLE_GRID, SceneType::MIXED })
+  {
+    std::unique_ptr<Scene> scene = createScene(hBuilder,type,100000);
+    ze_rtas_aabb_exp_t bounds;
+    std::shared_ptr<AlignedBuffer> reference = build(hBuilder,*scene,BuildConfig(),&bounds);
+    const std::vector<TraversalRay> rays = createRays(*scene,bounds,NUM_RAYS);
+    const std::vector<TraversalHit> expected = traceRays(reference->ptr,*scene,rays);
+    const size_t scratchBytes = getBuildProperties(hBuilder,*scene,BuildConfig()).scratchBufferSizeBytes;
+    const std::string prefix = std::string("tail ") + sceneName(type);
+
+    /* without scratch buffer the worst case size leaves room for all primrefs */
+    BuildConfig config(ZE_RTAS_BUILDER_BUILD_QUALITY_HINT_EXP_MEDIUM,ZE_RTAS_BUILDER_BUILD_OP_EXP_FLAG_SCRATCH_IN_RTAS_BUFFER);
+    ze_rtas_builder_exp_properties_t props = getBuildProperties(hBuilder,*scene,config);
+    numErrors += check(prefix,props.scratchBufferSizeBytes == 0,"scratch buffer requested");
+    {
+      AlignedBuffer scratch, accel(props.rtasBufferSizeBytesMaxRequired);
+      ze_result_t err = buildInto(hBuilder,*scene,config,scratch,accel,nullptr,nullptr);
+      numErrors += check(prefix + " worst case",err == ZE_RESULT_SUCCESS,"build failed with error " + std::to_string(err));
+      if (err == ZE_RESULT_SUCCESS)
+        numErrors += compareHits(prefix + " worst case",traceRays(accel.ptr,*scene,rays),expected);
+    }
+
+    /* the expected size may require retries with the reported size */
+    {
+      AlignedBuffer scratch;
+      size_t bytes = props.rtasBufferSizeBytesExpected;
+      ze_result_t err = ZE_RESULT_EXP_RTAS_BUILD_RETRY;
+      std::shared_ptr<AlignedBuffer> accel;
+      while (err == ZE_RESULT_EXP_RTAS_BUILD_RETRY && bytes <= props.rtasBufferSizeBytesMaxRequired && (!accel || bytes > accel->bytes)) {
+        accel = std::make_shared<AlignedBuffer>(bytes);
+        err = buildInto(hBuilder,*scene,config,scratch,*accel,nullptr,&bytes);
+      }
+      numErrors += check(prefix + " expected",err == ZE_RESULT_SUCCESS,"build failed with error " + std::to_string(err));
+      if (err == ZE_RESULT_SUCCESS)
+        numErrors += compareHits(prefix + " expected",traceRays(accel->ptr,*scene,rays),expected);
+    }
+
+    /* with scratch budget the chunks get built in the scratch buffer or behind the BVH data */
+    config.scratchBudgetBytes = scratchBytes/8;
+    props = getBuildProperties(hBuilder,*scene,config);
+    for (size_t extraBytes : { size_t(0), scratchBytes/3, scratchBytes/2 })
+    {
+      const std::string name = prefix + " budget extra " + std::to_string(extraBytes);
+      AlignedBuffer scratch(props.scratchBufferSizeBytes), accel(props.rtasBufferSizeBytesMaxRequired+extraBytes);
+      ze_result_t err = buildInto(hBuilder,*scene,config,scratch,accel,nullptr,nullptr);
+      numErrors += check(name,err == ZE_RESULT_SUCCESS,"build failed with error " + std::to_string(err));
+      if (err == ZE_RESULT_SUCCESS)
+        numErrors += compareHits(name,traceRays(accel.ptr,*scene,rays),expected);
+    }
+
+    /* a scratch size without scratch buffer is invalid */
+    {
+      AlignedBuffer accel(props.rtasBufferSizeBytesMaxRequired);
+      BuildOp op(*scene,config);
+      ze_result_t err = zeRTASBuilderBuildExpImpl(hBuilder,&op.args,nullptr,64,accel.ptr,accel.bytes,nullptr,nullptr,nullptr,nullptr);
+      numErrors += check(prefix,err == ZE_RESULT_ERROR_INVALID_NULL_POINTER,"missing scratch buffer accepted");
+    }
+  }
+  return numErrors;
+}
+
+static void printUsage()
+{
+  std::cout << "usage: rtbuild_host_test <test>" << std::endl;
+  std::cout << "  --estimate                worst case and expected buffer sizes" << std::endl;
+  std::cout << "  --back-pointers           back pointers of the internal nodes" << std::endl;
+  std::cout << "  --child-order             child order of a ray distribution" << std::endl;
+  std::cout << "  --quantized-sah           SAH evaluated on quantized child bounds" << std::endl;
+  std::cout << "  --pack-procedurals        procedural leaves shared between fat leaves" << std::endl;
+  std::cout << "  --traversal               host traversal against intersecting all primitives" << std::endl;
+  std::cout << "  --traversal-modes         SIMD and stream traversal against scalar traversal" << std::endl;
+  std::cout << "  --ray-query               resumable traversal stopping at potential hits" << std::endl;
+  std::cout << "  --build-statistics        build phase timings and counters" << std::endl;
+  std::cout << "  --build-trace             trace events of the build phases and tasks" << std::endl;
+  std::cout << "  --rtas-statistics         statistics query of a built acceleration structure" << std::endl;
+  std::cout << "  --capture <prefix>        captures of builds for rtas_replay" << std::endl;
+  std::cout << "  --child-bounds            conservative and tight quantized child bounds" << std::endl;
+  std::cout << "  --instance-bounds         transformed bounds of instances" << std::endl;
+  std::cout << "  --first-touch             builds with first touch of the scratch buffer" << std::endl;
+  std::cout << "  --streaming               builds with limited scratch budget" << std::endl;
+  std::cout << "  --hash                    hash of the build inputs" << std::endl;
+  std::cout << "  --share-indices           triangle pairing shared between equal index buffers" << std::endl;
+  std::cout << "  --copy                    copies with remapped instances" << std::endl;
+  std::cout << "  --serialize               serialized acceleration structures and loading them" << std::endl;
+  std::cout << "  --cache                   builds loaded from the build cache" << std::endl;
+  std::cout << "  --tail                    builds with the primrefs at the end of the acceleration structure buffer" << std::endl;
+  std::cout << "  --isa-reference <file>    writes the hits of the selected builder ISA" << std::endl;
+  std::cout << "  --isa-compare <file>      compares the hits of the selected builder ISA" << std::endl;
+}
+
+int main(int argc, char* argv[]) try
+{
+  if (argc < 2) {
+    std::cout << "ERROR: no test specified" << std::endl;
+    printUsage();
+    return 1;
+  }
+
+  /* the cache test creates its own builders, as destroying them flushes the cache */
+  ze_rtas_builder_exp_handle_t hBuilder = strcmp(argv[1], "--cache") != 0 ? createBuilder() : nullptr;
+
+  uint32_t numErrors = 0;
+  if (strcmp(argv[1], "--cache") == 0)
+    numErrors = testCache();
+  else if (strcmp(argv[1], "--estimate") == 0)
+    numErrors = testEstimate(hBuilder);
+  else if (strcmp(argv[1], "--back-pointers") == 0)
+    numErrors = testBackPointers(hBuilder);
+  else if (strcmp(argv[1], "--child-order") == 0)
+    numErrors = testChildOrder(hBuilder);
+  else if (strcmp(argv[1], "--quantized-sah") == 0)
+    numErrors = testQuantizedSAH(hBuilder);
+  else if (strcmp(argv[1], "--pack-procedurals") == 0)
+    numErrors = testPackProcedurals(hBuilder);
+  else if (strcmp(argv[1], "--traversal") == 0)
+    numErrors = testTraversal(hBuilder);
+  else if (strcmp(argv[1], "--traversal-modes") == 0)
+    numErrors = testTraversalModes(hBuilder);
+  else if (strcmp(argv[1], "--ray-query") == 0)
+    numErrors = testRayQuery(hBuilder);
+  else if (strcmp(argv[1], "--build-statistics") == 0)
+    numErrors = testBuildStatistics(hBuilder);
+  else if (strcmp(argv[1], "--build-trace") == 0)
+    numErrors = testBuildTrace(hBuilder);
+  else if (strcmp(argv[1], "--rtas-statistics") == 0)
+    numErrors = testRtasStatistics(hBuilder);
+  else if (strcmp(argv[1], "--capture") == 0 && argc > 2)
+    numErrors = testCapture(hBuilder,argv[2]);
+  else if (strcmp(argv[1], "--child-bounds") == 0)
+    numErrors = testChildBounds(hBuilder);
+  else if (strcmp(argv[1], "--instance-bounds") == 0)
+    numErrors = testInstanceBounds(hBuilder);
+  else if (strcmp(argv[1], "--first-touch") == 0)
+    numErrors = testFirstTouch(hBuilder);
+  else if (strcmp(argv[1], "--streaming") == 0)
+    numErrors = testStreaming(hBuilder);
+  else if (strcmp(argv[1], "--hash") == 0)
+    numErrors = testHash(hBuilder);
+  else if (strcmp(argv[1], "--share-indices") == 0)
+    numErrors = testShareIndices(hBuilder);
+  else if (strcmp(argv[1], "--copy") == 0)
+    numErrors = testCopy(hBuilder);
+  else if (strcmp(argv[1], "--serialize") == 0)
+    numErrors = testSerialize(hBuilder);
+  else if (strcmp(argv[1], "--tail") == 0)
+    numErrors = testTail(hBuilder);
+  else if (strcmp(argv[1], "--isa-reference") == 0 || strcmp(argv[1], "--isa-compare") == 0) {
+    if (argc < 3) throw std::runtime_error(std::string("Error: ") + argv[1] + " <file>: syntax error");
+    numErrors = testISA(hBuilder,argv[2],strcmp(argv[1], "--isa-reference") == 0);
+  }
+  else {
+    std::cout << "ERROR: invalid command line option " << argv[1] << std::endl;
+    printUsage();
+    return 1;
+  }
+
+  if (hBuilder) destroyBuilder(hBuilder);
+
+  std::cout << (numErrors ? "FAILED" : "PASSED") << std::endl;
+  return numErrors ? 1 : 0;
+}
+catch (const std::exception& e)
+{
+  std::cerr << "ERROR: " << e.what() << std::endl;
+  return 1;
+}
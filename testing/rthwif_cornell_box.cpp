@@ -6,6 +6,10 @@
 
 #include "../rttrace/rttrace.h"
 
+#if defined(ZE_RAYTRACING_RT_HOST)
+#include "../rtbuild/sys/alloc.h"
+#endif
+
 #include <level_zero/ze_wrapper.h>
 
 #include <vector>
@@ -94,6 +98,10 @@ bool compareTga(const std::string& fileNameA, const std::string& fileNameB)
 /* Properly allocates an acceleration structure buffer using ze_raytracing_mem_alloc_ext_desc_t property. */
 void* alloc_accel_buffer(size_t bytes, sycl::device device, sycl::context context)
 {
+#if defined(ZE_RAYTRACING_RT_HOST)
+  /* the host traversal reads the acceleration structure from plain host memory */
+  return embree::alignedMalloc(bytes,128);
+#else
   ze_context_handle_t hContext = sycl::get_native<sycl::backend::ext_oneapi_level_zero>(context);
   ze_device_handle_t  hDevice  = sycl::get_native<sycl::backend::ext_oneapi_level_zero>(device);
   
@@ -125,14 +133,19 @@ void* alloc_accel_buffer(size_t bytes, sycl::device device, sycl::context contex
     throw std::runtime_error("acceleration buffer allocation failed");
 
   return ptr;
+#endif
 }
 
 void free_accel_buffer(void* ptr, sycl::context context)
 {
+#if defined(ZE_RAYTRACING_RT_HOST)
+  embree::alignedFree(ptr);
+#else
   ze_context_handle_t hContext = sycl::get_native<sycl::backend::ext_oneapi_level_zero>(context);
   ze_result_t result = ZeWrapper::zeMemFree(hContext,ptr);
   if (result != ZE_RESULT_SUCCESS)
     throw std::runtime_error("acceleration buffer free failed");
+#endif
 }
 
 
@@ -561,7 +574,7 @@ int main(int argc, char* argv[])
   memset(pixels, 0, width*height*sizeof(uint32_t));
 
   /* renders image on device */
-#if defined(ZE_RAYTRACING_RT_SIMULATION)
+#if defined(ZE_RAYTRACING_RT_SIMULATION) || defined(ZE_RAYTRACING_RT_HOST)
   tbb::parallel_for(tbb::blocked_range2d<uint32_t>(0,height,0,width),
      [&](const tbb::blocked_range2d<uint32_t>& r) {
         for (int y=r.rows().begin(); y<r.rows().end(); y++) {
@@ -885,6 +885,10 @@ std::shared_ptr<TriangleMesh> createTrianglePlane (const sycl::float3& p0, const
 
 void* alloc_accel_buffer_internal(size_t bytes, sycl::device device, sycl::context context)
 {
+#if defined(ZE_RAYTRACING_RT_HOST)
+  /* the host traversal reads the acceleration structure from plain host memory */
+  return embree::alignedMalloc(bytes,128);
+#else
   ze_context_handle_t hContext = sycl::get_native<sycl::backend::ext_oneapi_level_zero>(context);
   ze_device_handle_t  hDevice  = sycl::get_native<sycl::backend::ext_oneapi_level_zero>(device);
 
@@ -915,15 +919,20 @@ void* alloc_accel_buffer_internal(size_t bytes, sycl::device device, sycl::conte
   if (result != ZE_RESULT_SUCCESS)
     throw std::runtime_error("accel allocation failed");
   return ptr;
+#endif
 }
 
 void free_accel_buffer_internal(void* ptr, sycl::context context)
 {
   if (ptr == nullptr) return;
+#if defined(ZE_RAYTRACING_RT_HOST)
+  embree::alignedFree(ptr);
+#else
   ze_context_handle_t hContext = sycl::get_native<sycl::backend::ext_oneapi_level_zero>(context);
   ze_result_t result = ZeWrapper::zeMemFree(hContext,ptr);
   if (result != ZE_RESULT_SUCCESS)
     throw std::runtime_error("accel free failed");
+#endif
 }
 
 struct Block {
@@ -1856,7 +1865,7 @@ uint32_t executeTest(sycl::device& device, sycl::queue& queue, sycl::context& co
   if (inst != InstancingType::SW_INSTANCING &&
       (test == TestType::TRIANGLES_COMMITTED_HIT || test == TestType::TRIANGLES_POTENTIAL_HIT))
   {
-#if defined(ZE_RAYTRACING_RT_SIMULATION)
+#if defined(ZE_RAYTRACING_RT_SIMULATION) || defined(ZE_RAYTRACING_RT_HOST)
     tbb::parallel_for(size_t(0),numTests, [&](size_t i) {
       render(i,in[i],out_test[i],accel);
      });
@@ -1873,7 +1882,7 @@ uint32_t executeTest(sycl::device& device, sycl::queue& queue, sycl::context& co
   }
   else
   {
-#if defined(ZE_RAYTRACING_RT_SIMULATION)
+#if defined(ZE_RAYTRACING_RT_SIMULATION) || defined(ZE_RAYTRACING_RT_HOST)
     tbb::parallel_for(size_t(0),numTests, [&](size_t i) {
       render_loop(i,in[i],out_test[i],scene_ptr,accel,test);
      });
@@ -1945,7 +1954,7 @@ uint32_t executeBuildTest(sycl::device& device, sycl::queue& queue, sycl::contex
 
   if (numPrimitives)
   {
-#if defined(ZE_RAYTRACING_RT_SIMULATION)
+#if defined(ZE_RAYTRACING_RT_SIMULATION) || defined(ZE_RAYTRACING_RT_HOST)
     tbb::parallel_for(size_t(0),size_t(numPrimitives), [&](size_t i) {
       render_loop(i,in[i],out_test[i],scene_ptr,accel,TestType::TRIANGLES_COMMITTED_HIT);
     });